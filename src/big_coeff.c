@@ -0,0 +1,501 @@
+/** @file
+ * Implementacja modułu odpowiedzialnego za współczynniki będące liczbami
+ * całkowitymi dowolnej precyzji.
+ * Działania wykonywane są na modułach liczb w tablicach słów, a znak wyniku
+ * wyznaczany jest osobno. Liczby o co najwyżej @ref BIG_ARENA_MAX_LIMBS
+ * słowach wydzielane są z bloków areny i po zwolnieniu trafiają na listę
+ * wolnych liczb o tej samej pojemności.
+ *
+ * @author Jan Kwiatkowski
+ */
+
+#include "big_coeff.h"
+#include "output.h"
+#include "utilities.h"
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+/** Największa potęga dziesiątki mieszcząca się w słowie. */
+#define BIG_DECIMAL_BASE 10000000000000000000UL
+
+/** Liczba cyfr dziesiętnych potęgi @ref BIG_DECIMAL_BASE. */
+#define BIG_DECIMAL_DIGITS 19
+
+/** Liczba słów tablic pomocniczych trzymanych na stosie. */
+#define BIG_LOCAL_LIMBS 16
+
+/**
+ * Moduł i znak współczynnika, niezależnie od jego reprezentacji.
+ */
+typedef struct BigView {
+    const uint64_t *limbs; ///< słowa modułu od najmniej znaczącego
+    size_t size; ///< liczba słów modułu, 0 dla zera
+    bool negative; ///< czy współczynnik jest ujemny
+    uint64_t small; ///< moduł współczynnika typu @ref poly_coeff_t
+} BigView;
+
+/**
+ * Wolna liczba na liście wolnych liczb.
+ */
+typedef struct FreeBig {
+    struct FreeBig *next; ///< następna wolna liczba lub NULL
+} FreeBig;
+
+/**
+ * Blok areny, z którego wydzielane są liczby. Liczby leżą bezpośrednio za
+ * strukturą.
+ */
+typedef struct ArenaChunk {
+    struct ArenaChunk *next; ///< następny blok lub NULL
+} ArenaChunk;
+
+#ifndef POLY_USE_MALLOC
+/** Listy wolnych liczb; na pozycji @f$i@f$ liczby o pojemności @f$i + 1@f$. */
+static FreeBig *free_lists[BIG_ARENA_MAX_LIMBS];
+
+/** Lista wszystkich bloków areny. */
+static ArenaChunk *chunks = NULL;
+
+/** Początek niewykorzystanej części bieżącego bloku. */
+static char *chunk_free = NULL;
+
+/** Koniec bieżącego bloku. */
+static char *chunk_end = NULL;
+
+/** Blokada chroniąca arenę. */
+static atomic_flag arena_lock = ATOMIC_FLAG_INIT;
+
+/** Zajmuje blokadę areny. */
+static void ArenaLock(void) {
+    while (atomic_flag_test_and_set_explicit(&arena_lock,
+                                             memory_order_acquire))
+        ;
+}
+
+/** Zwalnia blokadę areny. */
+static void ArenaUnlock(void) {
+    atomic_flag_clear_explicit(&arena_lock, memory_order_release);
+}
+#endif
+
+/**
+ * Zwraca rozmiar w bajtach liczby o danej pojemności.
+ * @param[in] capacity : liczba słów
+ * @return rozmiar liczby
+ */
+static size_t BigSize(size_t capacity) {
+    return sizeof(BigInt) + capacity * sizeof(uint64_t);
+}
+
+/**
+ * Przydziela liczbę z licznikiem odwołań równym 1.
+ * @param[in] size : liczba słów modułu, dodatnia
+ * @return liczba o nieokreślonych słowach i znaku
+ */
+static BigInt* BigAlloc(size_t size) {
+    assert(size > 0);
+    BigInt *big = NULL;
+    size_t capacity = size;
+
+#ifndef POLY_USE_MALLOC
+    if (size <= BIG_ARENA_MAX_LIMBS) {
+        ArenaLock();
+        if (free_lists[size - 1] != NULL) {
+            FreeBig *block = free_lists[size - 1];
+            free_lists[size - 1] = block->next;
+            big = (BigInt *) block;
+        } else {
+            if (chunk_end - chunk_free < (ptrdiff_t) BigSize(size)) {
+                ArenaChunk *chunk = SafeMalloc(sizeof(ArenaChunk) +
+                                               BIG_ARENA_CHUNK_SIZE);
+                chunk->next = chunks;
+                chunks = chunk;
+                chunk_free = (char *) (chunk + 1);
+                chunk_end = chunk_free + BIG_ARENA_CHUNK_SIZE;
+            }
+            big = (BigInt *) chunk_free;
+            chunk_free += BigSize(size);
+        }
+        ArenaUnlock();
+    }
+#endif
+    if (big == NULL)
+        big = SafeMalloc(BigSize(size));
+
+    atomic_init(&big->refcount, 1);
+    big->capacity = capacity;
+    big->size = size;
+    return big;
+}
+
+/**
+ * Zwalnia liczbę.
+ * @param[in] big : liczba
+ */
+static void BigFree(BigInt *big) {
+#ifndef POLY_USE_MALLOC
+    if (big->capacity <= BIG_ARENA_MAX_LIMBS) {
+        FreeBig *block = (FreeBig *) big;
+        ArenaLock();
+        block->next = free_lists[big->capacity - 1];
+        free_lists[big->capacity - 1] = block;
+        ArenaUnlock();
+        return;
+    }
+#endif
+    free(big);
+}
+
+void BigRetain(BigInt *big) {
+    // liczba nieśmiertelna może leżeć w pamięci tylko do odczytu
+    if (atomic_load_explicit(&big->refcount, memory_order_relaxed) ==
+        BIG_IMMORTAL)
+        return;
+    atomic_fetch_add_explicit(&big->refcount, 1, memory_order_relaxed);
+}
+
+void BigUnref(BigInt *big) {
+    if (atomic_load_explicit(&big->refcount, memory_order_relaxed) ==
+        BIG_IMMORTAL)
+        return;
+    size_t prev = atomic_fetch_sub_explicit(&big->refcount, 1,
+                                            memory_order_acq_rel);
+    assert(prev > 0);
+    if (prev == 1)
+        BigFree(big);
+}
+
+void BigArenaRelease(void) {
+#ifndef POLY_USE_MALLOC
+    ArenaLock();
+    while (chunks != NULL) {
+        ArenaChunk *next = chunks->next;
+        free(chunks);
+        chunks = next;
+    }
+    for (size_t i = 0; i < BIG_ARENA_MAX_LIMBS; i++)
+        free_lists[i] = NULL;
+    chunk_free = chunk_end = NULL;
+    ArenaUnlock();
+#endif
+}
+
+/**
+ * Wypełnia widok modułu i znaku współczynnika.
+ * @param[in] a : wielomian stały
+ * @param[out] view : widok; wskazuje na pamięć @p a lub na samego siebie,
+ * więc nie wolno go kopiować
+ */
+static void ViewOf(const Poly *a, BigView *view) {
+    assert(PolyIsCoeff(a));
+    if (PolyIsBig(a)) {
+        view->limbs = a->big->limbs;
+        view->size = a->big->size;
+        view->negative = a->big->negative;
+        return;
+    }
+    view->negative = a->coeff < 0;
+    view->small = view->negative ? 0 - (uint64_t) a->coeff
+                                 : (uint64_t) a->coeff;
+    view->limbs = &view->small;
+    view->size = view->small != 0;
+}
+
+/**
+ * Tworzy współczynnik o danym module i znaku. Jeśli mieści się on w typie
+ * @ref poly_coeff_t, zwraca zwykły wielomian stały.
+ * @param[in] limbs : słowa modułu od najmniej znaczącego
+ * @param[in] size : liczba słów, być może z zerowymi słowami najbardziej
+ * znaczącymi
+ * @param[in] negative : czy współczynnik jest ujemny
+ * @return wielomian stały
+ */
+static Poly MakeCoeff(const uint64_t limbs[], size_t size, bool negative) {
+    while (size > 0 && limbs[size - 1] == 0)
+        size--;
+
+    if (size == 0)
+        return PolyZero();
+    if (size == 1 && !negative && limbs[0] <= (uint64_t) LONG_MAX)
+        return PolyFromCoeff((poly_coeff_t) limbs[0]);
+    if (size == 1 && negative && limbs[0] <= (uint64_t) LONG_MAX + 1)
+        return PolyFromCoeff((poly_coeff_t) (0 - limbs[0]));
+
+    BigInt *big = BigAlloc(size);
+    big->negative = negative;
+    memcpy(big->limbs, limbs, size * sizeof(uint64_t));
+    return (Poly) {.big = big, .arr = POLY_BIG_ARR};
+}
+
+/**
+ * Zwraca tablicę pomocniczą o danej długości: @p local, jeśli jest
+ * wystarczająco długa, a w przeciwnym przypadku tablicę przydzieloną na
+ * stercie.
+ * @param[in] n : wymagana liczba słów
+ * @param[in] local : tablica o długości @ref BIG_LOCAL_LIMBS
+ * @return tablica
+ */
+static uint64_t* Scratch(size_t n, uint64_t local[]) {
+    if (n <= BIG_LOCAL_LIMBS)
+        return local;
+    return SafeMalloc(n * sizeof(uint64_t));
+}
+
+/**
+ * Zwalnia tablicę zwróconą przez
+ * @ref Scratch(size_t n, uint64_t local[]).
+ * @param[in] limbs : tablica
+ * @param[in] local : tablica przekazana do @ref Scratch
+ */
+static void ScratchFree(uint64_t *limbs, const uint64_t local[]) {
+    if (limbs != local)
+        free(limbs);
+}
+
+/**
+ * Porównuje moduły liczb.
+ * @param[in] a : widok pierwszej liczby
+ * @param[in] b : widok drugiej liczby
+ * @return liczba ujemna, zero lub dodatnia, gdy moduł @p a jest odpowiednio
+ * mniejszy, równy lub większy od modułu @p b
+ */
+static int MagCmp(const BigView *a, const BigView *b) {
+    if (a->size != b->size)
+        return a->size < b->size ? -1 : 1;
+    for (size_t i = a->size; i > 0; i--) {
+        if (a->limbs[i - 1] != b->limbs[i - 1])
+            return a->limbs[i - 1] < b->limbs[i - 1] ? -1 : 1;
+    }
+    return 0;
+}
+
+/**
+ * Dodaje moduły liczb.
+ * @param[in] a : widok liczby o co najmniej tylu słowach co @p b
+ * @param[in] b : widok liczby
+ * @param[out] out : tablica długości `a->size + 1`
+ */
+static void MagAdd(const BigView *a, const BigView *b, uint64_t out[]) {
+    assert(a->size >= b->size);
+    uint64_t carry = 0;
+    for (size_t i = 0; i < a->size; i++) {
+        unsigned __int128 sum = (unsigned __int128) a->limbs[i] + carry;
+        if (i < b->size)
+            sum += b->limbs[i];
+        out[i] = (uint64_t) sum;
+        carry = (uint64_t) (sum >> 64);
+    }
+    out[a->size] = carry;
+}
+
+/**
+ * Odejmuje moduły liczb.
+ * @param[in] a : widok liczby o module nie mniejszym niż moduł @p b
+ * @param[in] b : widok liczby
+ * @param[out] out : tablica długości `a->size`
+ */
+static void MagSub(const BigView *a, const BigView *b, uint64_t out[]) {
+    uint64_t borrow = 0;
+    for (size_t i = 0; i < a->size; i++) {
+        uint64_t sub = i < b->size ? b->limbs[i] : 0;
+        uint64_t diff = a->limbs[i] - sub - borrow;
+        borrow = a->limbs[i] < sub || (a->limbs[i] == sub && borrow);
+        out[i] = diff;
+    }
+    assert(borrow == 0);
+}
+
+Poly BigCoeffAdd(const Poly *a, const Poly *b) {
+    BigView va, vb;
+    ViewOf(a, &va);
+    ViewOf(b, &vb);
+
+    // większy moduł jest pierwszy
+    const BigView *x = &va, *y = &vb;
+    if (MagCmp(x, y) < 0) {
+        x = &vb;
+        y = &va;
+    }
+
+    uint64_t local[BIG_LOCAL_LIMBS];
+    uint64_t *out = Scratch(x->size + 1, local);
+    if (x->negative == y->negative)
+        MagAdd(x, y, out);
+    else
+        MagSub(x, y, out);
+
+    Poly poly_ret = MakeCoeff(out, x->size + (x->negative == y->negative),
+                              x->negative);
+    ScratchFree(out, local);
+    return poly_ret;
+}
+
+Poly BigCoeffMul(const Poly *a, const Poly *b) {
+    BigView va, vb;
+    ViewOf(a, &va);
+    ViewOf(b, &vb);
+    if (va.size == 0 || vb.size == 0)
+        return PolyZero();
+
+    uint64_t local[BIG_LOCAL_LIMBS];
+    size_t size = va.size + vb.size;
+    uint64_t *out = Scratch(size, local);
+    memset(out, 0, size * sizeof(uint64_t));
+
+    // mnożenie pisemne
+    for (size_t i = 0; i < va.size; i++) {
+        uint64_t carry = 0;
+        for (size_t j = 0; j < vb.size; j++) {
+            unsigned __int128 t =
+                (unsigned __int128) va.limbs[i] * vb.limbs[j] + out[i + j] +
+                carry;
+            out[i + j] = (uint64_t) t;
+            carry = (uint64_t) (t >> 64);
+        }
+        out[i + vb.size] = carry;
+    }
+
+    Poly poly_ret = MakeCoeff(out, size, va.negative != vb.negative);
+    ScratchFree(out, local);
+    return poly_ret;
+}
+
+Poly BigCoeffNeg(const Poly *a) {
+    BigView va;
+    ViewOf(a, &va);
+    return MakeCoeff(va.limbs, va.size, !va.negative);
+}
+
+bool BigCoeffEq(const Poly *a, const Poly *b) {
+    BigView va, vb;
+    ViewOf(a, &va);
+    ViewOf(b, &vb);
+    return va.negative == vb.negative && MagCmp(&va, &vb) == 0;
+}
+
+poly_coeff_t BigCoeffLow(const Poly *a) {
+    BigView va;
+    ViewOf(a, &va);
+    uint64_t low = va.size > 0 ? va.limbs[0] : 0;
+    return (poly_coeff_t) (va.negative ? 0 - low : low);
+}
+
+poly_coeff_t BigCoeffMod(const Poly *a, unsigned long p) {
+    BigView va;
+    ViewOf(a, &va);
+    uint64_t rem = 0;
+    for (size_t i = va.size; i > 0; i--)
+        rem = (uint64_t) ((((unsigned __int128) rem << 64) | va.limbs[i - 1]) %
+                          p);
+    if (va.negative && rem != 0)
+        rem = p - rem;
+    return (poly_coeff_t) rem;
+}
+
+uint64_t BigCoeffHash(const Poly *a) {
+    BigView va;
+    ViewOf(a, &va);
+    uint64_t hash = va.negative ? 0x9e3779b97f4a7c15UL : 0;
+    for (size_t i = 0; i < va.size; i++) {
+        hash ^= va.limbs[i] + 0x9e3779b97f4a7c15UL + (hash << 6) + (hash >> 2);
+    }
+    return hash;
+}
+
+/**
+ * Mnoży moduł przez słowo i dodaje do niego słowo.
+ * @param[in,out] limbs : słowa modułu; tablica ma miejsce na jedno słowo
+ * więcej niż @p size
+ * @param[in,out] size : liczba słów modułu
+ * @param[in] mul : czynnik
+ * @param[in] add : składnik
+ */
+static void MagMulAddWord(uint64_t limbs[], size_t *size, uint64_t mul,
+                          uint64_t add) {
+    uint64_t carry = add;
+    for (size_t i = 0; i < *size; i++) {
+        unsigned __int128 t = (unsigned __int128) limbs[i] * mul + carry;
+        limbs[i] = (uint64_t) t;
+        carry = (uint64_t) (t >> 64);
+    }
+    if (carry != 0)
+        limbs[(*size)++] = carry;
+}
+
+/**
+ * Dzieli moduł przez słowo.
+ * @param[in,out] limbs : słowa modułu, po wywołaniu słowa ilorazu
+ * @param[in,out] size : liczba słów modułu, po wywołaniu liczba słów ilorazu
+ * @param[in] div : dzielnik, dodatni
+ * @return reszta z dzielenia
+ */
+static uint64_t MagDivWord(uint64_t limbs[], size_t *size, uint64_t div) {
+    uint64_t rem = 0;
+    for (size_t i = *size; i > 0; i--) {
+        unsigned __int128 t = ((unsigned __int128) rem << 64) | limbs[i - 1];
+        limbs[i - 1] = (uint64_t) (t / div);
+        rem = (uint64_t) (t % div);
+    }
+    while (*size > 0 && limbs[*size - 1] == 0)
+        (*size)--;
+    return rem;
+}
+
+bool BigCoeffParse(const char *begin, const char *end, Poly *out) {
+    bool negative = begin < end && *begin == '-';
+    if (negative)
+        begin++;
+    if (begin >= end)
+        return false;
+    for (const char *c = begin; c < end; c++) {
+        if (*c < '0' || *c > '9')
+            return false;
+    }
+
+    // każde 19 cyfr zajmuje mniej niż jedno słowo
+    size_t digits = end - begin;
+    uint64_t local[BIG_LOCAL_LIMBS] = {0};
+    uint64_t *limbs = Scratch(digits / BIG_DECIMAL_DIGITS + 2, local);
+    size_t size = 0;
+    while (begin < end) {
+        uint64_t chunk = 0, mul = 1;
+        for (int i = 0; i < BIG_DECIMAL_DIGITS && begin < end; i++) {
+            chunk = chunk * 10 + (uint64_t) (*begin++ - '0');
+            mul *= 10;
+        }
+        MagMulAddWord(limbs, &size, mul, chunk);
+    }
+
+    *out = MakeCoeff(limbs, size, negative);
+    ScratchFree(limbs, local);
+    return true;
+}
+
+Poly BigCoeffFromLimbs(const uint64_t limbs[], size_t size, bool negative) {
+    return MakeCoeff(limbs, size, negative);
+}
+
+void BigCoeffPrint(const Poly *a) {
+    BigView va;
+    ViewOf(a, &va);
+    if (va.negative)
+        OutputChar('-');
+
+    // cyfry wyznaczane są od najmniej znaczących w grupach po 19
+    uint64_t local[BIG_LOCAL_LIMBS], groups_local[BIG_LOCAL_LIMBS];
+    uint64_t *limbs = Scratch(va.size + 1, local);
+    uint64_t *groups = Scratch(2 * va.size + 1, groups_local);
+    memcpy(limbs, va.limbs, va.size * sizeof(uint64_t));
+    size_t size = va.size, count = 0;
+    do {
+        groups[count++] = MagDivWord(limbs, &size, BIG_DECIMAL_BASE);
+    } while (size > 0);
+
+    OutputUnsigned(groups[count - 1], 0);
+    for (size_t i = count - 1; i > 0; i--)
+        OutputUnsigned(groups[i - 1], BIG_DECIMAL_DIGITS);
+
+    ScratchFree(groups, groups_local);
+    ScratchFree(limbs, local);
+}
@@ -0,0 +1,145 @@
+/** @file
+ * Interfejs modułu odpowiedzialnego za współczynniki będące liczbami
+ * całkowitymi dowolnej precyzji.
+ * W trybie dokładnym (zob. @ref CoeffExactSet(void)) współczynnik, którego
+ * wartość nie mieści się w typie @ref poly_coeff_t, przechowywany jest jako
+ * wielomian stały z `arr == POLY_BIG_ARR`, wskazujący na liczbę
+ * @ref BigInt. Liczba zapisana jest w postaci znak-moduł, a jej moduł
+ * w 64-bitowych słowach od najmniej znaczącego. Liczby są niezmienne
+ * i mogą być współdzielone dzięki atomowemu licznikowi odwołań.
+ * Funkcje tego modułu zwracają wielomian stały z liczbą typu
+ * @ref poly_coeff_t zawsze, gdy wynik mieści się w tym typie.
+ * Liczby o niewielkiej liczbie słów przydzielane są z areny tego modułu
+ * (chyba że projekt skompilowano z opcją `POLY_USE_MALLOC`).
+ *
+ * @author Jan Kwiatkowski
+ */
+
+#ifndef POLYNOMIALS_BIG_COEFF_H
+#define POLYNOMIALS_BIG_COEFF_H
+
+#include "poly.h"
+#include <stdatomic.h>
+#include <stdint.h>
+
+/** Największa liczba słów liczby przydzielanej z areny. */
+#define BIG_ARENA_MAX_LIMBS 8
+
+/** Przybliżony rozmiar jednego bloku areny w bajtach. */
+#define BIG_ARENA_CHUNK_SIZE ((size_t) 1 << 14)
+
+/**
+ * Licznik odwołań liczby, która nie jest zwalniana i nie jest zmieniana,
+ * np. leży w odwzorowanym w pamięci pliku (zob. @ref PolyImageLoad).
+ */
+#define BIG_IMMORTAL SIZE_MAX
+
+/**
+ * Liczba całkowita dowolnej precyzji.
+ */
+typedef struct BigInt {
+    atomic_size_t refcount; ///< liczba wielomianów korzystających z liczby
+    size_t capacity; ///< liczba słów mieszczących się w @p limbs
+    size_t size; ///< liczba słów modułu; najbardziej znaczące jest niezerowe
+    bool negative; ///< czy liczba jest ujemna
+    uint64_t limbs[]; ///< słowa modułu od najmniej znaczącego
+} BigInt;
+
+/**
+ * Dodaje dwa współczynniki dokładnie.
+ * @param[in] a : wielomian stały
+ * @param[in] b : wielomian stały
+ * @return @f$a + b@f$
+ */
+Poly BigCoeffAdd(const Poly *a, const Poly *b);
+
+/**
+ * Mnoży dwa współczynniki dokładnie.
+ * @param[in] a : wielomian stały
+ * @param[in] b : wielomian stały
+ * @return @f$a \cdot b@f$
+ */
+Poly BigCoeffMul(const Poly *a, const Poly *b);
+
+/**
+ * Zwraca współczynnik przeciwny.
+ * @param[in] a : wielomian stały
+ * @return @f$-a@f$
+ */
+Poly BigCoeffNeg(const Poly *a);
+
+/**
+ * Sprawdza równość dwóch współczynników.
+ * @param[in] a : wielomian stały
+ * @param[in] b : wielomian stały
+ * @return @f$a = b@f$
+ */
+bool BigCoeffEq(const Poly *a, const Poly *b);
+
+/**
+ * Zwraca resztę z dzielenia współczynnika przez @f$2^{64}@f$, czyli wartość,
+ * jaką miałby on w obliczeniach bez trybu dokładnego.
+ * @param[in] a : wielomian stały
+ * @return @f$a \bmod 2^{64}@f$ jako liczba typu @ref poly_coeff_t
+ */
+poly_coeff_t BigCoeffLow(const Poly *a);
+
+/**
+ * Zwraca resztę z dzielenia współczynnika przez moduł.
+ * @param[in] a : wielomian stały
+ * @param[in] p : moduł, dodatni
+ * @return reszta z przedziału @f$[0, p)@f$
+ */
+poly_coeff_t BigCoeffMod(const Poly *a, unsigned long p);
+
+/**
+ * Wyznacza skrót współczynnika. Równe współczynniki mają równe skróty.
+ * @param[in] a : wielomian stały
+ * @return skrót
+ */
+uint64_t BigCoeffHash(const Poly *a);
+
+/**
+ * Tworzy współczynnik z zapisu dziesiętnego postaci `-?[0-9]+`.
+ * @param[in] begin : początek ciągu znaków
+ * @param[in] end : pierwszy znak poza ciągiem znaków
+ * @param[out] out : utworzony współczynnik
+ * @return czy ciąg znaków jest poprawnym zapisem liczby
+ */
+bool BigCoeffParse(const char *begin, const char *end, Poly *out);
+
+/**
+ * Tworzy współczynnik o podanym module i znaku.
+ * @param[in] limbs : słowa modułu od najmniej znaczącego
+ * @param[in] size : liczba słów modułu
+ * @param[in] negative : czy współczynnik jest ujemny
+ * @return utworzony współczynnik
+ */
+Poly BigCoeffFromLimbs(const uint64_t limbs[], size_t size, bool negative);
+
+/**
+ * Wypisuje współczynnik w zapisie dziesiętnym do bufora standardowego
+ * wyjścia (zob. @ref OutputFlush).
+ * @param[in] a : wielomian stały
+ */
+void BigCoeffPrint(const Poly *a);
+
+/**
+ * Zwiększa licznik odwołań liczby.
+ * @param[in] big : liczba
+ */
+void BigRetain(BigInt *big);
+
+/**
+ * Zmniejsza licznik odwołań liczby i zwalnia ją, gdy nie jest już używana.
+ * @param[in] big : liczba
+ */
+void BigUnref(BigInt *big);
+
+/**
+ * Zwalnia całą pamięć areny. Może być wywołana jedynie wtedy, gdy nie
+ * istnieje żadna liczba przydzielona z areny, np. przy zakończeniu programu.
+ */
+void BigArenaRelease(void);
+
+#endif //POLYNOMIALS_BIG_COEFF_H
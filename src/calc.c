@@ -7,57 +7,327 @@
 #define _GNU_SOURCE
 
 #include "poly.h"
+#include "big_coeff.h"
+#include "coeff_mod.h"
+#include "mono_pool.h"
+#include "output.h"
+#include "poly_image.h"
 #include "poly_stack.h"
+#include "power_cache.h"
+#include "line_queue.h"
 #include "process_line.h"
+#include "thread_pool.h"
+#include "utilities.h"
 #include <stdio.h>
 #include <errno.h>
+#include <pthread.h>
 #include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/** Rozmiar bloku wczytywanego naraz z wejścia, które nie jest plikiem. */
+#define READ_BLOCK_SIZE ((size_t) 1 << 20)
 
 /**
- * Wczytuje jedną linię z wejścia.
- * @param[in,out] input : wskaźnik na miejsce, w którym zapisywany jest
- * wczytany ciąg znaków
- * @param[out] read_characters : liczba wczytanych przez getline() znaków
- * @param[in,out] getline_size : długość bufora w getline()
+ * Standardowe wejście dzielone na wiersze.
+ * Zwykły plik jest odwzorowywany w pamięci w całości, a inne wejście
+ * (np. potok) wczytywane jest dużymi blokami do bufora.
  */
-static void Read(char **input, ssize_t *read_characters, size_t *getline_size) {
-    *read_characters = getline(input, getline_size, stdin);
+typedef struct Input {
+    char *data; ///< wczytane znaki
+    size_t size; ///< liczba wczytanych znaków
+    size_t pos; ///< początek kolejnego wiersza
+    size_t scanned; ///< koniec przeszukanej części kolejnego wiersza
+    size_t capacity; ///< pojemność bufora; 0 dla odwzorowanego pliku
+    bool eof; ///< czy wczytano już całe wejście
+} Input;
 
-    // jeśli wczytywanie nie powiodło się ze względu na brak pamięci
-    if (!CheckErrno()) {
-        exit(1);
+/**
+ * Przygotowuje standardowe wejście do wczytywania wierszy.
+ * @param[out] in : wejście
+ */
+static void InputOpen(Input *in) {
+    *in = (Input) {.data = NULL, .size = 0, .pos = 0, .scanned = 0,
+                   .capacity = 0, .eof = false};
+
+    struct stat st;
+    off_t offset = lseek(STDIN_FILENO, 0, SEEK_CUR);
+    if (fstat(STDIN_FILENO, &st) == 0 && S_ISREG(st.st_mode) && offset >= 0 &&
+        st.st_size > offset) {
+        void *data = mmap(NULL, (size_t) st.st_size, PROT_READ, MAP_PRIVATE,
+                          STDIN_FILENO, 0);
+        if (data != MAP_FAILED) {
+            madvise(data, (size_t) st.st_size, MADV_SEQUENTIAL);
+            // wczytywanie zaczyna się od bieżącego miejsca w pliku
+            in->data = data;
+            in->size = (size_t) st.st_size;
+            in->pos = in->scanned = (size_t) offset;
+            in->eof = true;
+            return;
+        }
     }
+
+    in->capacity = READ_BLOCK_SIZE;
+    in->data = SafeMalloc(in->capacity);
 }
 
 /**
- * Wczytuje dane i wywołuje odpowiednie funkcje w celu ich przetworzenia.
- * @return kod wyjściowy programu
+ * Dowczytuje do bufora kolejny blok wejścia, przesuwając niewczytany
+ * jeszcze wiersz na początek bufora.
+ * @param[in,out] in : wejście, które nie jest odwzorowanym plikiem
  */
-int main() {
-    Stack *stack = StackCreate();
-    char *input = NULL;
-    size_t getline_size = 0;
-    errno = 0;
-    size_t lines_counter = 0;
+static void InputFill(Input *in) {
+    in->size -= in->pos;
+    in->scanned -= in->pos;
+    memmove(in->data, in->data + in->pos, in->size);
+    in->pos = 0;
+    // wiersz nie mieści się w buforze
+    if (in->size == in->capacity) {
+        in->capacity *= 2;
+        in->data = SafeRealloc(in->data, in->capacity);
+    }
+
+    ssize_t n;
+    do {
+        n = read(STDIN_FILENO, in->data + in->size, in->capacity - in->size);
+    } while (n < 0 && errno == EINTR);
+    // błąd wczytywania pozostaje w zmiennej errno i kończy program tak jak
+    // błąd getline()
+    in->eof = n <= 0;
+    if (n > 0)
+        in->size += (size_t) n;
+}
+
+/**
+ * Wskazuje kolejny wiersz wejścia bez kopiowania go. Koniec wiersza
+ * wyszukiwany jest funkcją memchr().
+ * @param[in,out] in : wejście
+ * @param[out] line : początek wiersza
+ * @param[out] size : liczba znaków wiersza bez znaku nowej linii
+ * @param[out] newline : czy wiersz kończy się znakiem nowej linii
+ * @return czy na wejściu był jeszcze jakiś wiersz
+ */
+static bool InputLine(Input *in, char **line, size_t *size, bool *newline) {
+    while (true) {
+        char *end = memchr(in->data + in->scanned, '\n',
+                           in->size - in->scanned);
+        if (end != NULL) {
+            *line = in->data + in->pos;
+            *size = (size_t) (end - *line);
+            *newline = true;
+            in->pos = in->scanned = (size_t) (end - in->data) + 1;
+            return true;
+        }
+        in->scanned = in->size;
+
+        if (in->eof) {
+            if (in->pos == in->size)
+                return false;
+            *line = in->data + in->pos;
+            *size = in->size - in->pos;
+            *newline = false;
+            in->pos = in->size;
+            return true;
+        }
+        InputFill(in);
+    }
+}
+
+/**
+ * Zwalnia pamięć zajmowaną przez wejście.
+ * @param[in,out] in : wejście
+ */
+static void InputClose(Input *in) {
+    if (in->capacity == 0) {
+        if (in->data != NULL)
+            munmap(in->data, in->size);
+    } else {
+        free(in->data);
+    }
+}
+
+/**
+ * Wczytywanie wejścia i przygotowywanie wierszy do wykonania.
+ */
+typedef struct Reader {
+    Input in; ///< wejście
+    size_t lines; ///< liczba wczytanych wierszy
+    LineQueue *queue; ///< kolejka wierszy do wykonania lub NULL
+} Reader;
+
+/**
+ * Wczytuje kolejny wiersz wejścia i przygotowuje go do wykonania.
+ * @param[in,out] reader : wczytywane wejście
+ * @param[out] parsed : przygotowany wiersz lub @ref LINE_END na końcu
+ * wejścia
+ */
+static void ReadLine(Reader *reader, ParsedLine *parsed) {
+    char *line;
+    size_t size;
+    bool newline;
+    bool read = InputLine(&reader->in, &line, &size, &newline);
+
+    // tak jak po wczytaniu wiersza funkcją getline() kończymy działanie,
+    // jeśli zmienna errno wskazuje błąd
+    bool correct = CheckErrno();
+    if (!read || !correct) {
+        parsed->kind = LINE_END;
+        parsed->failed = !correct;
+        parsed->barrier = false;
+        return;
+    }
 
+    ParseSlice(++reader->lines, line, size, newline, parsed);
+    // błąd zgłoszony przy wczytywaniu wielomianu kończy program po wykonaniu
+    // tego wiersza, tak jak przed podziałem na wątki
+    parsed->failed = !CheckErrno();
+}
+
+/**
+ * Wykonuje przygotowany wiersz na stosie.
+ * @param[in,out] parsed : przygotowany wiersz
+ * @param[in,out] stack : stos
+ * @return czy należy wykonywać kolejne wiersze
+ */
+static bool Execute(ParsedLine *parsed, Stack *stack) {
+    if (parsed->kind == LINE_END) {
+        if (parsed->failed)
+            exit(1);
+        return false;
+    }
+
+    ExecuteLine(parsed, stack);
+    if (!CheckErrno() || parsed->failed)
+        exit(1);
+    return true;
+}
+
+/**
+ * Funkcja wątku wczytującego: przygotowuje kolejne wiersze i przekazuje je
+ * do kolejki. Po komendzie, która może zmienić arytmetykę współczynników,
+ * czeka na jej wykonanie, zanim wczyta kolejny wielomian.
+ * @param[in,out] arg : wczytywane wejście (@ref Reader)
+ * @return NULL
+ */
+static void* ReaderThread(void *arg) {
+    Reader *reader = arg;
     while (true) {
-        ssize_t read_characters;
+        ParsedLine *parsed = LineQueueReserve(reader->queue);
+        ReadLine(reader, parsed);
+        LineKind kind = parsed->kind;
+        bool barrier = parsed->barrier;
+        LineQueuePush(reader->queue);
+        if (kind == LINE_END)
+            return NULL;
+        if (barrier)
+            LineQueueDrain(reader->queue);
+    }
+}
 
-        Read(&input, &read_characters, &getline_size);
+/**
+ * Odczytuje nieujemną liczbę całkowitą zapisaną w systemie dziesiętnym.
+ * @param[in] arg : napis
+ * @param[out] value : liczba
+ * @return czy napis jest poprawną liczbą
+ */
+static bool ParseNumber(const char *arg, unsigned long *value) {
+    if (arg[0] < '0' || arg[0] > '9')
+        return false;
+
+    char *endptr;
+    errno = 0;
+    *value = strtoul(arg, &endptr, 10);
+    return *endptr == '\0' && errno == 0;
+}
 
-        // nie ma już nic do wczytania
-        if (read_characters == -1) {
-            break;
+/**
+ * Odczytuje argumenty programu. Obsługiwane są argumenty `-t N`, gdzie
+ * @f$N@f$ jest dodatnią liczbą wątków, `-m P`, gdzie @f$P@f$ jest
+ * modułem współczynników (zob. @ref CoeffModulusSet(unsigned long p)), oraz
+ * `-x`, który włącza tryb dokładny (zob. @ref CoeffExactSet(void)).
+ * @param[in] argc : liczba argumentów
+ * @param[in] argv : argumenty
+ * @param[out] threads : liczba wątków lub 0, jeśli nie została podana
+ * @return czy argumenty są poprawne
+ */
+static bool ParseArguments(int argc, char *argv[], size_t *threads) {
+    *threads = 0;
+    for (int i = 1; i < argc; i += 2) {
+        if (strcmp(argv[i], "-x") == 0) {
+            CoeffExactSet();
+            i--;
+            continue;
         }
 
-        size_t read_chars = (size_t) (read_characters);
+        unsigned long value;
+        if (i + 1 == argc || !ParseNumber(argv[i + 1], &value))
+            return false;
+
+        if (strcmp(argv[i], "-t") == 0 && value > 0)
+            *threads = value;
+        else if (strcmp(argv[i], "-m") != 0 || !CoeffModulusSet(value))
+            return false;
+    }
+    return true;
+}
+
+/**
+ * Wczytuje dane i wywołuje odpowiednie funkcje w celu ich przetworzenia.
+ * @param[in] argc : liczba argumentów programu
+ * @param[in] argv : argumenty programu
+ * @return kod wyjściowy programu
+ */
+int main(int argc, char *argv[]) {
+    size_t threads;
+    if (!ParseArguments(argc, argv, &threads)) {
+        fprintf(stderr, "Usage: %s [-t THREADS] [-m MODULUS] [-x]\n", argv[0]);
+        return 1;
+    }
+    // wynik jest wypisywany także przy zakończeniu programu funkcją exit()
+    atexit(OutputFlush);
+    ThreadPoolInit(threads);
+
+    Stack *stack = StackCreate();
+    Reader reader = {.lines = 0, .queue = NULL};
+    InputOpen(&reader.in);
 
-        lines_counter++;
-        ProcessInput(&lines_counter, &read_chars, input, stack);
+    // wczytywanie i wykonywanie wierszy w osobnych wątkach ma sens tylko
+    // wtedy, gdy mogą one działać jednocześnie
+    pthread_t reader_thread;
+    if (sysconf(_SC_NPROCESSORS_ONLN) > 1) {
+        reader.queue = LineQueueCreate();
+        if (pthread_create(&reader_thread, NULL, ReaderThread, &reader) != 0) {
+            LineQueueDestroy(reader.queue);
+            reader.queue = NULL;
+        }
+    }
+    errno = 0;
+
+    if (reader.queue != NULL) {
+        bool more = true;
+        while (more) {
+            ParsedLine *parsed = LineQueueFront(reader.queue);
+            more = Execute(parsed, stack);
+            LineQueuePop(reader.queue);
+        }
+        pthread_join(reader_thread, NULL);
+        LineQueueDestroy(reader.queue);
+    } else {
+        ParsedLine parsed;
+        do {
+            ReadLine(&reader, &parsed);
+        } while (Execute(&parsed, stack));
     }
 
-    free(input);
+    InputClose(&reader.in);
     StackClear(stack);
+    PowerCacheClear();
+    PolyImageRelease();
+    ThreadPoolShutdown();
+    MonoPoolRelease();
+    BigArenaRelease();
 
     return 0;
 }
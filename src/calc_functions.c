@@ -6,9 +6,15 @@
  */
 
 #include "calc_functions.h"
+#include "coeff_mod.h"
+#include "output.h"
 #include "poly.h"
+#include "poly_binary.h"
+#include "poly_image.h"
 #include "poly_stack.h"
+#include "power_cache.h"
 #include "utilities.h"
+#include <errno.h>
 #include <stdio.h>
 #include <stdlib.h>
 
@@ -77,6 +83,16 @@ bool Neg(Stack *stack) {
     return true;
 }
 
+bool Pow(Stack *stack, poly_exp_t n) {
+    if (StackUnderflow(stack, 1))
+        return false;
+    Poly *top = StackPop(stack);
+    Poly poly = PolyPow(top, n);
+    PolyDestroy(top);
+    StackPush(stack, &poly);
+    return true;
+}
+
 bool Sub(Stack *stack) {
     if (StackUnderflow(stack, 2))
         return false;
@@ -102,7 +118,37 @@ bool Deg(Stack *stack) {
     if (StackUnderflow(stack, 1))
         return false;
     Poly *top = StackTop(stack);
-    printf("%d\n", PolyDeg(top));
+    OutputLong(PolyDeg(top));
+    OutputEndLine();
+    return true;
+}
+
+bool Hash(Stack *stack) {
+    if (StackUnderflow(stack, 1))
+        return false;
+    Poly *top = StackTop(stack);
+    OutputHex64(PolyHash(top));
+    OutputEndLine();
+    return true;
+}
+
+bool Stat(Stack *stack) {
+    if (StackUnderflow(stack, 1))
+        return false;
+    PolyMeta meta = PolyGetMeta(StackTop(stack));
+    OutputString("terms=");
+    OutputUnsigned(meta.terms, 0);
+    OutputString(" depth=");
+    OutputUnsigned(meta.depth, 0);
+    OutputString(" deg=");
+    OutputLong(meta.deg);
+    OutputString(" deg_by=");
+    for (size_t v = 0; v < meta.depth && v < POLY_META_VARS; v++) {
+        if (v != 0)
+            OutputChar(',');
+        OutputLong(meta.deg_by[v]);
+    }
+    OutputEndLine();
     return true;
 }
 
@@ -110,7 +156,8 @@ bool DegBy(Stack *stack, size_t idx) {
     if (StackUnderflow(stack, 1))
         return false;
     Poly *top = StackTop(stack);
-    printf("%d\n", PolyDegBy(top, idx));
+    OutputLong(PolyDegBy(top, idx));
+    OutputEndLine();
     return true;
 }
 
@@ -124,12 +171,25 @@ bool At(Stack *stack, poly_coeff_t x) {
     return true;
 }
 
+bool AtBatch(Stack *stack, size_t n, const poly_coeff_t xs[]) {
+    if (StackUnderflow(stack, 1))
+        return false;
+    Poly top = *StackPop(stack);
+    Poly *values = SafeMalloc(n * sizeof(Poly));
+    PolyAtMany(&top, n, xs, values);
+    PolyDestroy(&top);
+    for (size_t i = 0; i < n; i++)
+        StackPush(stack, &values[i]);
+    free(values);
+    return true;
+}
+
 bool Print(Stack *stack) {
     if (StackUnderflow(stack, 1))
         return false;
     Poly *top = StackTop(stack);
     PolyPrint(top);
-    printf("\n");
+    OutputEndLine();
     return true;
 }
 
@@ -141,6 +201,31 @@ bool Pop(Stack *stack) {
     return true;
 }
 
+bool PowerCacheInfo(Stack *stack) {
+    (void) stack;
+    PowerCacheStats stats = PowerCacheGetStats();
+    OutputString("entries=");
+    OutputUnsigned(stats.entries, 0);
+    OutputString(" terms=");
+    OutputUnsigned(stats.terms, 0);
+    OutputString(" hits=");
+    OutputUnsigned(stats.hits, 0);
+    OutputString(" extensions=");
+    OutputUnsigned(stats.extensions, 0);
+    OutputString(" misses=");
+    OutputUnsigned(stats.misses, 0);
+    OutputString(" evictions=");
+    OutputUnsigned(stats.evictions, 0);
+    OutputEndLine();
+    return true;
+}
+
+bool PowerCacheReset(Stack *stack) {
+    (void) stack;
+    PowerCacheClear();
+    return true;
+}
+
 bool Compose(Stack *stack, size_t k) {
     if (stack->size <= k)
         return false;
@@ -157,3 +242,112 @@ bool Compose(Stack *stack, size_t k) {
     free(variables);
     return true;
 }
+
+bool Eval(Stack *stack, size_t k, bool *correct) {
+    if (stack->size <= k)
+        return false;
+
+    *correct = true;
+    for (size_t i = 0; i < k; i++)
+        *correct &= PolyIsCoeff(&stack->arr[stack->size - 1 - i]);
+    if (!*correct)
+        return true;
+
+    // w trybie dokładnym wartość może nie mieścić się w poly_coeff_t, więc
+    // wyznaczamy ją, składając wielomian z wielomianami stałymi
+    if (CoeffExactActive()) {
+        Poly *xs = SafeMalloc((k + 1) * sizeof(Poly));
+        for (size_t i = 0; i < k; i++)
+            xs[k - i - 1] = *StackPop(stack);
+        Poly value = PolyCompose(StackTop(stack), k, xs);
+        StackPush(stack, &value);
+        for (size_t i = 0; i < k; i++)
+            PolyDestroy(&xs[i]);
+        free(xs);
+        return true;
+    }
+
+    poly_coeff_t *x = SafeMalloc((k + 1) * sizeof(poly_coeff_t));
+    for (size_t i = 0; i < k; i++)
+        x[k - i - 1] = StackPop(stack)->coeff;
+
+    Poly value = PolyFromCoeff(PolyEvalPlanRun(StackTopPlan(stack), k, x));
+    StackPush(stack, &value);
+    free(x);
+    return true;
+}
+
+bool Exact(Stack *stack) {
+    (void) stack;
+    CoeffExactSet();
+    return true;
+}
+
+bool Mod(Stack *stack, size_t p, bool *correct) {
+    *correct = CoeffModulusSet(p);
+    if (*correct)
+        StackMap(stack, PolyReduceCoeffs);
+    return true;
+}
+
+bool SaveBin(Stack *stack, const char *path, bool *correct) {
+    if (StackUnderflow(stack, 1))
+        return false;
+    // kalkulator rozpoznaje błędy wczytywania wejścia po zmiennej errno
+    int saved_errno = errno;
+    FILE *file = fopen(path, "wb");
+    *correct = file != NULL;
+    if (*correct) {
+        *correct = PolyWriteBinary(StackTop(stack), file);
+        *correct &= fclose(file) == 0;
+    }
+    errno = saved_errno;
+    return true;
+}
+
+bool LoadBin(Stack *stack, const char *path, bool *correct) {
+    int saved_errno = errno;
+    FILE *file = fopen(path, "rb");
+    *correct = file != NULL;
+    if (*correct) {
+        Poly poly;
+        *correct = PolyReadBinary(file, &poly);
+        fclose(file);
+        if (*correct)
+            StackPush(stack, &poly);
+    }
+    errno = saved_errno;
+    return true;
+}
+
+bool Checkpoint(Stack *stack, const char *path, bool *correct) {
+    int saved_errno = errno;
+    *correct = PolyImageSave(path, stack->size, stack->arr);
+    errno = saved_errno;
+    return true;
+}
+
+bool Restore(Stack *stack, const char *path, bool *correct) {
+    int saved_errno = errno;
+    PolyImage image;
+    *correct = PolyImageOpen(path, &image);
+    if (*correct) {
+        // poza stosem i pamięcią potęg nic nie korzysta z poprzednich
+        // obrazów, więc można je zwolnić i odwzorować nowy pod ich adresem
+        while (!StackIsEmpty(stack))
+            PolyDestroy(StackPop(stack));
+        PowerCacheClear();
+        PolyImageRelease();
+
+        size_t n;
+        Poly *polys;
+        *correct = PolyImageCommit(&image, &n, &polys);
+        if (*correct) {
+            for (size_t i = 0; i < n; i++)
+                StackPush(stack, &polys[i]);
+            free(polys);
+        }
+    }
+    errno = saved_errno;
+    return true;
+}
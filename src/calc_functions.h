@@ -65,6 +65,15 @@ bool Mul(Stack *stack);
  */
 bool Neg(Stack *stack);
 
+/**
+ * Podnosi wielomian z wierzchołka stosu do potęgi @p n (zob.
+ * @ref PolyPow(const Poly *p, poly_exp_t n)).
+ * @param[in,out] stack : stos
+ * @param[in] n : wykładnik, nieujemny
+ * @return czy udało się poprawnie wykonać funkcję
+ */
+bool Pow(Stack *stack, poly_exp_t n);
+
 /**
  * Odejmuje od wielomianu z wierzchołka stosu wielomian znajdujący się
  * bezpośrednio pod nim, wstawia różnicę na stos.
@@ -89,6 +98,24 @@ bool IsEq(Stack *stack);
  */
 bool Deg(Stack *stack);
 
+/**
+ * Wyznacza skrót wielomianu z wierzchołka stosu (zob.
+ * @ref PolyHash(const Poly *p)).
+ * Wypisuje go na standardowe wyjście jako 16 cyfr szesnastkowych.
+ * @param[in] stack : stos
+ * @return czy udało się poprawnie wykonać funkcję
+ */
+bool Hash(Stack *stack);
+
+/**
+ * Wypisuje na standardowe wyjście opis wielomianu z wierzchołka stosu (zob.
+ * @ref PolyMeta): liczbę współczynników, głębokość, stopień oraz stopnie ze
+ * względu na kolejne zmienne (co najwyżej @ref POLY_META_VARS pierwszych).
+ * @param[in] stack : stos
+ * @return czy udało się poprawnie wykonać funkcję
+ */
+bool Stat(Stack *stack);
+
 /**
  * Wyznacza stopień wielomianu z wierzchołka stosu ze względu na zmienną
  * o numerze @p idx.
@@ -109,6 +136,17 @@ bool DegBy(Stack *stack, size_t idx);
  */
 bool At(Stack *stack, poly_coeff_t x);
 
+/**
+ * Wyznacza wartości wielomianu z wierzchołka stosu w punktach z tablicy
+ * @p xs, usuwa wielomian z wierzchołka stosu i wstawia na stos kolejno
+ * wyznaczone wielomiany (wartość w ostatnim punkcie trafia na wierzchołek).
+ * @param[in,out] stack : stos
+ * @param[in] n : liczba punktów
+ * @param[in] xs : punkty, w których liczone są wartości
+ * @return czy udało się poprawnie wykonać funkcję
+ */
+bool AtBatch(Stack *stack, size_t n, const poly_coeff_t xs[]);
+
 /**
  * Wypisuje wielomian z wierzchołka stosu.
  * @param[in] stack : stos
@@ -123,6 +161,22 @@ bool Print(Stack *stack);
  */
 bool Pop(Stack *stack);
 
+/**
+ * Wypisuje statystyki pamięci podręcznej potęg wykorzystywanej przez
+ * @ref Compose(Stack *stack, size_t k). Nie korzysta ze stosu.
+ * @param[in] stack : stos
+ * @return czy udało się poprawnie wykonać funkcję
+ */
+bool PowerCacheInfo(Stack *stack);
+
+/**
+ * Opróżnia pamięć podręczną potęg wykorzystywaną przez
+ * @ref Compose(Stack *stack, size_t k). Nie korzysta ze stosu.
+ * @param[in] stack : stos
+ * @return czy udało się poprawnie wykonać funkcję
+ */
+bool PowerCacheReset(Stack *stack);
+
 /**
  * Pod pierwsze @p k zmiennych wielomianu z wierzchołka stosu wstawia @p k
  * wielomianów znajdujących się pod nim na stosie.
@@ -132,4 +186,90 @@ bool Pop(Stack *stack);
  */
 bool Compose(Stack *stack, size_t k);
 
+/**
+ * Zdejmuje ze stosu @p k wielomianów stałych @f$x_{k-1}, \ldots, x_0@f$
+ * (wartość @f$x_0@f$ leży najgłębiej) i wstawia na stos wartość wielomianu,
+ * który znalazł się na wierzchołku, w punkcie @f$(x_0, \ldots, x_{k-1})@f$.
+ * Ten wielomian pozostaje na stosie, a jego skompilowany plan obliczeń jest
+ * wykorzystywany przy kolejnych wywołaniach.
+ * W trybie dokładnym (zob. @ref CoeffExactSet(void)) wartość wyznaczana jest
+ * dokładnie, bez planu obliczeń.
+ * Jeśli któryś z @p k wielomianów nie jest stały, nie zmienia stosu.
+ * @param[in,out] stack : stos
+ * @param[in] k : liczba zmiennych
+ * @param[out] correct : czy wszystkie wartości zmiennych są wielomianami
+ * stałymi
+ * @return czy udało się poprawnie wykonać funkcję
+ */
+bool Eval(Stack *stack, size_t k, bool *correct);
+
+/**
+ * Włącza tryb dokładny (zob. @ref CoeffExactSet(void)), w którym
+ * współczynniki nie są ograniczone zakresem typu @ref poly_coeff_t. Nie
+ * korzysta ze stosu.
+ * @param[in] stack : stos
+ * @return czy udało się poprawnie wykonać funkcję
+ */
+bool Exact(Stack *stack);
+
+/**
+ * Ustawia moduł współczynników (zob.
+ * @ref CoeffModulusSet(unsigned long p)) i sprowadza współczynniki
+ * wszystkich wielomianów na stosie do reszt modulo ten moduł. Moduł 0
+ * przywraca obliczenia modulo @f$2^{64}@f$. Oba wyłączają tryb dokładny.
+ * Jeśli moduł jest niepoprawny, nie zmienia stosu.
+ * @param[in,out] stack : stos
+ * @param[in] p : moduł
+ * @param[out] correct : czy moduł jest poprawny
+ * @return czy udało się poprawnie wykonać funkcję
+ */
+bool Mod(Stack *stack, size_t p, bool *correct);
+
+/**
+ * Zapisuje wielomian z wierzchołka stosu do pliku @p path w formacie
+ * binarnym (zob. @ref PolyWriteBinary(const Poly *p, FILE *file)),
+ * zastępując poprzednią zawartość pliku.
+ * @param[in] stack : stos
+ * @param[in] path : ścieżka pliku
+ * @param[out] correct : czy udało się zapisać plik
+ * @return czy udało się poprawnie wykonać funkcję
+ */
+bool SaveBin(Stack *stack, const char *path, bool *correct);
+
+/**
+ * Odczytuje wielomian zapisany w formacie binarnym (zob.
+ * @ref PolyReadBinary(FILE *file, Poly *p)) z pliku @p path i wstawia go na
+ * stos. Jeśli pliku nie udało się odczytać, nie zmienia stosu.
+ * @param[in,out] stack : stos
+ * @param[in] path : ścieżka pliku
+ * @param[out] correct : czy plik zawiera poprawny zapis wielomianu
+ * @return czy udało się poprawnie wykonać funkcję
+ */
+bool LoadBin(Stack *stack, const char *path, bool *correct);
+
+/**
+ * Zapisuje cały stos wraz z bieżącą arytmetyką współczynników do pliku
+ * @p path jako obraz (zob. @ref PolyImageSave), zastępując poprzednią
+ * zawartość pliku.
+ * @param[in] stack : stos
+ * @param[in] path : ścieżka pliku
+ * @param[out] correct : czy udało się zapisać plik
+ * @return czy udało się poprawnie wykonać funkcję
+ */
+bool Checkpoint(Stack *stack, const char *path, bool *correct);
+
+/**
+ * Zastępuje cały stos wielomianami z obrazu zapisanego w pliku @p path
+ * (zob. @ref PolyImageLoad) i przywraca zapisaną w nim arytmetykę
+ * współczynników. Wielomiany korzystają wprost z odwzorowanego pliku.
+ * Po sprawdzeniu nowego obrazu czyści pamięć potęg i zwalnia poprzednie
+ * obrazy, więc każdy obraz odwzorowywany jest pod tym samym adresem. Jeśli
+ * pliku nie udało się odczytać, nie zmienia stosu.
+ * @param[in,out] stack : stos
+ * @param[in] path : ścieżka pliku
+ * @param[out] correct : czy plik jest poprawnym obrazem
+ * @return czy udało się poprawnie wykonać funkcję
+ */
+bool Restore(Stack *stack, const char *path, bool *correct);
+
 #endif //POLYNOMIALS_CALC_FUNCTIONS_H
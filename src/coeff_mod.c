@@ -0,0 +1,35 @@
+/** @file
+ * Implementacja modułu odpowiedzialnego za arytmetykę współczynników.
+ *
+ * @author Jan Kwiatkowski
+ */
+
+#include "coeff_mod.h"
+
+CoeffModulus coeff_modulus = {.p = 0, .neg_inv = 0, .r2 = 0, .exact = false};
+
+bool CoeffModulusSet(unsigned long p) {
+    if (p == 0) {
+        coeff_modulus = (CoeffModulus) {.p = 0, .neg_inv = 0, .r2 = 0,
+                                        .exact = false};
+        return true;
+    }
+    if (p < 3 || p % 2 == 0 || p > COEFF_MOD_MAX)
+        return false;
+
+    // odwrotność modulo 2^64 metodą Newtona
+    unsigned long inv = p;
+    for (int i = 0; i < 6; i++)
+        inv *= 2 - p * inv;
+
+    unsigned long r = -p % p;
+    coeff_modulus = (CoeffModulus) {
+        .p = p, .neg_inv = -inv,
+        .r2 = (unsigned long) ((unsigned __int128) r * r % p)};
+    return true;
+}
+
+void CoeffExactSet(void) {
+    coeff_modulus = (CoeffModulus) {.p = 0, .neg_inv = 0, .r2 = 0,
+                                    .exact = true};
+}
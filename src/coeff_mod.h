@@ -0,0 +1,260 @@
+/** @file
+ * Interfejs modułu odpowiedzialnego za arytmetykę współczynników.
+ * Domyślnie współczynniki są liczbami typu @ref poly_coeff_t, a działania na
+ * nich wykonywane są modulo @f$2^{64}@f$. Po ustawieniu nieparzystego modułu
+ * @f$p@f$ współczynniki są resztami z przedziału @f$[0, p)@f$, a mnożenie
+ * wykonywane jest w arytmetyce Montgomery'ego z @f$R = 2^{64}@f$.
+ * Operacje na wielomianach zakładają, że współczynniki ich argumentów są
+ * resztami modulo bieżący moduł, i zachowują tę własność.
+ * W trybie dokładnym przepełnienie wykrywane jest wbudowanymi funkcjami
+ * kompilatora, a jedynie współczynniki, których wartość nie mieści się
+ * w typie @ref poly_coeff_t, zamieniane są na liczby dowolnej precyzji (zob.
+ * @ref BigInt).
+ *
+ * @author Jan Kwiatkowski
+ */
+
+#ifndef POLYNOMIALS_COEFF_MOD_H
+#define POLYNOMIALS_COEFF_MOD_H
+
+#include "poly.h"
+#include "big_coeff.h"
+#include <limits.h>
+
+/** Największy dopuszczalny moduł. */
+#define COEFF_MOD_MAX 9223372036854775807UL
+
+/**
+ * Stałe arytmetyki modulo @f$p@f$.
+ */
+typedef struct CoeffModulus {
+    unsigned long p; ///< moduł lub 0, gdy obliczenia są modulo @f$2^{64}@f$
+    unsigned long neg_inv; ///< @f$-p^{-1} \bmod 2^{64}@f$
+    unsigned long r2; ///< @f$R^2 \bmod p@f$
+    bool exact; ///< czy działania są dokładne
+} CoeffModulus;
+
+/** Bieżący moduł; należy go zmieniać funkcją @ref CoeffModulusSet. */
+extern CoeffModulus coeff_modulus;
+
+/**
+ * Ustawia moduł, modulo który wykonywane są działania na współczynnikach.
+ * Nie zmienia istniejących wielomianów (zob.
+ * @ref PolyReduceCoeffs(const Poly *p)).
+ * @param[in] p : nieparzysty moduł z przedziału
+ * @f$[3, @ref COEFF_MOD_MAX]@f$ lub 0, co przywraca obliczenia modulo
+ * @f$2^{64}@f$
+ * @return czy moduł jest poprawny; dla niepoprawnego moduł się nie zmienia
+ * (w szczególności nie jest wyłączany tryb dokładny)
+ */
+bool CoeffModulusSet(unsigned long p);
+
+/**
+ * Włącza tryb dokładny, w którym współczynniki są liczbami całkowitymi bez
+ * ograniczenia zakresu. Wyłącza go ustawienie modułu funkcją
+ * @ref CoeffModulusSet(unsigned long p), również modułu 0. Nie zmienia
+ * istniejących wielomianów.
+ */
+void CoeffExactSet(void);
+
+/**
+ * Sprawdza, czy ustawiono moduł.
+ * @return czy działania wykonywane są modulo ustawiony moduł
+ */
+static inline bool CoeffModActive(void) {
+    return coeff_modulus.p != 0;
+}
+
+/**
+ * Sprawdza, czy włączono tryb dokładny.
+ * @return czy działania na współczynnikach są dokładne
+ */
+static inline bool CoeffExactActive(void) {
+    return coeff_modulus.exact;
+}
+
+/**
+ * Redukcja Montgomery'ego.
+ * @param[in] t : liczba mniejsza niż @f$p R@f$
+ * @return @f$t R^{-1} \bmod p@f$
+ */
+static inline unsigned long CoeffRedc(unsigned __int128 t) {
+    unsigned long m = (unsigned long) t * coeff_modulus.neg_inv;
+    unsigned long ret = (unsigned long)
+        ((t + (unsigned __int128) m * coeff_modulus.p) >> 64);
+    return ret >= coeff_modulus.p ? ret - coeff_modulus.p : ret;
+}
+
+/**
+ * Sprowadza dowolną liczbę do reszty modulo bieżący moduł.
+ * @param[in] c : liczba
+ * @return reszta z dzielenia @p c przez moduł
+ */
+static inline poly_coeff_t CoeffReduce(poly_coeff_t c) {
+    if (!CoeffModActive())
+        return c;
+    poly_coeff_t ret = c % (poly_coeff_t) coeff_modulus.p;
+    return ret < 0 ? ret + (poly_coeff_t) coeff_modulus.p : ret;
+}
+
+/**
+ * Dodaje współczynniki.
+ * @param[in] a : reszta
+ * @param[in] b : reszta
+ * @return @f$a + b@f$
+ */
+static inline poly_coeff_t CoeffAdd(poly_coeff_t a, poly_coeff_t b) {
+    unsigned long sum = (unsigned long) a + (unsigned long) b;
+    if (CoeffModActive() && sum >= coeff_modulus.p)
+        sum -= coeff_modulus.p;
+    return (poly_coeff_t) sum;
+}
+
+/**
+ * Zwraca współczynnik przeciwny.
+ * @param[in] a : reszta
+ * @return @f$-a@f$
+ */
+static inline poly_coeff_t CoeffNeg(poly_coeff_t a) {
+    if (CoeffModActive())
+        return a == 0 ? 0
+                      : (poly_coeff_t) (coeff_modulus.p - (unsigned long) a);
+    return (poly_coeff_t) (0 - (unsigned long) a);
+}
+
+/**
+ * Zamienia współczynnik na postać Montgomery'ego, w której jest on
+ * czynnikiem w @ref CoeffMulMont(poly_coeff_t a, poly_coeff_t b_mont).
+ * Bez ustawionego modułu zwraca współczynnik bez zmian.
+ * @param[in] b : reszta
+ * @return @f$b R \bmod p@f$
+ */
+static inline poly_coeff_t CoeffToMont(poly_coeff_t b) {
+    if (!CoeffModActive())
+        return b;
+    return (poly_coeff_t) CoeffRedc((unsigned __int128) (unsigned long) b *
+                                    coeff_modulus.r2);
+}
+
+/**
+ * Mnoży współczynnik przez współczynnik w postaci Montgomery'ego. Pozwala
+ * wielokrotnie mnożyć przez ten sam czynnik kosztem jednej redukcji.
+ * @param[in] a : reszta
+ * @param[in] b_mont : @ref CoeffToMont(poly_coeff_t b) dla reszty @f$b@f$
+ * @return @f$a b@f$
+ */
+static inline poly_coeff_t CoeffMulMont(poly_coeff_t a, poly_coeff_t b_mont) {
+    if (!CoeffModActive())
+        return (poly_coeff_t) ((unsigned long) a * (unsigned long) b_mont);
+    return (poly_coeff_t) CoeffRedc((unsigned __int128) (unsigned long) a *
+                                    (unsigned long) b_mont);
+}
+
+/**
+ * Mnoży współczynniki.
+ * @param[in] a : reszta
+ * @param[in] b : reszta
+ * @return @f$a b@f$
+ */
+static inline poly_coeff_t CoeffMul(poly_coeff_t a, poly_coeff_t b) {
+    return CoeffMulMont(a, CoeffToMont(b));
+}
+
+/**
+ * Dodaje współczynniki będące wielomianami stałymi. W trybie dokładnym
+ * wynik spoza zakresu @ref poly_coeff_t jest liczbą dowolnej precyzji.
+ * @param[in] a : wielomian stały
+ * @param[in] b : wielomian stały
+ * @return @f$a + b@f$
+ */
+static inline Poly CoeffPolyAdd(const Poly *a, const Poly *b) {
+    if (!PolyIsBig(a) && !PolyIsBig(b)) {
+        poly_coeff_t sum;
+        if (!CoeffExactActive())
+            return PolyFromCoeff(CoeffAdd(a->coeff, b->coeff));
+        if (!__builtin_add_overflow(a->coeff, b->coeff, &sum))
+            return PolyFromCoeff(sum);
+    }
+    return BigCoeffAdd(a, b);
+}
+
+/**
+ * Mnoży współczynniki będące wielomianami stałymi. W trybie dokładnym
+ * wynik spoza zakresu @ref poly_coeff_t jest liczbą dowolnej precyzji.
+ * @param[in] a : wielomian stały
+ * @param[in] b : wielomian stały
+ * @return @f$a b@f$
+ */
+static inline Poly CoeffPolyMul(const Poly *a, const Poly *b) {
+    if (!PolyIsBig(a) && !PolyIsBig(b)) {
+        poly_coeff_t product;
+        if (!CoeffExactActive())
+            return PolyFromCoeff(CoeffMul(a->coeff, b->coeff));
+        if (!__builtin_mul_overflow(a->coeff, b->coeff, &product))
+            return PolyFromCoeff(product);
+    }
+    return BigCoeffMul(a, b);
+}
+
+/**
+ * Zwraca współczynnik przeciwny do wielomianu stałego.
+ * @param[in] a : wielomian stały
+ * @return @f$-a@f$
+ */
+static inline Poly CoeffPolyNeg(const Poly *a) {
+    if (PolyIsBig(a) || (CoeffExactActive() && a->coeff == LONG_MIN))
+        return BigCoeffNeg(a);
+    return PolyFromCoeff(CoeffNeg(a->coeff));
+}
+
+/**
+ * Sprawdza równość współczynników będących wielomianami stałymi.
+ * @param[in] a : wielomian stały
+ * @param[in] b : wielomian stały
+ * @return @f$a = b@f$
+ */
+static inline bool CoeffPolyEq(const Poly *a, const Poly *b) {
+    if (!PolyIsBig(a) && !PolyIsBig(b))
+        return a->coeff == b->coeff;
+    return PolyIsBig(a) && PolyIsBig(b) && BigCoeffEq(a, b);
+}
+
+/**
+ * Sprawdza, czy wielomian stały jest równy 1.
+ * @param[in] a : wielomian stały
+ * @return @f$a = 1@f$
+ */
+static inline bool CoeffPolyIsOne(const Poly *a) {
+    return !PolyIsBig(a) && a->coeff == 1;
+}
+
+/**
+ * Zwraca wartość współczynnika modulo @f$2^{64}@f$, czyli taką, jaką miałby
+ * on w obliczeniach bez trybu dokładnego.
+ * @param[in] a : wielomian stały
+ * @return współczynnik typu @ref poly_coeff_t
+ */
+static inline poly_coeff_t CoeffPolyLow(const Poly *a) {
+    return PolyIsBig(a) ? BigCoeffLow(a) : a->coeff;
+}
+
+/**
+ * Sprowadza współczynnik do postaci zgodnej z bieżącym trybem: do reszty
+ * modulo bieżący moduł, a bez modułu i poza trybem dokładnym do wartości
+ * modulo @f$2^{64}@f$.
+ * @param[in] a : wielomian stały
+ * @return wielomian stały
+ */
+static inline Poly CoeffPolyReduce(const Poly *a) {
+    if (!PolyIsBig(a))
+        return PolyFromCoeff(CoeffReduce(a->coeff));
+    if (CoeffModActive())
+        return PolyFromCoeff(BigCoeffMod(a, coeff_modulus.p));
+    if (CoeffExactActive()) {
+        BigRetain(a->big);
+        return *a;
+    }
+    return PolyFromCoeff(BigCoeffLow(a));
+}
+
+#endif //POLYNOMIALS_COEFF_MOD_H
@@ -0,0 +1,130 @@
+/** @file
+ * Implementacja modułu odpowiedzialnego za kolejkę wierszy przekazywanych
+ * z wątku wczytującego wejście do wątku wykonującego komendy.
+ * Strona zasypiająca ustawia swój znacznik oczekiwania, a następnie
+ * sprawdza licznik drugiej strony, która z kolei zmienia licznik, a potem
+ * sprawdza znacznik. Operacje te są sekwencyjnie spójne, więc co najmniej
+ * jedna ze stron zauważy zmianę drugiej i budzenie nie zostanie zgubione.
+ *
+ * @author Jan Kwiatkowski
+ */
+
+#include "line_queue.h"
+#include "utilities.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+
+/** Liczba sprawdzeń licznika drugiej strony przed zaśnięciem. */
+#define LINE_QUEUE_SPINS 1024
+
+/** Rozmiar linii pamięci podręcznej, na których leżą liczniki. */
+#define CACHE_LINE_SIZE 64
+
+/**
+ * Kolejka wierszy.
+ */
+struct LineQueue {
+    ParsedLine lines[LINE_QUEUE_SIZE]; ///< bufor cykliczny wierszy
+    /** odstęp oddzielający liczniki od wierszy */
+    char pad_lines[CACHE_LINE_SIZE];
+    atomic_size_t head; ///< liczba przekazanych wierszy
+    /** odstęp oddzielający liczniki obu stron */
+    char pad_head[CACHE_LINE_SIZE - sizeof(atomic_size_t)];
+    atomic_size_t tail; ///< liczba wykonanych wierszy
+    /** odstęp oddzielający licznik od danych do zasypiania */
+    char pad_tail[CACHE_LINE_SIZE - sizeof(atomic_size_t)];
+    atomic_bool producer_waiting; ///< czy producent śpi lub zasypia
+    atomic_bool consumer_waiting; ///< czy konsument śpi lub zasypia
+    pthread_mutex_t lock; ///< muteks zmiennych warunkowych
+    pthread_cond_t producer_wake; ///< zmienna warunkowa producenta
+    pthread_cond_t consumer_wake; ///< zmienna warunkowa konsumenta
+};
+
+LineQueue* LineQueueCreate(void) {
+    LineQueue *queue = SafeMalloc(sizeof(LineQueue));
+    atomic_init(&queue->head, 0);
+    atomic_init(&queue->tail, 0);
+    atomic_init(&queue->producer_waiting, false);
+    atomic_init(&queue->consumer_waiting, false);
+    pthread_mutex_init(&queue->lock, NULL);
+    pthread_cond_init(&queue->producer_wake, NULL);
+    pthread_cond_init(&queue->consumer_wake, NULL);
+    return queue;
+}
+
+void LineQueueDestroy(LineQueue *queue) {
+    pthread_mutex_destroy(&queue->lock);
+    pthread_cond_destroy(&queue->producer_wake);
+    pthread_cond_destroy(&queue->consumer_wake);
+    free(queue);
+}
+
+/**
+ * Czeka, aż konsument wykona wiersze, tak by przekazanych i niewykonanych
+ * pozostało co najwyżej @p pending.
+ * @param[in,out] queue : kolejka
+ * @param[in] pending : dopuszczalna liczba niewykonanych wierszy
+ */
+static void WaitForConsumer(LineQueue *queue, size_t pending) {
+    size_t head = atomic_load_explicit(&queue->head, memory_order_relaxed);
+    for (size_t i = 0; i < LINE_QUEUE_SPINS; i++) {
+        if (head - atomic_load_explicit(&queue->tail,
+                                        memory_order_acquire) <= pending)
+            return;
+    }
+
+    pthread_mutex_lock(&queue->lock);
+    atomic_store(&queue->producer_waiting, true);
+    while (head - atomic_load(&queue->tail) > pending)
+        pthread_cond_wait(&queue->producer_wake, &queue->lock);
+    atomic_store(&queue->producer_waiting, false);
+    pthread_mutex_unlock(&queue->lock);
+}
+
+ParsedLine* LineQueueReserve(LineQueue *queue) {
+    WaitForConsumer(queue, LINE_QUEUE_SIZE - 1);
+    size_t head = atomic_load_explicit(&queue->head, memory_order_relaxed);
+    return &queue->lines[head & (LINE_QUEUE_SIZE - 1)];
+}
+
+void LineQueuePush(LineQueue *queue) {
+    size_t head = atomic_load_explicit(&queue->head, memory_order_relaxed);
+    atomic_store(&queue->head, head + 1);
+    if (atomic_load(&queue->consumer_waiting)) {
+        pthread_mutex_lock(&queue->lock);
+        pthread_cond_signal(&queue->consumer_wake);
+        pthread_mutex_unlock(&queue->lock);
+    }
+}
+
+void LineQueueDrain(LineQueue *queue) {
+    WaitForConsumer(queue, 0);
+}
+
+ParsedLine* LineQueueFront(LineQueue *queue) {
+    size_t tail = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+    ParsedLine *line = &queue->lines[tail & (LINE_QUEUE_SIZE - 1)];
+    for (size_t i = 0; i < LINE_QUEUE_SPINS; i++) {
+        if (atomic_load_explicit(&queue->head, memory_order_acquire) != tail)
+            return line;
+    }
+
+    pthread_mutex_lock(&queue->lock);
+    atomic_store(&queue->consumer_waiting, true);
+    while (atomic_load(&queue->head) == tail)
+        pthread_cond_wait(&queue->consumer_wake, &queue->lock);
+    atomic_store(&queue->consumer_waiting, false);
+    pthread_mutex_unlock(&queue->lock);
+    return line;
+}
+
+void LineQueuePop(LineQueue *queue) {
+    size_t tail = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+    atomic_store(&queue->tail, tail + 1);
+    if (atomic_load(&queue->producer_waiting)) {
+        pthread_mutex_lock(&queue->lock);
+        pthread_cond_signal(&queue->producer_wake);
+        pthread_mutex_unlock(&queue->lock);
+    }
+}
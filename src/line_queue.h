@@ -0,0 +1,77 @@
+/** @file
+ * Interfejs modułu odpowiedzialnego za kolejkę wierszy przekazywanych
+ * z wątku wczytującego wejście do wątku wykonującego komendy.
+ * Kolejka jest buforem cyklicznym o stałej pojemności
+ * @ref LINE_QUEUE_SIZE dla jednego producenta i jednego konsumenta. Wiersze
+ * przekazywane są bez blokad: każda strona zmienia tylko swój licznik
+ * wierszy. Strona, która musi czekać, najpierw krótko sprawdza licznik
+ * drugiej strony w pętli, a dopiero potem zasypia na zmiennej warunkowej.
+ * Konsument wykonuje wiersz wprost w buforze i zwalnia miejsce dopiero po
+ * wykonaniu, więc producent może poczekać, aż wszystkie przekazane wiersze
+ * zostaną wykonane.
+ *
+ * @author Jan Kwiatkowski
+ */
+
+#ifndef POLYNOMIALS_LINE_QUEUE_H
+#define POLYNOMIALS_LINE_QUEUE_H
+
+#include "process_line.h"
+
+/** Pojemność kolejki; potęga dwójki. */
+#define LINE_QUEUE_SIZE 1024
+
+/** Typ kolejki wierszy. */
+typedef struct LineQueue LineQueue;
+
+/**
+ * Tworzy pustą kolejkę.
+ * @return kolejka
+ */
+LineQueue* LineQueueCreate(void);
+
+/**
+ * Usuwa kolejkę z pamięci. Żaden wątek nie może już z niej korzystać.
+ * @param[in] queue : kolejka
+ */
+void LineQueueDestroy(LineQueue *queue);
+
+/**
+ * Zwraca miejsce na kolejny wiersz, czekając, aż się zwolni. Wywołuje ją
+ * tylko producent.
+ * @param[in,out] queue : kolejka
+ * @return miejsce na wiersz, które należy wypełnić i przekazać funkcją
+ * @ref LineQueuePush
+ */
+ParsedLine* LineQueueReserve(LineQueue *queue);
+
+/**
+ * Przekazuje konsumentowi wiersz wypełniony po wywołaniu
+ * @ref LineQueueReserve. Wywołuje ją tylko producent.
+ * @param[in,out] queue : kolejka
+ */
+void LineQueuePush(LineQueue *queue);
+
+/**
+ * Czeka, aż konsument wykona wszystkie przekazane wiersze. Wywołuje ją
+ * tylko producent.
+ * @param[in,out] queue : kolejka
+ */
+void LineQueueDrain(LineQueue *queue);
+
+/**
+ * Zwraca najstarszy niewykonany wiersz, czekając, aż się pojawi. Wywołuje
+ * ją tylko konsument.
+ * @param[in,out] queue : kolejka
+ * @return wiersz, który pozostaje w kolejce do wywołania @ref LineQueuePop
+ */
+ParsedLine* LineQueueFront(LineQueue *queue);
+
+/**
+ * Zwalnia miejsce wykonanego wiersza zwróconego przez @ref LineQueueFront.
+ * Wywołuje ją tylko konsument.
+ * @param[in,out] queue : kolejka
+ */
+void LineQueuePop(LineQueue *queue);
+
+#endif //POLYNOMIALS_LINE_QUEUE_H
@@ -0,0 +1,401 @@
+/** @file
+ * Implementacja modułu odpowiedzialnego za przydział pamięci na tablice
+ * jednomianów.
+ * Przed każdą tablicą znajduje się nagłówek z jej pojemnością, klasą
+ * rozmiaru, licznikiem odwołań oraz skrótem i opisem wielomianu. Wolna
+ * tablica przechowuje na swoim miejscu wskaźnik na następną wolną tablicę
+ * tej samej klasy.
+ *
+ * @author Jan Kwiatkowski
+ */
+
+#include "mono_pool.h"
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <stdatomic.h>
+#include <stdint.h>
+
+/** Klasa rozmiaru tablic przydzielanych bezpośrednio funkcją malloc(). */
+#define MONO_POOL_LARGE MONO_POOL_CLASSES
+
+/** Pojemność tablic największej klasy rozmiaru obsługiwanej przez pulę. */
+#define MONO_POOL_MAX_CAPACITY ((size_t) 1 << (MONO_POOL_CLASSES - 1))
+
+/** Przybliżony rozmiar jednego slabu w bajtach. */
+#define MONO_POOL_SLAB_SIZE ((size_t) 1 << 16)
+
+/**
+ * Liczba wolnych tablic jednej klasy w pamięci podręcznej wątku, po której
+ * przekroczeniu ich część oddawana jest do puli wspólnej.
+ */
+#define MONO_POOL_CACHE_LIMIT 128
+
+/** Liczba tablic przenoszonych naraz między wątkiem a pulą wspólną. */
+#define MONO_POOL_BATCH 64
+
+/** Licznik odwołań tablicy, która nie należy do puli i nie jest zwalniana. */
+#define MONO_ARRAY_IMMORTAL SIZE_MAX
+
+/**
+ * Nagłówek tablicy jednomianów.
+ */
+typedef struct MonoArrayHeader {
+    size_t capacity; ///< liczba jednomianów mieszczących się w tablicy
+    size_t size_class; ///< klasa rozmiaru tablicy
+    atomic_size_t refcount; ///< liczba wielomianów korzystających z tablicy
+    atomic_uint_least64_t hash; ///< skrót wielomianu lub 0
+    _Atomic(PolyMeta *) meta; ///< opis wielomianu lub NULL
+} MonoArrayHeader;
+
+/**
+ * Wolna tablica na liście wolnych tablic.
+ */
+typedef struct FreeBlock {
+    struct FreeBlock *next; ///< następna wolna tablica lub NULL
+} FreeBlock;
+
+/**
+ * Lista wolnych tablic jednej klasy rozmiaru.
+ */
+typedef struct FreeList {
+    FreeBlock *head; ///< pierwsza wolna tablica lub NULL
+    size_t count; ///< liczba tablic na liście
+} FreeList;
+
+/**
+ * Slab, z którego wydzielane są tablice. Tablice leżą bezpośrednio za
+ * strukturą.
+ */
+typedef struct Slab {
+    struct Slab *next; ///< następny slab lub NULL
+} Slab;
+
+#ifndef POLY_USE_MALLOC
+/** Podręczne listy wolnych tablic wątku. */
+static _Thread_local FreeList thread_cache[MONO_POOL_CLASSES];
+
+/** Wspólne listy wolnych tablic. */
+static FreeList shared_pool[MONO_POOL_CLASSES];
+
+/** Lista wszystkich przydzielonych slabów. */
+static Slab *slabs = NULL;
+
+/** Blokada chroniąca @ref shared_pool i @ref slabs. */
+static atomic_flag pool_lock = ATOMIC_FLAG_INIT;
+#endif
+
+/**
+ * Zwraca nagłówek tablicy jednomianów.
+ * @param[in] arr : tablica
+ * @return nagłówek
+ */
+static MonoArrayHeader* HeaderOf(const Mono *arr) {
+    return (MonoArrayHeader *) arr - 1;
+}
+
+/**
+ * Wypełnia nagłówek i zwraca wskaźnik na tablicę leżącą za nim.
+ * @param[in,out] header : nagłówek
+ * @param[in] capacity : pojemność tablicy
+ * @param[in] size_class : klasa rozmiaru tablicy
+ * @return tablica
+ */
+static Mono* ArrayOf(MonoArrayHeader *header, size_t capacity,
+                     size_t size_class) {
+    header->capacity = capacity;
+    header->size_class = size_class;
+    atomic_init(&header->refcount, 1);
+    atomic_init(&header->hash, 0);
+    atomic_init(&header->meta, NULL);
+    return (Mono *) (header + 1);
+}
+
+/**
+ * Zwalnia opis wielomianu zapamiętany w nagłówku tablicy.
+ * @param[in,out] header : nagłówek tablicy, która nie jest współdzielona
+ */
+static void DropMeta(MonoArrayHeader *header) {
+    PolyMeta *meta = atomic_exchange_explicit(&header->meta, NULL,
+                                              memory_order_acquire);
+    free(meta);
+}
+
+/**
+ * Przydziela tablicę funkcją malloc().
+ * @param[in] n : pojemność tablicy
+ * @return tablica
+ */
+static Mono* LargeAlloc(size_t n) {
+    MonoArrayHeader *header =
+        malloc(sizeof(MonoArrayHeader) + n * sizeof(Mono));
+    if (!header)
+        exit(1);
+    return ArrayOf(header, n, MONO_POOL_LARGE);
+}
+
+#ifndef POLY_USE_MALLOC
+/**
+ * Wyznacza najmniejszą klasę rozmiaru mieszczącą @p n jednomianów.
+ * @param[in] n : liczba jednomianów
+ * @return klasa rozmiaru lub @ref MONO_POOL_LARGE
+ */
+static size_t SizeClass(size_t n) {
+    size_t size_class = 0;
+    while (size_class < MONO_POOL_CLASSES &&
+           ((size_t) 1 << size_class) < n)
+        size_class++;
+    return size_class;
+}
+
+/**
+ * Zwraca rozmiar w bajtach bloku zajmowanego przez tablicę danej klasy wraz
+ * z nagłówkiem.
+ * @param[in] size_class : klasa rozmiaru
+ * @return rozmiar bloku
+ */
+static size_t BlockSize(size_t size_class) {
+    return sizeof(MonoArrayHeader) + ((size_t) 1 << size_class) * sizeof(Mono);
+}
+
+/** Zajmuje blokadę puli wspólnej. */
+static void PoolLock(void) {
+    while (atomic_flag_test_and_set_explicit(&pool_lock, memory_order_acquire))
+        ;
+}
+
+/** Zwalnia blokadę puli wspólnej. */
+static void PoolUnlock(void) {
+    atomic_flag_clear_explicit(&pool_lock, memory_order_release);
+}
+
+/**
+ * Przenosi co najwyżej @p count tablic z początku listy @p from na początek
+ * listy @p to.
+ * @param[in,out] from : lista źródłowa
+ * @param[in,out] to : lista docelowa
+ * @param[in] count : liczba przenoszonych tablic
+ */
+static void MoveBlocks(FreeList *from, FreeList *to, size_t count) {
+    if (count > from->count)
+        count = from->count;
+    if (count == 0)
+        return;
+
+    FreeBlock *first = from->head, *last = first;
+    for (size_t i = 1; i < count; i++)
+        last = last->next;
+
+    from->head = last->next;
+    from->count -= count;
+    last->next = to->head;
+    to->head = first;
+    to->count += count;
+}
+
+/**
+ * Uzupełnia podręczną listę wątku o partię wolnych tablic danej klasy,
+ * pobierając je z puli wspólnej lub dzieląc nowy slab.
+ * @param[in] size_class : klasa rozmiaru
+ */
+static void Refill(size_t size_class) {
+    FreeList *cache = &thread_cache[size_class];
+
+    PoolLock();
+    MoveBlocks(&shared_pool[size_class], cache, MONO_POOL_BATCH);
+    if (cache->count > 0) {
+        PoolUnlock();
+        return;
+    }
+
+    size_t block_size = BlockSize(size_class);
+    size_t blocks = MONO_POOL_SLAB_SIZE / block_size;
+    if (blocks == 0)
+        blocks = 1;
+
+    Slab *slab = malloc(sizeof(Slab) + blocks * block_size);
+    if (!slab)
+        exit(1);
+    slab->next = slabs;
+    slabs = slab;
+    PoolUnlock();
+
+    char *block = (char *) (slab + 1);
+    for (size_t i = 0; i < blocks; i++, block += block_size) {
+        FreeBlock *free_block = (FreeBlock *) ArrayOf(
+            (MonoArrayHeader *) block, (size_t) 1 << size_class, size_class);
+        free_block->next = cache->head;
+        cache->head = free_block;
+    }
+    cache->count += blocks;
+}
+#endif
+
+Mono* MonoArrayAlloc(size_t n) {
+    assert(n > 0);
+
+#ifdef POLY_USE_MALLOC
+    return LargeAlloc(n);
+#else
+    size_t size_class = SizeClass(n);
+    if (size_class == MONO_POOL_LARGE)
+        return LargeAlloc(n);
+
+    FreeList *cache = &thread_cache[size_class];
+    if (cache->count == 0)
+        Refill(size_class);
+
+    FreeBlock *block = cache->head;
+    cache->head = block->next;
+    cache->count--;
+    atomic_store_explicit(&HeaderOf((Mono *) block)->refcount, 1,
+                          memory_order_relaxed);
+    atomic_store_explicit(&HeaderOf((Mono *) block)->hash, 0,
+                          memory_order_relaxed);
+    atomic_store_explicit(&HeaderOf((Mono *) block)->meta, NULL,
+                          memory_order_relaxed);
+    return (Mono *) block;
+#endif
+}
+
+Mono* MonoArrayRealloc(Mono *arr, size_t n) {
+    assert(n > 0);
+
+    MonoArrayHeader *header = HeaderOf(arr);
+    assert(header->refcount == 1);
+    size_t capacity = header->capacity;
+    // tablica zostaje na miejscu, jeśli nie marnuje więcej niż połowy pamięci
+    if (n <= capacity && 2 * n > capacity)
+        return arr;
+
+#ifndef POLY_USE_MALLOC
+    if (header->size_class != MONO_POOL_LARGE || n <= MONO_POOL_MAX_CAPACITY) {
+        Mono *ret = MonoArrayAlloc(n);
+        memcpy(ret, arr, (n < capacity ? n : capacity) * sizeof(Mono));
+        MonoArrayFree(arr);
+        return ret;
+    }
+#endif
+
+    DropMeta(header);
+    header = realloc(header, sizeof(MonoArrayHeader) + n * sizeof(Mono));
+    if (!header)
+        exit(1);
+    return ArrayOf(header, n, MONO_POOL_LARGE);
+}
+
+void MonoArrayFree(Mono *arr) {
+    if (arr == NULL)
+        return;
+
+    MonoArrayHeader *header = HeaderOf(arr);
+    DropMeta(header);
+#ifndef POLY_USE_MALLOC
+    if (header->size_class != MONO_POOL_LARGE) {
+        FreeList *cache = &thread_cache[header->size_class];
+        FreeBlock *block = (FreeBlock *) arr;
+        block->next = cache->head;
+        cache->head = block;
+        cache->count++;
+
+        if (cache->count > MONO_POOL_CACHE_LIMIT) {
+            PoolLock();
+            MoveBlocks(cache, &shared_pool[header->size_class],
+                       MONO_POOL_BATCH);
+            PoolUnlock();
+        }
+        return;
+    }
+#endif
+    free(header);
+}
+
+void MonoArrayRetain(Mono *arr) {
+    // nagłówek tablicy nieśmiertelnej może leżeć w pamięci tylko do odczytu
+    MonoArrayHeader *header = HeaderOf(arr);
+    if (atomic_load_explicit(&header->refcount, memory_order_relaxed) ==
+        MONO_ARRAY_IMMORTAL)
+        return;
+    atomic_fetch_add_explicit(&header->refcount, 1, memory_order_relaxed);
+}
+
+bool MonoArrayUnref(Mono *arr) {
+    MonoArrayHeader *header = HeaderOf(arr);
+    if (atomic_load_explicit(&header->refcount, memory_order_relaxed) ==
+        MONO_ARRAY_IMMORTAL)
+        return false;
+    size_t prev = atomic_fetch_sub_explicit(&header->refcount, 1,
+                                            memory_order_acq_rel);
+    assert(prev > 0);
+    return prev == 1;
+}
+
+bool MonoArrayIsShared(const Mono *arr) {
+    return atomic_load_explicit(&HeaderOf(arr)->refcount,
+                                memory_order_acquire) > 1;
+}
+
+size_t MonoArrayCapacity(const Mono *arr) {
+    return HeaderOf(arr)->capacity;
+}
+
+uint64_t MonoArrayGetHash(const Mono *arr) {
+    return atomic_load_explicit(&HeaderOf(arr)->hash, memory_order_relaxed);
+}
+
+void MonoArraySetHash(Mono *arr, uint64_t hash) {
+    atomic_store_explicit(&HeaderOf(arr)->hash, hash, memory_order_relaxed);
+}
+
+const PolyMeta* MonoArrayGetMeta(const Mono *arr) {
+    return atomic_load_explicit(&HeaderOf(arr)->meta, memory_order_acquire);
+}
+
+const PolyMeta* MonoArraySetMeta(Mono *arr, PolyMeta *meta) {
+    PolyMeta *expected = NULL;
+    if (atomic_compare_exchange_strong_explicit(&HeaderOf(arr)->meta,
+                                                &expected, meta,
+                                                memory_order_acq_rel,
+                                                memory_order_acquire))
+        return meta;
+
+    free(meta);
+    return expected;
+}
+
+void MonoArrayInvalidate(Mono *arr) {
+    MonoArrayHeader *header = HeaderOf(arr);
+    atomic_store_explicit(&header->hash, 0, memory_order_relaxed);
+    DropMeta(header);
+}
+
+size_t MonoArrayHeaderSize(void) {
+    return sizeof(MonoArrayHeader);
+}
+
+Mono* MonoArrayInitImmortal(void *header, size_t n, uint64_t hash,
+                            const PolyMeta *meta) {
+    assert(hash != 0 && meta != NULL);
+    MonoArrayHeader *array_header = header;
+    Mono *arr = ArrayOf(array_header, n, MONO_POOL_LARGE);
+    atomic_init(&array_header->refcount, MONO_ARRAY_IMMORTAL);
+    atomic_init(&array_header->hash, hash);
+    atomic_init(&array_header->meta, (PolyMeta *) meta);
+    return arr;
+}
+
+void MonoPoolRelease(void) {
+#ifndef POLY_USE_MALLOC
+    PoolLock();
+    while (slabs != NULL) {
+        Slab *next = slabs->next;
+        free(slabs);
+        slabs = next;
+    }
+    for (size_t i = 0; i < MONO_POOL_CLASSES; i++) {
+        shared_pool[i] = (FreeList) {.head = NULL, .count = 0};
+        thread_cache[i] = (FreeList) {.head = NULL, .count = 0};
+    }
+    PoolUnlock();
+#endif
+}
@@ -0,0 +1,162 @@
+/** @file
+ * Interfejs modułu odpowiedzialnego za przydział pamięci na tablice
+ * jednomianów.
+ * Tablice o pojemności będącej potęgą dwójki, nie większej niż
+ * @f$2^{@ref MONO_POOL_CLASSES - 1}@f$, wydzielane są z większych bloków
+ * pamięci (slabów) i po zwolnieniu trafiają na listę wolnych tablic swojej
+ * klasy rozmiaru, skąd są ponownie wydawane. Każdy wątek ma własną podręczną
+ * listę wolnych tablic, a jej nadmiar przekazywany jest partiami do puli
+ * wspólnej. Większe tablice przydzielane są funkcją malloc().
+ * Jeśli projekt skompilowano z opcją `POLY_USE_MALLOC`, wszystkie tablice
+ * przydzielane są funkcją malloc().
+ * Każda tablica ma licznik odwołań, dzięki któremu wielomiany mogą
+ * współdzielić niezmienne poddrzewa. Licznik jest atomowy, więc wielomiany
+ * współdzielące tablice mogą być używane przez różne wątki.
+ * Tablica przechowuje też skrót (zob. @ref PolyHash(const Poly *p)) i opis
+ * (zob. @ref PolyMeta) wielomianu, którego jest listą jednomianów,
+ * wyznaczane przy pierwszym użyciu.
+ *
+ * @author Jan Kwiatkowski
+ */
+
+#ifndef POLYNOMIALS_MONO_POOL_H
+#define POLYNOMIALS_MONO_POOL_H
+
+#include "poly.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/** Liczba klas rozmiaru tablic jednomianów obsługiwanych przez pulę. */
+#define MONO_POOL_CLASSES 11
+
+/**
+ * Przydziela tablicę jednomianów z licznikiem odwołań równym 1. Zawartość
+ * tablicy jest nieokreślona.
+ * W przypadku braku pamięci kończy program z kodem 1.
+ * @param[in] n : minimalna liczba jednomianów w tablicy, dodatnia
+ * @return wskaźnik na początek tablicy
+ */
+Mono* MonoArrayAlloc(size_t n);
+
+/**
+ * Zmienia pojemność tablicy jednomianów, zachowując jej początkowe
+ * jednomiany.
+ * @param[in] arr : tablica przydzielona przez @ref MonoArrayAlloc(size_t n),
+ * która nie jest współdzielona
+ * @param[in] n : minimalna liczba jednomianów w tablicy, dodatnia
+ * @return wskaźnik na początek tablicy, która może być inna niż @p arr
+ */
+Mono* MonoArrayRealloc(Mono *arr, size_t n);
+
+/**
+ * Zwalnia tablicę jednomianów niezależnie od jej licznika odwołań. Nie usuwa
+ * jednomianów z tablicy.
+ * @param[in] arr : tablica przydzielona przez @ref MonoArrayAlloc(size_t n)
+ * lub NULL
+ */
+void MonoArrayFree(Mono *arr);
+
+/**
+ * Zwiększa licznik odwołań do tablicy jednomianów.
+ * @param[in] arr : tablica
+ */
+void MonoArrayRetain(Mono *arr);
+
+/**
+ * Zmniejsza licznik odwołań do tablicy jednomianów.
+ * @param[in] arr : tablica
+ * @return czy było to ostatnie odwołanie; wtedy wywołujący powinien usunąć
+ * jednomiany z tablicy i ją zwolnić
+ */
+bool MonoArrayUnref(Mono *arr);
+
+/**
+ * Sprawdza, czy tablica jednomianów jest współdzielona przez kilka
+ * wielomianów.
+ * @param[in] arr : tablica
+ * @return czy licznik odwołań jest większy niż 1
+ */
+bool MonoArrayIsShared(const Mono *arr);
+
+/**
+ * Zwraca pojemność tablicy jednomianów.
+ * @param[in] arr : tablica przydzielona przez @ref MonoArrayAlloc(size_t n)
+ * @return liczba jednomianów, które mieszczą się w tablicy
+ */
+size_t MonoArrayCapacity(const Mono *arr);
+
+/**
+ * Zwraca zapamiętany skrót wielomianu, którego listą jednomianów jest
+ * tablica.
+ * @param[in] arr : tablica przydzielona przez @ref MonoArrayAlloc(size_t n)
+ * @return skrót lub 0, jeśli nie został jeszcze wyznaczony
+ */
+uint64_t MonoArrayGetHash(const Mono *arr);
+
+/**
+ * Zapamiętuje skrót wielomianu, którego listą jednomianów jest tablica.
+ * @param[in,out] arr : tablica przydzielona przez
+ * @ref MonoArrayAlloc(size_t n)
+ * @param[in] hash : skrót, niezerowy
+ */
+void MonoArraySetHash(Mono *arr, uint64_t hash);
+
+/**
+ * Zwraca zapamiętany opis wielomianu, którego listą jednomianów jest
+ * tablica.
+ * @param[in] arr : tablica przydzielona przez @ref MonoArrayAlloc(size_t n)
+ * @return opis lub NULL, jeśli nie został jeszcze wyznaczony
+ */
+const PolyMeta* MonoArrayGetMeta(const Mono *arr);
+
+/**
+ * Zapamiętuje opis wielomianu, którego listą jednomianów jest tablica,
+ * o ile tablica nie ma już opisu (np. wyznaczonego równocześnie przez inny
+ * wątek). Przejmuje @p meta na własność.
+ * @param[in,out] arr : tablica przydzielona przez
+ * @ref MonoArrayAlloc(size_t n)
+ * @param[in] meta : opis przydzielony funkcją malloc()
+ * @return opis zapamiętany w tablicy
+ */
+const PolyMeta* MonoArraySetMeta(Mono *arr, PolyMeta *meta);
+
+/**
+ * Usuwa zapamiętany skrót i opis wielomianu. Należy ją wywołać przed zmianą
+ * jednomianów tablicy, która nie jest współdzielona. Nowo przydzielona
+ * tablica nie ma skrótu ani opisu.
+ * @param[in,out] arr : tablica przydzielona przez
+ * @ref MonoArrayAlloc(size_t n)
+ */
+void MonoArrayInvalidate(Mono *arr);
+
+/**
+ * Zwraca rozmiar nagłówka, który poprzedza każdą tablicę jednomianów.
+ * @return rozmiar nagłówka w bajtach
+ */
+size_t MonoArrayHeaderSize(void);
+
+/**
+ * Tworzy nagłówek tablicy jednomianów, która nie należy do puli, np. leży
+ * w odwzorowanym w pamięci pliku (zob. @ref PolyImageLoad). Taka tablica
+ * jest zawsze traktowana jako współdzielona, więc jej jednomiany nie są
+ * zmieniane w miejscu, a licznik odwołań, skrót i opis nie są nigdy
+ * zapisywane. Tablica nie jest zwalniana.
+ * @param[out] header : miejsce na nagłówek o rozmiarze
+ * @ref MonoArrayHeaderSize(void), za którym leżą jednomiany
+ * @param[in] n : liczba jednomianów w tablicy
+ * @param[in] hash : skrót wielomianu, niezerowy
+ * @param[in] meta : opis wielomianu
+ * @return wskaźnik na początek tablicy
+ */
+Mono* MonoArrayInitImmortal(void *header, size_t n, uint64_t hash,
+                            const PolyMeta *meta);
+
+/**
+ * Zwalnia naraz całą pamięć zajmowaną przez pulę.
+ * Można ją wywołać tylko wtedy, gdy nie istnieje żadna tablica przydzielona
+ * z puli, a pozostałe wątki z niej nie korzystają, np. przy kończeniu
+ * programu.
+ */
+void MonoPoolRelease(void);
+
+#endif //POLYNOMIALS_MONO_POOL_H
@@ -0,0 +1,118 @@
+/** @file
+ * Implementacja modułu odpowiedzialnego za buforowane wypisywanie na
+ * standardowe wyjście.
+ *
+ * @author Jan Kwiatkowski
+ */
+
+#include "output.h"
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+
+/** Największa liczba cyfr dziesiętnych liczby typu `uint64_t`. */
+#define OUTPUT_MAX_DIGITS 20
+
+OutputBuffer output_buffer;
+
+/** Zapisy dziesiętne liczb od 0 do 99, każdy na dwóch znakach. */
+static const char DIGIT_PAIRS[] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+/** Cyfry szesnastkowe. */
+static const char HEX_DIGITS[] = "0123456789abcdef";
+
+/** Czy standardowe wyjście jest terminalem; -1, jeśli nie sprawdzono. */
+static int output_is_terminal = -1;
+
+void OutputFlush(void) {
+    int saved_errno = errno;
+    const char *data = output_buffer.data;
+    size_t size = output_buffer.size;
+    while (size > 0) {
+        ssize_t written = write(STDOUT_FILENO, data, size);
+        if (written < 0) {
+            if (errno == EINTR)
+                continue;
+            // tak jak printf() pomijamy błąd i porzucamy wypisywane znaki
+            break;
+        }
+        data += written;
+        size -= (size_t) written;
+    }
+    output_buffer.size = 0;
+    // kalkulator rozpoznaje błędy wczytywania po zmiennej errno
+    errno = saved_errno;
+}
+
+/**
+ * Dopisuje do bufora ciąg znaków.
+ * @param[in] data : znaki
+ * @param[in] size : liczba znaków, nie większa niż @ref OUTPUT_BUFFER_SIZE
+ */
+static void OutputBytes(const char *data, size_t size) {
+    if (OUTPUT_BUFFER_SIZE - output_buffer.size < size)
+        OutputFlush();
+    memcpy(output_buffer.data + output_buffer.size, data, size);
+    output_buffer.size += size;
+}
+
+void OutputString(const char *s) {
+    for (; *s != '\0'; s++)
+        OutputChar(*s);
+}
+
+void OutputUnsigned(uint64_t value, size_t width) {
+    char digits[OUTPUT_MAX_DIGITS];
+    char *begin = digits + OUTPUT_MAX_DIGITS;
+
+    // cyfry wyznaczane są od najmniej znaczących, po dwie naraz
+    while (value >= 100) {
+        unsigned pair = (unsigned) (value % 100);
+        value /= 100;
+        begin -= 2;
+        memcpy(begin, &DIGIT_PAIRS[2 * pair], 2);
+    }
+    if (value >= 10) {
+        begin -= 2;
+        memcpy(begin, &DIGIT_PAIRS[2 * value], 2);
+    } else {
+        *--begin = (char) ('0' + value);
+    }
+
+    if (width > OUTPUT_MAX_DIGITS)
+        width = OUTPUT_MAX_DIGITS;
+    while ((size_t) (digits + OUTPUT_MAX_DIGITS - begin) < width)
+        *--begin = '0';
+
+    OutputBytes(begin, (size_t) (digits + OUTPUT_MAX_DIGITS - begin));
+}
+
+void OutputHex64(uint64_t value) {
+    char digits[16];
+    for (int i = 15; i >= 0; i--) {
+        digits[i] = HEX_DIGITS[value & 15];
+        value >>= 4;
+    }
+    OutputBytes(digits, sizeof(digits));
+}
+
+void OutputEndLine(void) {
+    OutputChar('\n');
+    if (output_is_terminal < 0) {
+        int saved_errno = errno;
+        output_is_terminal = isatty(STDOUT_FILENO);
+        errno = saved_errno;
+    }
+    if (output_is_terminal)
+        OutputFlush();
+}
@@ -0,0 +1,92 @@
+/** @file
+ * Interfejs modułu odpowiedzialnego za buforowane wypisywanie na standardowe
+ * wyjście.
+ * Znaki trafiają do jednego bufora o rozmiarze @ref OUTPUT_BUFFER_SIZE,
+ * który jest opróżniany funkcją write() dopiero po zapełnieniu, więc nawet
+ * bardzo duży wielomian wypisywany jest na bieżąco, dużymi porcjami i bez
+ * przydzielania pamięci. Liczby zamieniane są na napisy bez użycia printf().
+ * Jeśli standardowe wyjście jest terminalem, bufor opróżniany jest również
+ * na końcu każdego wiersza.
+ * Z bufora może korzystać tylko jeden wątek. Nie należy mieszać tego modułu
+ * z wypisywaniem na standardowe wyjście funkcjami biblioteki stdio bez
+ * uprzedniego wywołania @ref OutputFlush(void).
+ *
+ * @author Jan Kwiatkowski
+ */
+
+#ifndef POLYNOMIALS_OUTPUT_H
+#define POLYNOMIALS_OUTPUT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/** Rozmiar bufora wyjścia w bajtach. */
+#define OUTPUT_BUFFER_SIZE (1 << 16)
+
+/**
+ * Bufor wyjścia.
+ */
+typedef struct OutputBuffer {
+    char data[OUTPUT_BUFFER_SIZE]; ///< znaki czekające na wypisanie
+    size_t size; ///< liczba znaków w buforze
+} OutputBuffer;
+
+/** Bufor standardowego wyjścia; należy go zmieniać funkcjami tego modułu. */
+extern OutputBuffer output_buffer;
+
+/**
+ * Wypisuje zawartość bufora na standardowe wyjście i go opróżnia.
+ * Błędy zapisu (np. zamknięte wyjście) są pomijane, tak jak przez printf().
+ */
+void OutputFlush(void);
+
+/**
+ * Dopisuje znak do bufora.
+ * @param[in] ch : znak
+ */
+static inline void OutputChar(char ch) {
+    if (output_buffer.size == OUTPUT_BUFFER_SIZE)
+        OutputFlush();
+    output_buffer.data[output_buffer.size++] = ch;
+}
+
+/**
+ * Dopisuje do bufora napis.
+ * @param[in] s : napis zakończony znakiem '\0'
+ */
+void OutputString(const char *s);
+
+/**
+ * Dopisuje do bufora liczbę bez znaku w zapisie dziesiętnym.
+ * @param[in] value : liczba
+ * @param[in] width : minimalna liczba cyfr; krótsza liczba jest uzupełniana
+ * zerami wiodącymi
+ */
+void OutputUnsigned(uint64_t value, size_t width);
+
+/**
+ * Dopisuje do bufora liczbę w zapisie dziesiętnym.
+ * @param[in] value : liczba
+ */
+static inline void OutputLong(long value) {
+    if (value < 0) {
+        OutputChar('-');
+        OutputUnsigned(0 - (uint64_t) value, 0);
+    } else {
+        OutputUnsigned((uint64_t) value, 0);
+    }
+}
+
+/**
+ * Dopisuje do bufora liczbę jako 16 cyfr szesnastkowych (małymi literami).
+ * @param[in] value : liczba
+ */
+void OutputHex64(uint64_t value);
+
+/**
+ * Kończy wiersz. Jeśli standardowe wyjście jest terminalem, opróżnia bufor.
+ */
+void OutputEndLine(void);
+
+#endif //POLYNOMIALS_OUTPUT_H
@@ -12,29 +12,66 @@
  */
 
 #include "poly.h"
+#include "coeff_mod.h"
+#include "poly_dense.h"
+#include "mono_pool.h"
+#include "output.h"
+#include "power_cache.h"
+#include "thread_pool.h"
 #include "utilities.h"
 #include <stdlib.h>
 #include <stdbool.h>
 #include <assert.h>
-#include <stdio.h>
+#include <string.h>
 
 /**
- * Funkcja dodająca lub mnożąca wielomian stały przez wielomian niestały.
- * @param[in] p : wielomian stały
- * @param[in] q : wielomian, który nie jest stały
- * @param[in] add : czy należy dodać czy też pomnożyć wielomiany
- * @return jeśli @p add = true zwraca @f$p + q@f$, w przeciwnym przypadku
- * zwraca @f$p * q@f$
+ * Iloczyn liczb jednomianów czynników, od którego @ref PolyMul(const Poly *p,
+ * const Poly *q) korzysta z mnożenia kopcowego.
  */
-static Poly HandleOneCoeffAddOrMul(const Poly *p, const Poly *q, bool add) {
-    assert(PolyIsCoeff(p) && !PolyIsCoeff(q));
+#define POLY_MUL_HEAP_THRESHOLD 16
+
+/**
+ * Iloczyn liczb jednomianów czynników, od którego @ref PolyMul(const Poly *p,
+ * const Poly *q) dzieli mnożenie między wątki puli.
+ */
+#define POLY_MUL_PARALLEL_THRESHOLD 4096
 
-    Mono single[1];
-    single[0] = MonoFromPoly(p, 0);
-    Poly new_p = {.size = 1, .arr = single};
+/**
+ * Liczba części, na które przypada jeden wątek puli przy mnożeniu
+ * równoległym. Więcej części niż wątków pozwala wyrównać obciążenie przez
+ * podkradanie zadań.
+ */
+#define POLY_MUL_CHUNKS_PER_THREAD 4
 
-    return add ? PolyAdd(&new_p, q) : PolyMul(&new_p, q);
-}
+/**
+ * Największa liczba współczynników (zob. @ref PolyTermCount(const Poly *p))
+ * wielomianu, dla której @ref PolyPow(const Poly *p, poly_exp_t n) rozwija
+ * potęgę ze wzoru wielomianowego.
+ */
+#define POLY_POW_MULTINOMIAL_TERMS 4
+
+/**
+ * Największy wykładnik, dla którego @ref PolyPow(const Poly *p, poly_exp_t n)
+ * rozwija potęgę ze wzoru wielomianowego. Ogranicza rozmiar trójkąta
+ * Pascala.
+ */
+#define POLY_POW_MULTINOMIAL_MAX_EXP 256
+
+/**
+ * Największa liczba składników rozwinięcia ze wzoru wielomianowego.
+ */
+#define POLY_POW_MULTINOMIAL_MAX_PARTS ((size_t) 1 << 16)
+
+/**
+ * Element kopca wykorzystywanego w mnożeniu kopcowym. Odpowiada iloczynowi
+ * jednomianu o indeksie @p i z pierwszego czynnika oraz jednomianu o indeksie
+ * @p j z drugiego czynnika.
+ */
+typedef struct MulHeapEntry {
+    poly_exp_t exp; ///< wykładnik iloczynu jednomianów
+    size_t i; ///< indeks jednomianu w pierwszym czynniku
+    size_t j; ///< indeks jednomianu w drugim czynniku
+} MulHeapEntry;
 
 /**
  * Zmienia długość tablicy jednomianów w @p p na @p arr_size lub, jeśli @p p
@@ -62,6 +99,272 @@ static void PolyChangeIfCoeff(Poly *p, const size_t *arr_size) {
     }
 }
 
+/**
+ * Zapewnia, że tablica jednomianów wielomianu @p p nie jest współdzielona,
+ * kopiując ją w razie potrzeby. Kopiowane są jedynie jednomiany tej tablicy,
+ * a ich współczynniki pozostają współdzielone. Należy ją wywołać przed każdą
+ * zmianą tablicy jednomianów istniejącego wielomianu.
+ * @param[in,out] p : wielomian, który nie jest stały
+ */
+static void PolyMakeUnique(Poly *p) {
+    assert(!PolyIsCoeff(p));
+
+    // zmieniana tablica traci zapamiętany skrót i opis
+    if (!MonoArrayIsShared(p->arr)) {
+        MonoArrayInvalidate(p->arr);
+        return;
+    }
+
+    Mono *arr = MonoArrayAlloc(p->size);
+    for (size_t i = 0; i < p->size; i++)
+        arr[i] = MonoClone(&p->arr[i]);
+    MonoArrayUnref(p->arr);
+    p->arr = arr;
+}
+
+/**
+ * Zapewnia, że tablica jednomianów wielomianu @p p ma miejsce na co najmniej
+ * @p n jednomianów. Tablica powiększana jest co najmniej dwukrotnie, dzięki
+ * czemu wielokrotne powiększanie akumulatora ma zamortyzowany stały koszt.
+ * @param[in,out] p : wielomian, który nie jest stały
+ * @param[in] n : wymagana liczba miejsc w tablicy
+ */
+static void PolyReserve(Poly *p, size_t n) {
+    assert(!PolyIsCoeff(p));
+
+    size_t capacity = MonoArrayCapacity(p->arr);
+    if (n <= capacity)
+        return;
+
+    while (capacity < n)
+        capacity *= 2;
+    p->arr = MonoArrayRealloc(p->arr, capacity);
+}
+
+/**
+ * Tworzy wielomian @f$c \cdot p@f$.
+ * Pomija jednomiany, których współczynniki w wyniku przepełnienia stały się
+ * zerowe.
+ * @param[in] p : wielomian @f$p@f$
+ * @param[in] c : współczynnik @f$c@f$, wielomian stały
+ * @return @f$c \cdot p@f$
+ */
+static Poly PolyScale(const Poly *p, const Poly *c) {
+    if (CoeffPolyIsOne(c))
+        return PolyClone(p);
+    if (PolyIsCoeff(p))
+        return CoeffPolyMul(p, c);
+
+    Poly poly_ret = CreateNotCoeffPoly(p->size);
+    size_t size = 0;
+    for (size_t i = 0; i < p->size; i++) {
+        Poly scaled = PolyScale(&p->arr[i].p, c);
+        if (!PolyIsZero(&scaled))
+            poly_ret.arr[size++] = (Mono) {.p = scaled, .exp = p->arr[i].exp};
+    }
+
+    PolyChangeIfCoeff(&poly_ret, &size);
+    return poly_ret;
+}
+
+/**
+ * Dodaje w miejscu stałą do wielomianu.
+ * @param[in,out] acc : wielomian
+ * @param[in] c : dodawana stała, wielomian stały
+ */
+static void PolyAddCoeffTo(Poly *acc, const Poly *c) {
+    if (PolyIsZero(c))
+        return;
+
+    if (PolyIsCoeff(acc)) {
+        Poly sum = CoeffPolyAdd(acc, c);
+        PolyDestroy(acc);
+        *acc = sum;
+        return;
+    }
+
+    PolyMakeUnique(acc);
+    size_t size = acc->size;
+    if (acc->arr[0].exp == 0) {
+        PolyAddCoeffTo(&acc->arr[0].p, c);
+        if (PolyIsZero(&acc->arr[0].p)) {
+            size--;
+            memmove(acc->arr, acc->arr + 1, size * sizeof(Mono));
+        }
+    } else {
+        PolyReserve(acc, size + 1);
+        memmove(acc->arr + 1, acc->arr, size * sizeof(Mono));
+        acc->arr[0] = (Mono) {.p = PolyClone(c), .exp = 0};
+        size++;
+    }
+
+    acc->size = size;
+    PolyChangeIfCoeff(acc, &size);
+}
+
+/**
+ * Funkcja dodająca lub mnożąca wielomian stały przez wielomian niestały.
+ * @param[in] p : wielomian stały
+ * @param[in] q : wielomian, który nie jest stały
+ * @param[in] add : czy należy dodać czy też pomnożyć wielomiany
+ * @return jeśli @p add = true zwraca @f$p + q@f$, w przeciwnym przypadku
+ * zwraca @f$p * q@f$
+ */
+static Poly HandleOneCoeffAddOrMul(const Poly *p, const Poly *q, bool add) {
+    assert(PolyIsCoeff(p) && !PolyIsCoeff(q));
+
+    if (!add)
+        return PolyScale(q, p);
+
+    Poly poly_ret = PolyClone(q);
+    PolyAddCoeffTo(&poly_ret, p);
+    return poly_ret;
+}
+
+/**
+ * Dodaje w miejscu do wielomianu @p acc wielomian @f$c \cdot x@f$.
+ * Jednomiany @p acc, których wykładniki nie występują w @p x, nie są
+ * kopiowane, a jedynie przesuwane w powiększonej tablicy. Scalanie odbywa się
+ * od końca tablic, więc nie jest potrzebna tablica pomocnicza.
+ * Jeśli @p own jest prawdą, funkcja przejmuje na własność zawartość @p x
+ * i przenosi jego jednomiany do @p acc zamiast je kopiować (wtedy musi być
+ * @p c = 1). Parametry @p acc i @p x mogą wskazywać ten sam wielomian lub
+ * współdzielić tablicę jednomianów, o ile @p own jest fałszem.
+ * @param[in,out] acc : wielomian, do którego dodajemy
+ * @param[in,out] x : dodawany wielomian
+ * @param[in] c : współczynnik, przez który mnożymy @p x, wielomian stały
+ * @param[in] own : czy funkcja przejmuje na własność zawartość @p x
+ */
+static void PolyAddInPlace(Poly *acc, Poly *x, const Poly *c, bool own) {
+    assert(!own || CoeffPolyIsOne(c));
+
+    if (PolyIsZero(c))
+        return;
+
+    if (PolyIsCoeff(x)) {
+        Poly product = CoeffPolyMul(x, c);
+        PolyAddCoeffTo(acc, &product);
+        PolyDestroy(&product);
+        if (own) {
+            PolyDestroy(x);
+            *x = PolyZero();
+        }
+        return;
+    }
+
+    // jednomianów współdzielonej tablicy nie można przenieść
+    if (own && MonoArrayIsShared(x->arr)) {
+        PolyAddInPlace(acc, x, c, false);
+        PolyDestroy(x);
+        *x = PolyZero();
+        return;
+    }
+
+    if (PolyIsCoeff(acc)) {
+        Poly coeff = *acc;
+        // c może być tym samym wielomianem co acc, który zaraz nadpiszemy
+        if (c == acc)
+            c = &coeff;
+        if (own) {
+            // przeniesione jednomiany mogą mieć zerowe współczynniki, np. gdy
+            // x jest wynikiem mnożenia, w którym nastąpiło przepełnienie
+            size_t size = 0;
+            MonoArrayInvalidate(x->arr);
+            for (size_t i = 0; i < x->size; i++) {
+                if (!PolyIsZero(&x->arr[i].p))
+                    x->arr[size++] = x->arr[i];
+            }
+            *acc = (Poly) {.size = size, .arr = x->arr};
+            *x = PolyZero();
+            PolyChangeIfCoeff(acc, &size);
+        } else {
+            *acc = PolyScale(x, c);
+        }
+        PolyAddCoeffTo(acc, &coeff);
+        PolyDestroy(&coeff);
+        return;
+    }
+
+    // gdy x współdzieli tablicę z acc, zatrzymujemy ją, aby PolyMakeUnique()
+    // skopiowało acc, a scalanie czytało niezmienioną tablicę x
+    Poly kept = PolyZero();
+    if (acc->arr == x->arr) {
+        assert(!own);
+        kept = PolyClone(x);
+        x = &kept;
+    }
+
+    PolyMakeUnique(acc);
+    size_t n = acc->size, m = x->size;
+    PolyReserve(acc, n + m);
+    Mono *arr = acc->arr;
+
+    // scalamy od końca, zapisując wynik na pozycjach [k + 1, n + m); jednomiany
+    // acc o wykładnikach mniejszych od wszystkich wykładników x zostają na
+    // swoich miejscach
+    size_t i = n, j = m, k = n + m;
+    while (j > 0) {
+        if (i > 0 && arr[i - 1].exp > x->arr[j - 1].exp) {
+            arr[--k] = arr[--i];
+        } else if (i > 0 && arr[i - 1].exp == x->arr[j - 1].exp) {
+            i--;
+            j--;
+            Mono mono = arr[i];
+            PolyAddInPlace(&mono.p, &x->arr[j].p, c, own);
+            if (!PolyIsZero(&mono.p))
+                arr[--k] = mono;
+        } else {
+            j--;
+            Mono mono = {.p = own ? x->arr[j].p : PolyScale(&x->arr[j].p, c),
+                         .exp = x->arr[j].exp};
+            if (!PolyIsZero(&mono.p))
+                arr[--k] = mono;
+        }
+    }
+
+    size_t size = i + (n + m - k);
+    if (k != i)
+        memmove(arr + i, arr + k, (n + m - k) * sizeof(Mono));
+
+    if (own) {
+        MonoArrayFree(x->arr);
+        *x = PolyZero();
+    }
+    PolyDestroy(&kept);
+
+    acc->size = size;
+    PolyChangeIfCoeff(acc, &size);
+    assert(PolyIsSorted(acc));
+}
+
+/** Wielomian stały równy 1, czynnik dodawania bez mnożenia. */
+static const Poly poly_one = {.coeff = 1, .arr = NULL};
+
+void PolyAddTo(Poly *acc, const Poly *x) {
+    PolyAddInPlace(acc, (Poly *) x, &poly_one, false);
+}
+
+/**
+ * Dodaje w miejscu do wielomianu @p acc wielomian @p x, przejmując na
+ * własność jego zawartość.
+ * @param[in,out] acc : wielomian, do którego dodajemy
+ * @param[in,out] x : dodawany wielomian, po wywołaniu jest zerowy
+ */
+static void PolyAddOwnTo(Poly *acc, Poly *x) {
+    PolyAddInPlace(acc, x, &poly_one, true);
+}
+
+void PolyMulAddTo(Poly *acc, const Poly *a, const Poly *b) {
+    if (PolyIsCoeff(a)) {
+        PolyAddInPlace(acc, (Poly *) b, a, false);
+    } else if (PolyIsCoeff(b)) {
+        PolyAddInPlace(acc, (Poly *) a, b, false);
+    } else {
+        Poly mul_poly = PolyMul(a, b);
+        PolyAddOwnTo(acc, &mul_poly);
+    }
+}
+
 /**
  * Klonuje jednomian z @p p do @p poly_ret o ile wielomian, który zawiera ten
  * jednomian nie jest tożsamościowo równy 0.
@@ -90,28 +393,64 @@ static void MonoCloneIfNotZero(Poly *poly_ret, size_t *ptr, const Poly *p,
     *p_ptr = *p_ptr + 1;
 }
 
+/**
+ * Tablica jednomianów, której ostatnie odwołanie zostało usunięte i która
+ * czeka na zwolnienie w @ref PolyDestroy(Poly *p).
+ */
+typedef struct DestroyFrame {
+    Mono *arr; ///< tablica jednomianów
+    size_t size; ///< liczba jednomianów w tablicy
+} DestroyFrame;
+
 void PolyDestroy(Poly *p) {
-    if (!PolyIsCoeff(p)) {
-        for (size_t i = 0; i < p->size; i++)
-            MonoDestroy(&p->arr[i]);
-        free(p->arr);
+    if (PolyIsBig(p)) {
+        BigUnref(p->big);
+        return;
+    }
+    if (PolyIsCoeff(p) || !MonoArrayUnref(p->arr))
+        return;
+
+    // zwalniane tablice trafiają na stos roboczy zamiast do wywołań
+    // rekurencyjnych, więc głębokość wielomianu nie jest ograniczona
+    // rozmiarem stosu wywołań
+    DestroyFrame local[WORK_STACK_LOCAL];
+    DestroyFrame *stack = local;
+    size_t capacity = WORK_STACK_LOCAL, top = 0;
+    stack[top++] = (DestroyFrame) {.arr = p->arr, .size = p->size};
+
+    while (top > 0) {
+        DestroyFrame frame = stack[--top];
+        for (size_t i = 0; i < frame.size; i++) {
+            Poly *coeff = &frame.arr[i].p;
+            if (PolyIsBig(coeff)) {
+                BigUnref(coeff->big);
+            } else if (!PolyIsCoeff(coeff) && MonoArrayUnref(coeff->arr)) {
+                if (top == capacity)
+                    stack = WorkStackGrow(stack, local, &capacity,
+                                          sizeof(DestroyFrame));
+                stack[top++] = (DestroyFrame) {.arr = coeff->arr,
+                                               .size = coeff->size};
+            }
+        }
+        MonoArrayFree(frame.arr);
     }
+
+    if (stack != local)
+        free(stack);
 }
 
 Poly PolyClone(const Poly *p) {
-    if (PolyIsCoeff(p))
-        return PolyFromCoeff(p->coeff);
+    if (PolyIsBig(p))
+        BigRetain(p->big);
+    else if (!PolyIsCoeff(p))
+        MonoArrayRetain(p->arr);
 
-    Poly ret_poly = CreateNotCoeffPoly(p->size);
-    for (size_t i = 0; i < p->size; i++)
-        ret_poly.arr[i] = MonoClone(&p->arr[i]);
-
-    return ret_poly;
+    return *p;
 }
 
 Poly PolyAdd(const Poly *p, const Poly *q) {
     if (PolyIsCoeff(p) && PolyIsCoeff(q))
-        return PolyFromCoeff(p->coeff + q->coeff);
+        return CoeffPolyAdd(p, q);
     if (PolyIsCoeff(p))
         return HandleOneCoeffAddOrMul(p, q, true);
     if (PolyIsCoeff(q))
@@ -155,82 +494,596 @@ Poly PolyAdd(const Poly *p, const Poly *q) {
     }
 
     PolyChangeIfCoeff(&poly_ret, &ret_arr_size);
+    assert(PolyIsSorted(&poly_ret));
 
-    PolySort(&poly_ret);
     return poly_ret;
 }
 
-Poly PolyAddMonos(size_t count, const Mono monos[]) {
-    if (count == 0)
+/**
+ * Wstawia element do kopca minimalnego (względem wykładników).
+ * @param[in,out] heap : kopiec
+ * @param[in,out] size : liczba elementów w kopcu
+ * @param[in] entry : wstawiany element
+ */
+static void MulHeapPush(MulHeapEntry *heap, size_t *size, MulHeapEntry entry) {
+    size_t pos = (*size)++;
+    while (pos > 0) {
+        size_t parent = (pos - 1) / 2;
+        if (heap[parent].exp <= entry.exp)
+            break;
+        heap[pos] = heap[parent];
+        pos = parent;
+    }
+    heap[pos] = entry;
+}
+
+/**
+ * Usuwa z kopca minimalnego element o najmniejszym wykładniku.
+ * @param[in,out] heap : niepusty kopiec
+ * @param[in,out] size : liczba elementów w kopcu
+ * @return usunięty element
+ */
+static MulHeapEntry MulHeapPop(MulHeapEntry *heap, size_t *size) {
+    assert(*size > 0);
+    MulHeapEntry top = heap[0];
+    MulHeapEntry last = heap[--*size];
+    if (*size == 0)
+        return top;
+
+    size_t pos = 0;
+    while (true) {
+        size_t child = 2 * pos + 1;
+        if (child >= *size)
+            break;
+        if (child + 1 < *size && heap[child + 1].exp < heap[child].exp)
+            child++;
+        if (last.exp <= heap[child].exp)
+            break;
+        heap[pos] = heap[child];
+        pos = child;
+    }
+    heap[pos] = last;
+
+    return top;
+}
+
+/**
+ * Mnoży dwa wielomiany niebędące współczynnikami, scalając strumień iloczynów
+ * jednomianów za pomocą kopca (algorytm Johnsona).
+ * Kopiec zawiera co najwyżej jeden element dla każdego jednomianu z @p p,
+ * dzięki czemu iloczyny jednomianów wyznaczane są w kolejności
+ * niemalejących wykładników. Iloczyny o równych wykładnikach są sumowane od
+ * razu, a wynikowa tablica jednomianów jest posortowana bez dodatkowego
+ * sortowania i bez tworzenia wielomianów pośrednich.
+ * @param[in] p : wielomian @f$p@f$ (najlepiej krótszy z czynników)
+ * @param[in] q : wielomian @f$q@f$
+ * @return @f$p * q@f$
+ */
+static Poly PolyMulHeap(const Poly *p, const Poly *q) {
+    assert(!PolyIsCoeff(p) && !PolyIsCoeff(q));
+
+    MulHeapEntry *heap = SafeMalloc(p->size * sizeof(MulHeapEntry));
+    size_t heap_size = 0;
+    size_t capacity = p->size + q->size;
+    Mono *monos = MonoArrayAlloc(capacity);
+    size_t count = 0;
+
+    MulHeapPush(heap, &heap_size, (MulHeapEntry) {
+        .exp = p->arr[0].exp + q->arr[0].exp, .i = 0, .j = 0});
+
+    while (heap_size > 0) {
+        poly_exp_t exp = heap[0].exp;
+        Poly sum = PolyZero();
+
+        // zdejmujemy z kopca wszystkie iloczyny o najmniejszym wykładniku,
+        // wstawiając w ich miejsce kolejne iloczyny z tego samego wiersza
+        // (oraz pierwszy iloczyn z następnego wiersza)
+        while (heap_size > 0 && heap[0].exp == exp) {
+            MulHeapEntry entry = MulHeapPop(heap, &heap_size);
+            PolyMulAddTo(&sum, &p->arr[entry.i].p, &q->arr[entry.j].p);
+
+            if (entry.j == 0 && entry.i + 1 < p->size) {
+                MulHeapPush(heap, &heap_size, (MulHeapEntry) {
+                    .exp = p->arr[entry.i + 1].exp + q->arr[0].exp,
+                    .i = entry.i + 1, .j = 0});
+            }
+            if (entry.j + 1 < q->size) {
+                MulHeapPush(heap, &heap_size, (MulHeapEntry) {
+                    .exp = p->arr[entry.i].exp + q->arr[entry.j + 1].exp,
+                    .i = entry.i, .j = entry.j + 1});
+            }
+        }
+
+        if (PolyIsZero(&sum))
+            continue;
+
+        if (count == capacity) {
+            capacity *= 2;
+            monos = MonoArrayRealloc(monos, capacity);
+        }
+        monos[count++] = (Mono) {.p = sum, .exp = exp};
+    }
+    free(heap);
+
+    if (count == 0) {
+        MonoArrayFree(monos);
         return PolyZero();
+    }
 
-    Mono copy[count];
-    Poly from = {.size = count, .arr = copy};
-    for (size_t i = 0; i < count; i++)
-        from.arr[i] = monos[i];
+    Poly poly_ret = {.size = count, .arr = MonoArrayRealloc(monos, count)};
+    PolyChangeIfCoeff(&poly_ret, &count);
+    assert(PolyIsSorted(&poly_ret));
 
-    PolySort(&from);
+    return poly_ret;
+}
 
-    Poly poly_ret = CreateNotCoeffPoly(count);
-    size_t size = 0;
-    poly_ret.arr[0] = from.arr[0];
+/**
+ * Dane zadań sumowania równoległego.
+ */
+typedef struct TreeSumArgs {
+    Poly *parts; ///< sumowane wielomiany
+    size_t count; ///< liczba sumowanych wielomianów
+    size_t step; ///< odległość między sumowanymi wielomianami
+} TreeSumArgs;
 
-    // przechodzimy po jednomianach posortowanych po wykładnikach, sumujemy
-    // współczynniki jednomianów o tych samych wykładnikach
-    for (size_t i = 1; i < count; i++) {
-        if (from.arr[i].exp == from.arr[i - 1].exp) {
-            Poly prev = poly_ret.arr[size].p;
-            poly_ret.arr[size].p = PolyAdd(&prev, &from.arr[i].p);
-            MonoDestroy(&from.arr[i]);
+/**
+ * Dodaje wielomian @f$(2i + 1) \cdot step@f$ do wielomianu
+ * @f$2i \cdot step@f$.
+ * @param[in,out] arg : dane sumowania
+ * @param[in] i : numer pary
+ */
+static void TreeSumTask(void *arg, size_t i) {
+    TreeSumArgs *args = arg;
+    size_t first = 2 * i * args->step, second = first + args->step;
+    if (second < args->count)
+        PolyAddOwnTo(&args->parts[first], &args->parts[second]);
+}
+
+/**
+ * Sumuje wielomiany parami w drzewie o wysokości
+ * @f$\lceil \log_2 count \rceil@f$, wykonując dodawania z jednego poziomu
+ * drzewa równolegle. Przejmuje na własność sumowane wielomiany.
+ * @param[in] count : liczba wielomianów, dodatnia
+ * @param[in] parts : wielomiany
+ * @return suma wielomianów
+ */
+static Poly PolyTreeSum(size_t count, Poly parts[]) {
+    assert(count > 0);
+    TreeSumArgs args = {.parts = parts, .count = count};
+    for (args.step = 1; args.step < count; args.step *= 2) {
+        size_t pairs = (count + 2 * args.step - 1) / (2 * args.step);
+        ThreadPoolRun(pairs, TreeSumTask, &args);
+    }
+    return parts[0];
+}
+
+/**
+ * Dane zadań mnożenia równoległego.
+ */
+typedef struct ParallelMulArgs {
+    const Poly *p; ///< dzielony czynnik
+    const Poly *q; ///< drugi czynnik
+    size_t chunks; ///< liczba części czynnika @p p
+    Poly *parts; ///< iloczyny częściowe
+} ParallelMulArgs;
+
+/**
+ * Mnoży jedną część jednomianów czynnika @p p przez czynnik @p q.
+ * @param[in,out] arg : dane mnożenia
+ * @param[in] i : numer części
+ */
+static void ParallelMulTask(void *arg, size_t i) {
+    ParallelMulArgs *args = arg;
+    size_t begin = args->p->size * i / args->chunks;
+    size_t end = args->p->size * (i + 1) / args->chunks;
+    // część tablicy jednomianów jest posortowana, więc jest poprawnym
+    // wielomianem tylko do odczytu
+    Poly part = {.size = end - begin, .arr = args->p->arr + begin};
+    args->parts[i] = PolyMulHeap(&part, args->q);
+}
+
+/**
+ * Mnoży dwa wielomiany niebędące współczynnikami, dzieląc jednomiany @p p
+ * na spójne części mnożone przez @p q w osobnych zadaniach puli wątków.
+ * Iloczyny częściowe są posortowane i scalane parami, również równolegle.
+ * Arytmetyka współczynników modulo @f$2^{64}@f$ jest łączna i przemienna,
+ * a postać wielomianu jest jednoznaczna, więc wynik jest identyczny
+ * z wynikiem mnożenia sekwencyjnego.
+ * @param[in] p : wielomian @f$p@f$ (najlepiej krótszy z czynników)
+ * @param[in] q : wielomian @f$q@f$
+ * @return @f$p * q@f$
+ */
+static Poly PolyMulParallel(const Poly *p, const Poly *q) {
+    size_t chunks = POLY_MUL_CHUNKS_PER_THREAD * ThreadPoolSize();
+    if (chunks > p->size)
+        chunks = p->size;
+
+    ParallelMulArgs args = {.p = p, .q = q, .chunks = chunks,
+                            .parts = SafeMalloc(chunks * sizeof(Poly))};
+    ThreadPoolRun(chunks, ParallelMulTask, &args);
+
+    Poly poly_ret = PolyTreeSum(chunks, args.parts);
+    free(args.parts);
+    return poly_ret;
+}
+
+Poly PolyMul(const Poly *p, const Poly *q) {
+    if (PolyIsCoeff(p) && PolyIsCoeff(q))
+        return CoeffPolyMul(p, q);
+    if (PolyIsCoeff(p))
+        return HandleOneCoeffAddOrMul(p, q, false);
+    if (PolyIsCoeff(q))
+        return HandleOneCoeffAddOrMul(q, p, false);
+
+    assert(!PolyIsCoeff(p) && !PolyIsCoeff(q));
+    assert(PolyIsSorted(p) && PolyIsSorted(q));
+
+    if (p->size > q->size) {
+        return PolyMul(q, p);
+    }
+
+    if (p->size * q->size >= POLY_MUL_HEAP_THRESHOLD) {
+        Poly poly_ret;
+        if (PolyMulDense(p, q, &poly_ret))
+            return poly_ret;
+        if (ThreadPoolSize() > 1 && p->size > 1 &&
+            p->size * q->size >= POLY_MUL_PARALLEL_THRESHOLD)
+            return PolyMulParallel(p, q);
+        return PolyMulHeap(p, q);
+    }
+
+    Poly poly_ret = PolyZero();
+
+    for (size_t i = 0; i < p->size; i++) {
+        Poly processed = CreateNotCoeffPoly(q->size);
+        for (size_t j = 0; j < q->size; j++) {
+            processed.arr[j].exp = p->arr[i].exp + q->arr[j].exp;
+            processed.arr[j].p = PolyMul(&p->arr[i].p, &q->arr[j].p);
+        }
+
+        PolyAddOwnTo(&poly_ret, &processed);
+    }
+
+    return poly_ret;
+}
+
+/**
+ * Podnosi współczynnik do potęgi algorytmem szybkiego potęgowania.
+ * @param[in] x : wielomian stały
+ * @param[in] exp : wykładnik, nieujemny
+ * @return @f$x^{exp}@f$
+ */
+static Poly CoeffPolyPow(const Poly *x, poly_exp_t exp) {
+    Poly poly_ret = PolyFromCoeff(1), base = PolyClone(x);
+    while (exp > 0) {
+        if (exp % 2 == 1) {
+            Poly prev = poly_ret;
+            poly_ret = CoeffPolyMul(&poly_ret, &base);
             PolyDestroy(&prev);
         }
-        else {
-            if (!PolyIsZero(&poly_ret.arr[size].p)) {
-                poly_ret.arr[size].exp = from.arr[i - 1].exp;
-                size++;
+        exp /= 2;
+        if (exp > 0) {
+            Poly prev = base;
+            base = CoeffPolyMul(&base, &base);
+            PolyDestroy(&prev);
+        }
+    }
+    PolyDestroy(&base);
+    return poly_ret;
+}
+
+/**
+ * Podnosi do kwadratu wielomian niebędący współczynnikiem, scalając
+ * iloczyny jednomianów za pomocą kopca jak w @ref PolyMulHeap(const Poly *p,
+ * const Poly *q). Kopiec przechodzi jedynie po iloczynach jednomianów
+ * o indeksach @f$i \le j@f$: kwadraty jednomianów dodawane są wprost,
+ * a iloczyny mieszane wyznaczane są raz i podwajane po zsumowaniu wszystkich
+ * iloczynów o danym wykładniku.
+ * @param[in] p : wielomian @f$p@f$
+ * @return @f$p^2@f$
+ */
+static Poly PolySquareHeap(const Poly *p) {
+    assert(!PolyIsCoeff(p));
+
+    MulHeapEntry *heap = SafeMalloc(p->size * sizeof(MulHeapEntry));
+    size_t heap_size = 0;
+    size_t capacity = 2 * p->size;
+    Mono *monos = MonoArrayAlloc(capacity);
+    size_t count = 0;
+    Poly two = PolyFromCoeff(2);
+
+    MulHeapPush(heap, &heap_size, (MulHeapEntry) {
+        .exp = 2 * p->arr[0].exp, .i = 0, .j = 0});
+
+    while (heap_size > 0) {
+        poly_exp_t exp = heap[0].exp;
+        Poly sum = PolyZero(), cross = PolyZero();
+
+        // wiersz i zaczyna się od kwadratu i-tego jednomianu; następny wiersz
+        // wstawiamy do kopca po zdjęciu tego kwadratu
+        while (heap_size > 0 && heap[0].exp == exp) {
+            MulHeapEntry entry = MulHeapPop(heap, &heap_size);
+            const Poly *a = &p->arr[entry.i].p, *b = &p->arr[entry.j].p;
+            if (entry.i == entry.j) {
+                Poly square = PolySquare(a);
+                PolyAddOwnTo(&sum, &square);
+                if (entry.i + 1 < p->size) {
+                    MulHeapPush(heap, &heap_size, (MulHeapEntry) {
+                        .exp = 2 * p->arr[entry.i + 1].exp,
+                        .i = entry.i + 1, .j = entry.i + 1});
+                }
+            } else {
+                PolyMulAddTo(&cross, a, b);
             }
-            poly_ret.arr[size] = from.arr[i];
+            if (entry.j + 1 < p->size) {
+                MulHeapPush(heap, &heap_size, (MulHeapEntry) {
+                    .exp = p->arr[entry.i].exp + p->arr[entry.j + 1].exp,
+                    .i = entry.i, .j = entry.j + 1});
+            }
+        }
+        PolyAddInPlace(&sum, &cross, &two, false);
+        PolyDestroy(&cross);
+
+        if (PolyIsZero(&sum))
+            continue;
+
+        if (count == capacity) {
+            capacity *= 2;
+            monos = MonoArrayRealloc(monos, capacity);
+        }
+        monos[count++] = (Mono) {.p = sum, .exp = exp};
+    }
+    free(heap);
+
+    if (count == 0) {
+        MonoArrayFree(monos);
+        return PolyZero();
+    }
+
+    Poly poly_ret = {.size = count, .arr = MonoArrayRealloc(monos, count)};
+    PolyChangeIfCoeff(&poly_ret, &count);
+    assert(PolyIsSorted(&poly_ret));
+
+    return poly_ret;
+}
+
+Poly PolySquare(const Poly *p) {
+    if (PolyIsCoeff(p))
+        return CoeffPolyMul(p, p);
+
+    if (p->size * p->size >= POLY_MUL_HEAP_THRESHOLD) {
+        Poly poly_ret;
+        if (PolyMulDense(p, p, &poly_ret))
+            return poly_ret;
+        if (ThreadPoolSize() > 1 &&
+            p->size * p->size >= POLY_MUL_PARALLEL_THRESHOLD)
+            return PolyMulParallel(p, p);
+    }
+
+    return PolySquareHeap(p);
+}
+
+/**
+ * Dane rozwinięcia potęgi wielomianu ze wzoru wielomianowego. Wielomian
+ * traktowany jest jako suma składników @f$c_i x^{e_i}@f$, gdzie @f$c_i@f$ są
+ * liczbami, a @f$e_i@f$ wektorami wykładników kolejnych zmiennych.
+ */
+typedef struct PowExpansion {
+    size_t terms; ///< liczba składników
+    size_t depth; ///< liczba zmiennych, długość wektorów wykładników
+    const Poly **coeffs; ///< współczynniki składników
+    poly_exp_t *exps; ///< wektory wykładników składników, wierszami
+    Poly *powers; ///< @f$c_i^k@f$ na pozycji @f$i (n + 1) + k@f$
+    Poly *binomial; ///< @f$\binom{m}{k}@f$ na pozycji @f$m (m + 1) / 2 + k@f$
+    poly_exp_t *path; ///< wykładniki częściowych iloczynów, wierszami
+    Poly *parts; ///< składniki rozwinięcia
+    size_t count; ///< liczba składników rozwinięcia
+    poly_exp_t n; ///< wykładnik potęgi
+} PowExpansion;
+
+/**
+ * Wyznacza liczbę zmiennych, od których może zależeć wielomian, czyli
+ * głębokość jego zagnieżdżenia.
+ * @param[in] p : wielomian
+ * @return głębokość zagnieżdżenia
+ */
+static size_t PolyNesting(const Poly *p) {
+    if (PolyIsCoeff(p))
+        return 0;
+
+    size_t ret = 0;
+    for (size_t i = 0; i < p->size; i++) {
+        size_t nesting = PolyNesting(&p->arr[i].p);
+        if (nesting > ret)
+            ret = nesting;
+    }
+    return ret + 1;
+}
+
+/**
+ * Zapisuje składniki wielomianu w danych rozwinięcia.
+ * @param[in] p : wielomian
+ * @param[in,out] e : dane rozwinięcia
+ * @param[in,out] path : wykładniki zmiennych o indeksach mniejszych niż
+ * @p level
+ * @param[in] level : indeks zmiennej wielomianu @p p
+ */
+static void PowFlatten(const Poly *p, PowExpansion *e, poly_exp_t path[],
+                       size_t level) {
+    if (PolyIsCoeff(p)) {
+        poly_exp_t *exps = e->exps + e->terms * e->depth;
+        for (size_t d = 0; d < e->depth; d++)
+            exps[d] = d < level ? path[d] : 0;
+        e->coeffs[e->terms++] = p;
+        return;
+    }
+
+    for (size_t i = 0; i < p->size; i++) {
+        path[level] = p->arr[i].exp;
+        PowFlatten(&p->arr[i].p, e, path, level + 1);
+    }
+}
+
+/**
+ * Tworzy jednomian o danym współczynniku i wektorze wykładników.
+ * Przejmuje na własność współczynnik.
+ * @param[in] coeff : współczynnik, niezerowy wielomian stały
+ * @param[in] exps : wykładniki kolejnych zmiennych
+ * @param[in] depth : liczba zmiennych
+ * @return jednomian jako wielomian
+ */
+static Poly PolyFromPath(Poly coeff, const poly_exp_t exps[], size_t depth) {
+    for (size_t d = depth; d > 0; d--) {
+        // zmienna w potędze 0 nad liczbą nie tworzy poziomu zagnieżdżenia
+        if (exps[d - 1] == 0 && PolyIsCoeff(&coeff))
+            continue;
+        Poly poly = CreateNotCoeffPoly(1);
+        poly.arr[0] = (Mono) {.p = coeff, .exp = exps[d - 1]};
+        coeff = poly;
+    }
+    return coeff;
+}
+
+/**
+ * Rozwija iloczyny potęg składników o indeksach od @p i, których wykładniki
+ * sumują się do @p rest, dopisując składniki rozwinięcia do danych.
+ * @param[in,out] e : dane rozwinięcia
+ * @param[in] i : indeks składnika
+ * @param[in] rest : pozostały wykładnik
+ * @param[in] coeff : współczynnik iloczynu potęg składników o indeksach
+ * mniejszych niż @p i, pomnożony przez współczynniki wielomianowe
+ */
+static void PowExpand(PowExpansion *e, size_t i, poly_exp_t rest,
+                      const Poly *coeff) {
+    const poly_exp_t *path = e->path + i * e->depth;
+    if (i == e->terms) {
+        e->parts[e->count++] = PolyFromPath(PolyClone(coeff), path, e->depth);
+        return;
+    }
+
+    poly_exp_t *next_path = e->path + (i + 1) * e->depth;
+    const poly_exp_t *exps = e->exps + i * e->depth;
+    size_t binomial_row = (size_t) rest * (rest + 1) / 2;
+    for (poly_exp_t k = i + 1 == e->terms ? rest : 0; k <= rest; k++) {
+        Poly factor = CoeffPolyMul(&e->binomial[binomial_row + k],
+                                   &e->powers[i * (e->n + 1) + k]);
+        Poly next = CoeffPolyMul(coeff, &factor);
+        PolyDestroy(&factor);
+
+        // przy przepełnieniu lub z ustawionym modułem iloczyn może być zerowy
+        if (!PolyIsZero(&next)) {
+            for (size_t d = 0; d < e->depth; d++)
+                next_path[d] = path[d] + k * exps[d];
+            PowExpand(e, i + 1, rest - k, &next);
         }
+        PolyDestroy(&next);
     }
+}
 
-    // sprawdzamy czy nie trzeba dodać ostatniego jednomianu z tablicy
-    if (!PolyIsZero(&poly_ret.arr[size].p))
-        size++;
+/**
+ * Podnosi wielomian o niewielu współczynnikach do potęgi ze wzoru
+ * wielomianowego: dla składników @f$c_1 x^{e_1}, \ldots, c_t x^{e_t}@f$
+ * potęga jest sumą
+ * @f$\binom{n}{k_1, \ldots, k_t} c_1^{k_1} \cdots c_t^{k_t}
+ * x^{k_1 e_1 + \ldots + k_t e_t}@f$ po @f$k_1 + \ldots + k_t = n@f$.
+ * Współczynniki wielomianowe wyznaczane są jako iloczyny współczynników
+ * dwumianowych z trójkąta Pascala, więc nie wymagają dzielenia.
+ * @param[in] p : wielomian, który nie jest stały
+ * @param[in] n : wykładnik, nie mniejszy niż 2
+ * @param[out] result : miejsce, w którym zapisywana jest potęga, jeśli
+ * funkcja zwróci prawdę
+ * @return czy potęga została wyznaczona
+ */
+static bool PolyPowMultinomial(const Poly *p, poly_exp_t n, Poly *result) {
+    size_t terms = PolyTermCount(p);
+    if (terms > POLY_POW_MULTINOMIAL_TERMS ||
+        n > POLY_POW_MULTINOMIAL_MAX_EXP)
+        return false;
 
-    PolyChangeIfCoeff(&poly_ret, &size);
-    assert(PolyIsSorted(&poly_ret));
+    // liczba składników rozwinięcia to C(n + terms - 1, terms - 1)
+    size_t parts = 1;
+    for (size_t i = 1; i < terms; i++)
+        parts = parts * (n + i) / i;
+    if (parts > POLY_POW_MULTINOMIAL_MAX_PARTS)
+        return false;
 
-    return poly_ret;
+    PowExpansion e = {.terms = 0, .depth = PolyNesting(p), .n = n,
+                      .count = 0};
+    e.coeffs = SafeMalloc(terms * sizeof(Poly *));
+    e.exps = SafeMalloc(terms * e.depth * sizeof(poly_exp_t));
+    e.path = SafeMalloc((terms + 1) * e.depth * sizeof(poly_exp_t));
+    PowFlatten(p, &e, e.path, 0);
+    assert(e.terms == terms);
+
+    size_t binomial_size = (size_t) (n + 1) * (n + 2) / 2;
+    e.binomial = SafeMalloc(binomial_size * sizeof(Poly));
+    for (poly_exp_t m = 0; m <= n; m++) {
+        Poly *row = e.binomial + (size_t) m * (m + 1) / 2;
+        Poly *prev = row - m;
+        row[0] = row[m] = PolyFromCoeff(1);
+        for (poly_exp_t k = 1; k < m; k++)
+            row[k] = CoeffPolyAdd(&prev[k - 1], &prev[k]);
+    }
+
+    e.powers = SafeMalloc(terms * (n + 1) * sizeof(Poly));
+    for (size_t i = 0; i < terms; i++) {
+        Poly *row = e.powers + i * (n + 1);
+        row[0] = PolyFromCoeff(1);
+        for (poly_exp_t k = 1; k <= n; k++)
+            row[k] = CoeffPolyMul(&row[k - 1], e.coeffs[i]);
+    }
+
+    e.parts = SafeMalloc(parts * sizeof(Poly));
+    for (size_t d = 0; d < e.depth; d++)
+        e.path[d] = 0;
+    Poly one = PolyFromCoeff(1);
+    PowExpand(&e, 0, n, &one);
+
+    *result = e.count == 0 ? PolyZero() : PolyTreeSum(e.count, e.parts);
+
+    for (size_t i = 0; i < binomial_size; i++)
+        PolyDestroy(&e.binomial[i]);
+    for (size_t i = 0; i < terms * (n + 1); i++)
+        PolyDestroy(&e.powers[i]);
+    free(e.binomial);
+    free(e.powers);
+    free(e.parts);
+    free(e.path);
+    free(e.exps);
+    free(e.coeffs);
+    return true;
 }
 
-Poly PolyMul(const Poly *p, const Poly *q) {
-    if (PolyIsCoeff(p) && PolyIsCoeff(q))
-        return PolyFromCoeff(p->coeff * q->coeff);
-    if (PolyIsCoeff(p))
-        return HandleOneCoeffAddOrMul(p, q, false);
-    if (PolyIsCoeff(q))
-        return HandleOneCoeffAddOrMul(q, p, false);
+Poly PolyPow(const Poly *p, poly_exp_t n) {
+    assert(n >= 0);
 
-    assert(!PolyIsCoeff(p) && !PolyIsCoeff(q));
-    assert(PolyIsSorted(p) && PolyIsSorted(q));
+    if (n == 0)
+        return PolyFromCoeff(1);
+    if (PolyIsCoeff(p))
+        return CoeffPolyPow(p, n);
+    if (n == 1)
+        return PolyClone(p);
 
-    if (p->size > q->size) {
-        return PolyMul(q, p);
-    }
+    Poly poly_ret;
+    if (PolyPowMultinomial(p, n, &poly_ret))
+        return poly_ret;
 
-    Poly poly_ret = PolyZero();
+    // potęgowanie binarne od najbardziej znaczącego bitu, dzięki czemu
+    // wynik mnożony jest zawsze przez krótki wielomian p
+    poly_exp_t bit = 1;
+    while (bit <= n / 2)
+        bit *= 2;
 
-    for (size_t i = 0; i < p->size; i++) {
-        Poly processed = CreateNotCoeffPoly(q->size);
-        for (size_t j = 0; j < q->size; j++) {
-            processed.arr[j].exp = p->arr[i].exp + q->arr[j].exp;
-            processed.arr[j].p = PolyMul(&p->arr[i].p, &q->arr[j].p);
+    poly_ret = PolyClone(p);
+    for (bit /= 2; bit > 0; bit /= 2) {
+        Poly prev = poly_ret;
+        poly_ret = PolySquare(&prev);
+        PolyDestroy(&prev);
+        if (n & bit) {
+            prev = poly_ret;
+            poly_ret = PolyMul(&prev, p);
+            PolyDestroy(&prev);
         }
-
-        Poly poly_new = PolyAdd(&poly_ret, &processed);
-        PolyDestroy(&poly_ret);
-        PolyDestroy(&processed);
-        poly_ret = poly_new;
     }
 
     return poly_ret;
@@ -238,7 +1091,7 @@ Poly PolyMul(const Poly *p, const Poly *q) {
 
 Poly PolyNeg(const Poly *p) {
     if (PolyIsCoeff(p)) {
-        return PolyFromCoeff(-1 * p->coeff);
+        return CoeffPolyNeg(p);
     }
 
     Poly poly_ret = CreateNotCoeffPoly(p->size);
@@ -250,14 +1103,136 @@ Poly PolyNeg(const Poly *p) {
     return poly_ret;
 }
 
+Poly PolyReduceCoeffs(const Poly *p) {
+    if (PolyIsCoeff(p))
+        return CoeffPolyReduce(p);
+
+    Poly poly_ret = CreateNotCoeffPoly(p->size);
+    size_t size = 0;
+    for (size_t i = 0; i < p->size; i++) {
+        Poly reduced = PolyReduceCoeffs(&p->arr[i].p);
+        if (!PolyIsZero(&reduced))
+            poly_ret.arr[size++] = (Mono) {.p = reduced, .exp = p->arr[i].exp};
+    }
+
+    PolyChangeIfCoeff(&poly_ret, &size);
+    return poly_ret;
+}
+
 Poly PolySub(const Poly *p, const Poly *q) {
-    Poly neg_q = PolyNeg(q);
-    Poly poly_ret = PolyAdd(p, &neg_q);
-    PolyDestroy(&neg_q);
+    Poly minus_one = CoeffPolyNeg(&poly_one);
+    Poly poly_ret = PolyClone(p);
+    PolyAddInPlace(&poly_ret, (Poly *) q, &minus_one, false);
 
     return poly_ret;
 }
 
+void PolyMetaInit(PolyMeta *meta) {
+    meta->terms = 0;
+    meta->depth = 1;
+    meta->deg = 0;
+    for (size_t v = 0; v < POLY_META_VARS; v++)
+        meta->deg_by[v] = 0;
+}
+
+/**
+ * Tworzy opis wielomianu, który nie ma jeszcze żadnych jednomianów.
+ * @return opis przydzielony funkcją malloc()
+ */
+static PolyMeta* PolyMetaNew(void) {
+    PolyMeta *meta = SafeMalloc(sizeof(PolyMeta));
+    PolyMetaInit(meta);
+    return meta;
+}
+
+void PolyMetaAddMono(PolyMeta *meta, const Mono *mono,
+                     const PolyMeta *inner) {
+    meta->deg_by[0] = PolyExpMax(meta->deg_by[0], mono->exp);
+
+    if (inner == NULL) {
+        bool zero = PolyIsZero(&mono->p);
+        meta->terms += zero ? 0 : 1;
+        meta->deg = PolyExpMax(meta->deg, mono->exp - (zero ? 1 : 0));
+        return;
+    }
+
+    meta->terms += inner->terms;
+    meta->deg = PolyExpMax(meta->deg, mono->exp + inner->deg);
+    if (inner->depth + 1 > meta->depth)
+        meta->depth = inner->depth + 1;
+    for (size_t v = 1; v < POLY_META_VARS; v++)
+        meta->deg_by[v] = PolyExpMax(meta->deg_by[v], inner->deg_by[v - 1]);
+}
+
+/**
+ * Wielomian, którego opis jest wyznaczany w
+ * @ref PolyMetaOf(const Poly *p).
+ */
+typedef struct MetaFrame {
+    const Poly *p; ///< wielomian
+    size_t i; ///< indeks kolejnego jednomianu do uwzględnienia
+    PolyMeta *meta; ///< opis uwzględnionych jednomianów
+} MetaFrame;
+
+/**
+ * Zwraca opis wielomianu, wyznaczając go i zapamiętując w tablicach
+ * jednomianów wielomianu i jego poddrzew, jeśli nie był jeszcze znany.
+ * Poddrzewa przechodzone są bez rekurencji.
+ * @param[in] p : wielomian, który nie jest stały
+ * @return opis wielomianu
+ */
+static const PolyMeta* PolyMetaOf(const Poly *p) {
+    assert(!PolyIsCoeff(p));
+
+    const PolyMeta *known = MonoArrayGetMeta(p->arr);
+    if (known != NULL)
+        return known;
+
+    MetaFrame local[WORK_STACK_LOCAL];
+    MetaFrame *stack = local;
+    size_t capacity = WORK_STACK_LOCAL, top = 0;
+    stack[top++] = (MetaFrame) {.p = p, .i = 0, .meta = PolyMetaNew()};
+
+    while (true) {
+        MetaFrame *frame = &stack[top - 1];
+        if (frame->i == frame->p->size) {
+            known = MonoArraySetMeta(frame->p->arr, frame->meta);
+            if (--top == 0)
+                break;
+            frame = &stack[top - 1];
+            PolyMetaAddMono(frame->meta, &frame->p->arr[frame->i++], known);
+            continue;
+        }
+
+        const Mono *mono = &frame->p->arr[frame->i];
+        if (PolyIsCoeff(&mono->p)) {
+            PolyMetaAddMono(frame->meta, mono, NULL);
+            frame->i++;
+        } else if ((known = MonoArrayGetMeta(mono->p.arr)) != NULL) {
+            PolyMetaAddMono(frame->meta, mono, known);
+            frame->i++;
+        } else {
+            if (top == capacity)
+                stack = WorkStackGrow(stack, local, &capacity,
+                                      sizeof(MetaFrame));
+            stack[top++] = (MetaFrame) {.p = &mono->p, .i = 0,
+                                        .meta = PolyMetaNew()};
+        }
+    }
+
+    if (stack != local)
+        free(stack);
+    return known;
+}
+
+/**
+ * Poddrzewo przeglądane w @ref PolyDegBy(const Poly *p, size_t var_idx).
+ */
+typedef struct DegByFrame {
+    const Poly *p; ///< poddrzewo
+    size_t var_idx; ///< indeks zmiennej względem poddrzewa
+} DegByFrame;
+
 poly_exp_t PolyDegBy(const Poly *p, size_t var_idx) {
     if (PolyIsZero(p))
         return -1;
@@ -265,15 +1240,41 @@ poly_exp_t PolyDegBy(const Poly *p, size_t var_idx) {
     if (PolyIsCoeff(p))
         return 0;
 
+    const PolyMeta *meta = PolyMetaOf(p);
+    if (var_idx < POLY_META_VARS)
+        return meta->deg_by[var_idx];
+    if (var_idx >= meta->depth)
+        return 0;
+
+    // schodzimy bez rekurencji do poddrzew, w których zmienna ma indeks
+    // mniejszy niż POLY_META_VARS, i odczytujemy stopnie z ich opisów
+    DegByFrame local[WORK_STACK_LOCAL];
+    DegByFrame *stack = local;
+    size_t capacity = WORK_STACK_LOCAL, top = 0;
+    stack[top++] = (DegByFrame) {.p = p, .var_idx = var_idx};
+
     poly_exp_t ret = 0;
-    for (size_t i = 0; i < p->size; i++) {
-        if (var_idx == 0) {
-            ret = PolyExpMax(ret, p->arr[i].exp);
-        } else {
-            ret = PolyExpMax(ret, PolyDegBy(&p->arr[i].p, var_idx - 1));
+    while (top > 0) {
+        DegByFrame frame = stack[--top];
+        if (PolyIsCoeff(frame.p))
+            continue;
+
+        meta = PolyMetaOf(frame.p);
+        if (frame.var_idx < POLY_META_VARS) {
+            ret = PolyExpMax(ret, meta->deg_by[frame.var_idx]);
+        } else if (frame.var_idx < meta->depth) {
+            for (size_t i = 0; i < frame.p->size; i++) {
+                if (top == capacity)
+                    stack = WorkStackGrow(stack, local, &capacity,
+                                          sizeof(DegByFrame));
+                stack[top++] = (DegByFrame) {.p = &frame.p->arr[i].p,
+                                             .var_idx = frame.var_idx - 1};
+            }
         }
     }
 
+    if (stack != local)
+        free(stack);
     return ret;
 }
 
@@ -284,72 +1285,471 @@ poly_exp_t PolyDeg(const Poly *p) {
     if (PolyIsCoeff(p))
         return 0;
 
-    poly_exp_t ret = 0;
-    for (size_t i = 0; i < p->size; i++)
-        ret = PolyExpMax(ret, p->arr[i].exp + PolyDeg(&p->arr[i].p));
+    return PolyMetaOf(p)->deg;
+}
 
-    return ret;
+size_t PolyTermCount(const Poly *p) {
+    if (PolyIsCoeff(p))
+        return PolyIsZero(p) ? 0 : 1;
+
+    return PolyMetaOf(p)->terms;
 }
 
-bool PolyIsEq(const Poly *p, const Poly *q) {
+size_t PolyDepth(const Poly *p) {
+    if (PolyIsCoeff(p))
+        return 0;
+
+    return PolyMetaOf(p)->depth;
+}
+
+PolyMeta PolyGetMeta(const Poly *p) {
+    if (!PolyIsCoeff(p))
+        return *PolyMetaOf(p);
+
+    PolyMeta meta = {.terms = PolyTermCount(p), .depth = 0, .deg = PolyDeg(p)};
+    for (size_t v = 0; v < POLY_META_VARS; v++)
+        meta.deg_by[v] = meta.deg;
+    return meta;
+}
+
+/**
+ * Wynik porównania wielomianów bez przeglądania ich jednomianów.
+ */
+typedef enum ShallowEq {
+    SHALLOW_DIFFERENT, ///< wielomiany są różne
+    SHALLOW_EQUAL, ///< wielomiany są równe
+    SHALLOW_UNKNOWN ///< należy porównać jednomiany
+} ShallowEq;
+
+/**
+ * Porównuje wielomiany bez przeglądania ich jednomianów.
+ * @param[in] p : wielomian @f$p@f$
+ * @param[in] q : wielomian @f$q@f$
+ * @return wynik porównania
+ */
+static ShallowEq PolyIsEqShallow(const Poly *p, const Poly *q) {
     if (PolyIsCoeff(p) != PolyIsCoeff(q))
-        return false;
+        return SHALLOW_DIFFERENT;
 
     if (PolyIsCoeff(p))
-        return p->coeff == q->coeff;
+        return CoeffPolyEq(p, q) ? SHALLOW_EQUAL : SHALLOW_DIFFERENT;
 
     if (p->size != q->size)
+        return SHALLOW_DIFFERENT;
+
+    // wielomiany współdzielące tablicę jednomianów są równe
+    if (p->arr == q->arr)
+        return SHALLOW_EQUAL;
+
+    return SHALLOW_UNKNOWN;
+}
+
+/**
+ * Para wielomianów porównywanych w
+ * @ref PolyIsEq(const Poly *p, const Poly *q).
+ */
+typedef struct EqFrame {
+    const Poly *p; ///< wielomian @f$p@f$
+    const Poly *q; ///< wielomian @f$q@f$
+    size_t i; ///< indeks kolejnej pary jednomianów do porównania
+} EqFrame;
+
+bool PolyIsEq(const Poly *p, const Poly *q) {
+    // wyznaczenie skrótów zapamiętuje je we wszystkich tablicach obu
+    // wielomianów, więc kolejne porównania różnych wielomianów są
+    // natychmiastowe
+    if (!PolyIsCoeff(p) && !PolyIsCoeff(q) && p->arr != q->arr &&
+        PolyHash(p) != PolyHash(q))
         return false;
 
-    for (size_t i = 0; i < p->size; i++) {
-        if (p->arr[i].exp != q->arr[i].exp ||
-            !PolyIsEq(&p->arr[i].p, &q->arr[i].p)) {
-            return false;
+    ShallowEq shallow = PolyIsEqShallow(p, q);
+    if (shallow != SHALLOW_UNKNOWN)
+        return shallow == SHALLOW_EQUAL;
+
+    EqFrame local[WORK_STACK_LOCAL];
+    EqFrame *stack = local;
+    size_t capacity = WORK_STACK_LOCAL, top = 0;
+    stack[top++] = (EqFrame) {.p = p, .q = q, .i = 0};
+
+    bool ret = true;
+    while (ret && top > 0) {
+        EqFrame *frame = &stack[top - 1];
+        const Poly *p_node = frame->p, *q_node = frame->q;
+
+        // jednomiany, których współczynniki nie wymagają zejścia w głąb,
+        // porównujemy w jednej pętli
+        size_t i = frame->i;
+        shallow = SHALLOW_EQUAL;
+        for (; i < p_node->size; i++) {
+            const Mono *p_mono = &p_node->arr[i], *q_mono = &q_node->arr[i];
+            shallow = p_mono->exp != q_mono->exp ? SHALLOW_DIFFERENT :
+                      PolyIsEqShallow(&p_mono->p, &q_mono->p);
+            if (shallow != SHALLOW_EQUAL)
+                break;
+        }
+
+        if (shallow == SHALLOW_DIFFERENT) {
+            ret = false;
+        } else if (i == p_node->size) {
+            top--;
+        } else {
+            frame->i = i + 1;
+            if (top == capacity)
+                stack = WorkStackGrow(stack, local, &capacity,
+                                      sizeof(EqFrame));
+            stack[top++] = (EqFrame) {.p = &p_node->arr[i].p,
+                                      .q = &q_node->arr[i].p, .i = 0};
         }
     }
 
-    return true;
+    if (stack != local)
+        free(stack);
+    return ret;
+}
+
+/**
+ * Miesza bity liczby (funkcja kończąca generatora splitmix64).
+ * @param[in] x : liczba
+ * @return wymieszana liczba
+ */
+static uint64_t HashMix(uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9UL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebUL;
+    x ^= x >> 31;
+    return x;
+}
+
+/**
+ * Wielomian, którego skrót jest wyznaczany w @ref PolyHash(const Poly *p).
+ */
+typedef struct HashFrame {
+    const Poly *p; ///< wielomian
+    size_t i; ///< indeks kolejnego jednomianu do uwzględnienia
+    uint64_t hash; ///< skrót uwzględnionych jednomianów
+} HashFrame;
+
+/**
+ * Zwraca początkową wartość skrótu wielomianu, który nie jest stały.
+ * @param[in] p : wielomian
+ * @return skrót przed uwzględnieniem jednomianów
+ */
+static uint64_t HashStart(const Poly *p) {
+    return HashMix((uint64_t) p->size ^ 0x9e3779b97f4a7c15UL);
+}
+
+uint64_t PolyHash(const Poly *p) {
+    if (PolyIsBig(p))
+        return HashMix(BigCoeffHash(p));
+    if (PolyIsCoeff(p))
+        return HashMix((uint64_t) p->coeff);
+
+    uint64_t hash = MonoArrayGetHash(p->arr);
+    if (hash != 0)
+        return hash;
+
+    HashFrame local[WORK_STACK_LOCAL];
+    HashFrame *stack = local;
+    size_t capacity = WORK_STACK_LOCAL, top = 0;
+    stack[top++] = (HashFrame) {.p = p, .i = 0, .hash = HashStart(p)};
+
+    while (true) {
+        HashFrame *frame = &stack[top - 1];
+        if (frame->i == frame->p->size) {
+            // 0 oznacza w tablicy brak skrótu
+            hash = frame->hash != 0 ? frame->hash : 1;
+            MonoArraySetHash(frame->p->arr, hash);
+            if (--top == 0)
+                break;
+            frame = &stack[top - 1];
+            frame->hash = HashMix(frame->hash + hash);
+            frame->i++;
+            continue;
+        }
+
+        const Mono *mono = &frame->p->arr[frame->i];
+        frame->hash = HashMix(frame->hash ^ (uint64_t) mono->exp);
+        if (PolyIsCoeff(&mono->p) ||
+            (hash = MonoArrayGetHash(mono->p.arr)) != 0) {
+            frame->hash = HashMix(frame->hash + PolyHash(&mono->p));
+            frame->i++;
+        } else {
+            if (top == capacity)
+                stack = WorkStackGrow(stack, local, &capacity,
+                                      sizeof(HashFrame));
+            stack[top++] = (HashFrame) {.p = &mono->p, .i = 0,
+                                        .hash = HashStart(&mono->p)};
+        }
+    }
+
+    if (stack != local)
+        free(stack);
+    return hash;
+}
+
+/**
+ * Wylicza wartość wielomianu w punkcie @p x w trybie dokładnym, w którym
+ * potęgi @p x mogą nie mieścić się w typie @ref poly_coeff_t.
+ * @param[in] p : wielomian, który nie jest stały
+ * @param[in] x : wartość argumentu @f$x@f$
+ * @return @f$p(x, x_0, x_1, \ldots)@f$
+ */
+static Poly PolyAtExact(const Poly *p, poly_coeff_t x) {
+    Poly base = PolyFromCoeff(x), power = PolyFromCoeff(1);
+    poly_exp_t prev_exp = 0;
+    Poly poly_ret = PolyZero();
+    for (size_t i = 0; i < p->size; i++) {
+        Poly factor = CoeffPolyPow(&base, p->arr[i].exp - prev_exp);
+        Poly prev = power;
+        power = CoeffPolyMul(&power, &factor);
+        PolyDestroy(&prev);
+        PolyDestroy(&factor);
+        prev_exp = p->arr[i].exp;
+
+        // kolejne potęgi też będą zerowe
+        if (PolyIsZero(&power))
+            break;
+
+        PolyAddInPlace(&poly_ret, (Poly *) &p->arr[i].p, &power, false);
+    }
+    PolyDestroy(&power);
+
+    return poly_ret;
 }
 
 Poly PolyAt(const Poly *p, poly_coeff_t x) {
     if (PolyIsCoeff(p))
         return PolyClone(p);
-
+    if (CoeffExactActive())
+        return PolyAtExact(p, x);
+
+    // potęgę x wyznaczamy przyrostowo, podnosząc x do różnicy kolejnych
+    // wykładników; współczynniki będące liczbami sumujemy w coeff_sum,
+    // a pozostałe dodajemy w miejscu do poly_ret; x trzymamy w postaci
+    // Montgomery'ego, bo najczęściej różnica wykładników wynosi 1
+    x = CoeffReduce(x);
+    poly_coeff_t x_mont = CoeffToMont(x);
+    poly_coeff_t power = 1, coeff_sum = 0;
+    poly_exp_t prev_exp = 0;
     Poly poly_ret = PolyZero();
     for (size_t i = 0; i < p->size; i++) {
-        Poly coeff = PolyFromCoeff(FastPow(x, p->arr[i].exp));
-        Poly mul_poly = PolyMul(&p->arr[i].p, &coeff);
-        Poly poly_new = PolyAdd(&poly_ret, &mul_poly);
+        poly_exp_t gap = p->arr[i].exp - prev_exp;
+        power = gap == 1 ? CoeffMulMont(power, x_mont)
+                         : CoeffMul(power, FastPow(x, gap));
+        prev_exp = p->arr[i].exp;
 
-        PolyDestroy(&mul_poly);
-        PolyDestroy(&poly_ret);
+        // kolejne potęgi też będą zerowe
+        if (power == 0)
+            break;
 
-        poly_ret = poly_new;
+        const Poly *q = &p->arr[i].p;
+        if (PolyIsCoeff(q)) {
+            coeff_sum = CoeffAdd(coeff_sum, CoeffMul(power, q->coeff));
+        } else {
+            Poly power_poly = PolyFromCoeff(power);
+            PolyAddInPlace(&poly_ret, (Poly *) q, &power_poly, false);
+        }
     }
+    Poly sum = PolyFromCoeff(coeff_sum);
+    PolyAddCoeffTo(&poly_ret, &sum);
 
     return poly_ret;
 }
 
-void PolyPrint(const Poly *p) {
+/**
+ * Mnoży pasy @p a przez odpowiadające im pasy @p b.
+ * @param[in,out] a : czynniki, w których zapisywane są iloczyny
+ * @param[in] b : czynniki (może być równe @p a)
+ * @param[in] n : liczba pasów
+ */
+static void LanesMul(unsigned long a[], const unsigned long b[], size_t n) {
+    if (CoeffModActive()) {
+        for (size_t j = 0; j < n; j++)
+            a[j] = (unsigned long) CoeffMul((poly_coeff_t) a[j],
+                                            (poly_coeff_t) b[j]);
+        return;
+    }
+
+    for (size_t j = 0; j < n; j++)
+        a[j] *= b[j];
+}
+
+/**
+ * Mnoży potęgi dla wszystkich punktów przez wartości punktów podniesione do
+ * potęgi @p exp.
+ * Wszystkie punkty podnoszone są do tego samego wykładnika, więc pętle po
+ * punktach nie zawierają rozgałęzień i bez ustawionego modułu mogą być
+ * wektoryzowane.
+ * @param[in,out] powers : potęgi dla kolejnych punktów
+ * @param[in] xs : wartości punktów
+ * @param[in,out] base : tablica pomocnicza długości @p n
+ * @param[in] n : liczba punktów
+ * @param[in] exp : wykładnik, nieujemny
+ */
+static void LanesMulPow(unsigned long powers[], const unsigned long xs[],
+                        unsigned long base[], size_t n, poly_exp_t exp) {
+    if (exp == 1) {
+        LanesMul(powers, xs, n);
+        return;
+    }
+
+    for (size_t j = 0; j < n; j++)
+        base[j] = xs[j];
+    while (exp > 0) {
+        if (exp % 2 == 1)
+            LanesMul(powers, base, n);
+        exp /= 2;
+        if (exp > 0)
+            LanesMul(base, base, n);
+    }
+}
+
+void PolyAtMany(const Poly *p, size_t n, const poly_coeff_t xs[], Poly out[]) {
+    if (n == 0)
+        return;
+
     if (PolyIsCoeff(p)) {
-        printf("%ld", p->coeff);
+        for (size_t j = 0; j < n; j++)
+            out[j] = PolyClone(p);
+        return;
+    }
+
+    // potęgi punktów mogą nie mieścić się w pasach
+    if (CoeffExactActive()) {
+        for (size_t j = 0; j < n; j++)
+            out[j] = PolyAt(p, xs[j]);
         return;
     }
+
+    // obliczenia jak w PolyAt(), ale w osobnych pasach dla każdego punktu
+    unsigned long *lanes = SafeMalloc(4 * n * sizeof(unsigned long));
+    unsigned long *points = lanes, *powers = lanes + n, *base = lanes + 2 * n;
+    unsigned long *sums = lanes + 3 * n;
+    for (size_t j = 0; j < n; j++) {
+        points[j] = (unsigned long) CoeffReduce(xs[j]);
+        powers[j] = 1;
+        sums[j] = 0;
+        out[j] = PolyZero();
+    }
+
+    poly_exp_t prev_exp = 0;
     for (size_t i = 0; i < p->size; i++) {
-        if (i != 0)
-            printf("+");
-        printf("(");
-        PolyPrint(&p->arr[i].p);
-        printf(",%d)", p->arr[i].exp);
+        LanesMulPow(powers, points, base, n, p->arr[i].exp - prev_exp);
+        prev_exp = p->arr[i].exp;
+
+        // kolejne potęgi też będą zerowe dla wszystkich punktów
+        unsigned long any = 0;
+        for (size_t j = 0; j < n; j++)
+            any |= powers[j];
+        if (any == 0)
+            break;
+
+        const Poly *q = &p->arr[i].p;
+        if (PolyIsCoeff(q) && CoeffModActive()) {
+            poly_coeff_t coeff_mont = CoeffToMont(q->coeff);
+            for (size_t j = 0; j < n; j++) {
+                sums[j] = (unsigned long) CoeffAdd(
+                    (poly_coeff_t) sums[j],
+                    CoeffMulMont((poly_coeff_t) powers[j], coeff_mont));
+            }
+        } else if (PolyIsCoeff(q)) {
+            unsigned long coeff = (unsigned long) q->coeff;
+            for (size_t j = 0; j < n; j++)
+                sums[j] += powers[j] * coeff;
+        } else {
+            for (size_t j = 0; j < n; j++) {
+                Poly power = PolyFromCoeff((poly_coeff_t) powers[j]);
+                PolyAddInPlace(&out[j], (Poly *) q, &power, false);
+            }
+        }
+    }
+
+    for (size_t j = 0; j < n; j++) {
+        Poly sum = PolyFromCoeff((poly_coeff_t) sums[j]);
+        PolyAddCoeffTo(&out[j], &sum);
     }
+    free(lanes);
 }
 
-Poly PolyOwnMonos(size_t count, Mono *monos) {
-    if (count == 0 || monos == NULL) {
-        free(monos);
-        return PolyZero();
+/**
+ * Wypisuje na standardowe wyjście wielomian stały.
+ * @param[in] p : wielomian stały
+ */
+static void CoeffPrint(const Poly *p) {
+    if (PolyIsBig(p))
+        BigCoeffPrint(p);
+    else
+        OutputLong(p->coeff);
+}
+
+/**
+ * Wielomian wypisywany przez @ref PolyPrint(const Poly *p).
+ */
+typedef struct PrintFrame {
+    const Poly *p; ///< wielomian
+    size_t i; ///< indeks kolejnego jednomianu do wypisania
+} PrintFrame;
+
+void PolyPrint(const Poly *p) {
+    if (PolyIsCoeff(p)) {
+        CoeffPrint(p);
+        return;
+    }
+
+    PrintFrame local[WORK_STACK_LOCAL];
+    PrintFrame *stack = local;
+    size_t capacity = WORK_STACK_LOCAL, top = 0;
+    stack[top++] = (PrintFrame) {.p = p, .i = 0};
+
+    while (top > 0) {
+        PrintFrame *frame = &stack[top - 1];
+        if (frame->i == frame->p->size) {
+            // wypisany wielomian jest współczynnikiem jednomianu rodzica
+            if (--top > 0) {
+                frame = &stack[top - 1];
+                OutputChar(',');
+                OutputLong(frame->p->arr[frame->i++].exp);
+                OutputChar(')');
+            }
+            continue;
+        }
+
+        const Mono *mono = &frame->p->arr[frame->i];
+        if (frame->i != 0)
+            OutputChar('+');
+        OutputChar('(');
+        if (PolyIsCoeff(&mono->p)) {
+            CoeffPrint(&mono->p);
+            OutputChar(',');
+            OutputLong(mono->exp);
+            OutputChar(')');
+            frame->i++;
+        } else {
+            if (top == capacity)
+                stack = WorkStackGrow(stack, local, &capacity,
+                                      sizeof(PrintFrame));
+            stack[top++] = (PrintFrame) {.p = &mono->p, .i = 0};
+        }
     }
 
+    if (stack != local)
+        free(stack);
+}
+
+/**
+ * Sumuje jednomiany z tablicy przydzielonej przez
+ * @ref MonoArrayAlloc(size_t n) i tworzy z nich wielomian, przejmując
+ * tablicę na własność.
+ * Jest to funkcja pomocnicza do
+ * @ref PolyAddMonos(size_t count, const Mono monos[]),
+ * @ref PolyOwnMonos(size_t count, Mono *monos) oraz do
+ * @ref PolyCloneMonos(size_t count, const Mono monos[]).
+ * @param[in] count : liczba jednomianów, dodatnia
+ * @param[in] monos : tablica jednomianów
+ * @return wielomian będący sumą jednomianów
+ */
+static Poly PolyOwnMonoArray(size_t count, Mono *monos) {
     Poly poly_ret = {.size = count, .arr = monos};
 
     PolySort(&poly_ret);
@@ -360,10 +1760,7 @@ Poly PolyOwnMonos(size_t count, Mono *monos) {
     // współczynniki jednomianów o tych samych wykładnikach
     for (size_t i = 1; i < count; i++) {
         if (poly_ret.arr[i].exp == poly_ret.arr[i - 1].exp) {
-            Poly prev = poly_ret.arr[size].p;
-            poly_ret.arr[size].p = PolyAdd(&prev, &poly_ret.arr[i].p);
-            PolyDestroy(&poly_ret.arr[i].p);
-            PolyDestroy(&prev);
+            PolyAddOwnTo(&poly_ret.arr[size].p, &poly_ret.arr[i].p);
         }
         else {
             if (!PolyIsZero(&poly_ret.arr[size].p)) {
@@ -384,21 +1781,48 @@ Poly PolyOwnMonos(size_t count, Mono *monos) {
     return poly_ret;
 }
 
+Poly PolyAddMonos(size_t count, const Mono monos[]) {
+    if (count == 0)
+        return PolyZero();
+
+    // jednomiany przenosimy do tablicy z puli zamiast do tablicy na stosie,
+    // więc ich liczba nie jest ograniczona rozmiarem stosu
+    Mono *arr = MonoArrayAlloc(count);
+    memcpy(arr, monos, count * sizeof(Mono));
+
+    return PolyOwnMonoArray(count, arr);
+}
+
+Poly PolyOwnMonos(size_t count, Mono *monos) {
+    if (count == 0 || monos == NULL) {
+        free(monos);
+        return PolyZero();
+    }
+
+    // tablica zaalokowana na stercie przez wywołującego nie ma nagłówka
+    // wymaganego przez pulę, więc przenosimy jednomiany do tablicy z puli
+    Mono *arr = MonoArrayAlloc(count);
+    memcpy(arr, monos, count * sizeof(Mono));
+    free(monos);
+
+    return PolyOwnMonoArray(count, arr);
+}
+
 Poly PolyCloneMonos(size_t count, const Mono monos[]) {
     if (count == 0 || monos == NULL)
         return PolyZero();
 
-    // skopiowanie zawartości tablicy, a następnie wywołanie PolyOwnMonos()
-    Mono *monos_copy = SafeMalloc(count * sizeof(Mono));
+    Mono *monos_copy = MonoArrayAlloc(count);
     for (size_t i = 0; i < count; i++)
         monos_copy[i] = MonoClone(&monos[i]);
 
-    return PolyOwnMonos(count, monos_copy);
+    return PolyOwnMonoArray(count, monos_copy);
 }
 
 /**
  * Dla danej zmiennej w wielomianie (o indeksie mniejszym niż @p k) znajduje
- * najwyższą potęgę, w której ona występuje.
+ * najwyższą potęgę, w której ona występuje. Stopnie ze względu na pierwsze
+ * zmienne odczytywane są z opisu wielomianu (zob. @ref PolyMeta).
  * @param[in] p : wielomian
  * @param[in,out] max_exp : tablica najwyższych potęg
  * @param[in] k : rozmiar tablicy
@@ -409,10 +1833,15 @@ static void MaxExpFill(const Poly *p, poly_exp_t *max_exp, size_t k,
     if (PolyIsCoeff(p) || depth >= k)
         return;
 
-    for (size_t i = 0; i < p->size; i++) {
+    const PolyMeta *meta = PolyMetaOf(p);
+    size_t vars = meta->depth < k - depth ? meta->depth : k - depth;
+    for (size_t v = 0; v < vars && v < POLY_META_VARS; v++)
+        max_exp[depth + v] = PolyExpMax(max_exp[depth + v], meta->deg_by[v]);
+    if (vars <= POLY_META_VARS)
+        return;
+
+    for (size_t i = 0; i < p->size; i++)
         MaxExpFill(&p->arr[i].p, max_exp, k, depth + 1);
-        max_exp[depth] = PolyExpMax(p->arr[i].exp, max_exp[depth]);
-    }
 }
 
 /**
@@ -477,18 +1906,55 @@ static Poly PolyComposeHelper(const Poly *p, size_t k, Poly **powers,
     for (size_t i = 0; i < p->size; i++) {
         Poly poly = PolyComposeHelper(&p->arr[i].p, k, powers, depth + 1);
         Poly power_poly = PolyFastPow(powers[depth], p->arr[i].exp);
-        Poly mul_poly = PolyMul(&power_poly, &poly);
-        Poly prev = poly_ret;
-        poly_ret = PolyAdd(&poly_ret, &mul_poly);
-        PolyDestroy(&prev);
+        PolyMulAddTo(&poly_ret, &power_poly, &poly);
         PolyDestroy(&power_poly);
-        PolyDestroy(&mul_poly);
         PolyDestroy(&poly);
     }
 
     return poly_ret;
 }
 
+/**
+ * Dane zadań równoległego składania wielomianów.
+ */
+typedef struct ParallelComposeArgs {
+    const Poly *p; ///< wielomian, pod którego zmienne podstawiamy
+    size_t k; ///< liczba podstawianych wielomianów
+    const Poly *q; ///< podstawiane wielomiany
+    Poly **powers; ///< tablice potęg podstawianych wielomianów
+    const poly_exp_t *max_exp; ///< najwyższe potęgi zmiennych w @p p
+    Poly *terms; ///< złożenia kolejnych jednomianów @p p
+} ParallelComposeArgs;
+
+/**
+ * Wyznacza tablicę potęg @f$q_i^1, q_i^2, q_i^4, \ldots@f$, korzystając
+ * z pamięci podręcznej potęg.
+ * @param[in,out] arg : dane składania
+ * @param[in] i : indeks podstawianego wielomianu
+ */
+static void ComposePowersTask(void *arg, size_t i) {
+    ParallelComposeArgs *args = arg;
+    size_t size = PowersOfTwo(args->max_exp[i]);
+    Poly *powers = SafeMalloc(size * sizeof(Poly));
+    PowerCacheFill(&args->q[i], size, powers);
+    args->powers[i] = powers;
+}
+
+/**
+ * Składa jeden jednomian najwyższego poziomu wielomianu @p p.
+ * @param[in,out] arg : dane składania
+ * @param[in] i : indeks jednomianu
+ */
+static void ComposeTermTask(void *arg, size_t i) {
+    ParallelComposeArgs *args = arg;
+    const Mono *mono = &args->p->arr[i];
+    Poly poly = PolyComposeHelper(&mono->p, args->k, args->powers, 1);
+    Poly power_poly = PolyFastPow(args->powers[0], mono->exp);
+    args->terms[i] = PolyMul(&power_poly, &poly);
+    PolyDestroy(&power_poly);
+    PolyDestroy(&poly);
+}
+
 Poly PolyCompose(const Poly *p, size_t k, const Poly q[]) {
     // znalezienie maksymalnych wykładników dla danej zmiennej
     poly_exp_t *max_exp = SafeMalloc(k * sizeof(poly_exp_t));
@@ -496,18 +1962,24 @@ Poly PolyCompose(const Poly *p, size_t k, const Poly q[]) {
         max_exp[i] = 0;
     MaxExpFill(p, max_exp, k, 0);
 
-    // obliczenie wykorzystywanych później potęg
+    // obliczenie wykorzystywanych później potęg, niezależnie dla każdego
+    // podstawianego wielomianu
     Poly **powers = SafeMalloc(k * sizeof(Poly*));
-    for (size_t i = 0; i < k; i++) {
-        size_t size = PowersOfTwo(max_exp[i]);
-        powers[i] = SafeMalloc(size * sizeof(Poly));
-        powers[i][0] = PolyClone(&q[i]);
-        for (size_t j = 1; j < size; j++)
-            powers[i][j] = PolyMul(&powers[i][j - 1], &powers[i][j - 1]);
+    ParallelComposeArgs args = {.p = p, .k = k, .q = q, .powers = powers,
+                                .max_exp = max_exp};
+    ThreadPoolRun(k, ComposePowersTask, &args);
+
+    // właściwe składanie; jednomiany najwyższego poziomu składane są
+    // równolegle, a ich złożenia sumowane drzewiasto
+    Poly poly_ret;
+    if (ThreadPoolSize() > 1 && k > 0 && !PolyIsCoeff(p) && p->size > 1) {
+        args.terms = SafeMalloc(p->size * sizeof(Poly));
+        ThreadPoolRun(p->size, ComposeTermTask, &args);
+        poly_ret = PolyTreeSum(p->size, args.terms);
+        free(args.terms);
+    } else {
+        poly_ret = PolyComposeHelper(p, k, powers, 0);
     }
-
-    // właściwe składanie
-    Poly poly_ret = PolyComposeHelper(p, k, powers, 0);
     for (size_t i = 0; i < k; i++) {
         for (size_t j = 0; j < PowersOfTwo(max_exp[i]); j++)
             PolyDestroy(&powers[i][j]);
@@ -13,6 +13,7 @@
 #include <assert.h>
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 
 /** To jest typ reprezentujący współczynniki. */
 typedef long poly_coeff_t;
@@ -21,21 +22,34 @@ typedef long poly_coeff_t;
 typedef int poly_exp_t;
 
 struct Mono;
+struct BigInt;
+
+/**
+ * Znacznik w polu `arr` wielomianu stałego, którego współczynnik jest liczbą
+ * dowolnej precyzji (zob. @ref BigInt).
+ */
+#define POLY_BIG_ARR ((struct Mono *) 1)
 
 /**
  * To jest struktura przechowująca wielomian.
  * Wielomian jest albo liczbą całkowitą, czyli wielomianem stałym
- * (wtedy `arr == NULL`), albo niepustą listą jednomianów (wtedy `arr != NULL`).
+ * (wtedy `arr == NULL` lub, dla liczby spoza zakresu @ref poly_coeff_t
+ * w trybie dokładnym, `arr == POLY_BIG_ARR`), albo niepustą listą jednomianów.
+ * Tablica jednomianów może być współdzielona przez kilka wielomianów i jest
+ * wtedy niezmienna; funkcje modyfikujące wielomian w miejscu kopiują
+ * tylko te tablice na ścieżce zmiany, które są współdzielone.
  */
 typedef struct Poly {
     /**
     * To jest unia przechowująca współczynnik wielomianu lub
     * liczbę jednomianów w wielomianie.
     * Jeżeli `arr == NULL`, wtedy jest to współczynnik będący liczbą całkowitą.
+    * Jeżeli `arr == POLY_BIG_ARR`, wtedy jest to liczba dowolnej precyzji.
     * W przeciwnym przypadku jest to niepusta lista jednomianów.
     */
     union {
         poly_coeff_t coeff; ///< współczynnik
+        struct BigInt *big; ///< współczynnik dowolnej precyzji
         size_t       size; ///< rozmiar wielomianu, liczba jednomianów
     };
     /** To jest tablica przechowująca listę jednomianów. */
@@ -99,7 +113,16 @@ static inline Mono MonoFromPoly(const Poly *p, poly_exp_t n) {
  * @return Czy wielomian jest współczynnikiem?
  */
 static inline bool PolyIsCoeff(const Poly *p) {
-    return p->arr == NULL;
+    return (uintptr_t) p->arr <= (uintptr_t) POLY_BIG_ARR;
+}
+
+/**
+ * Sprawdza, czy wielomian jest współczynnikiem dowolnej precyzji.
+ * @param[in] p : wielomian
+ * @return Czy współczynnik nie mieści się w typie @ref poly_coeff_t?
+ */
+static inline bool PolyIsBig(const Poly *p) {
+    return p->arr == POLY_BIG_ARR;
 }
 
 /**
@@ -108,11 +131,12 @@ static inline bool PolyIsCoeff(const Poly *p) {
  * @return Czy wielomian jest równy zeru?
  */
 static inline bool PolyIsZero(const Poly *p) {
-    return PolyIsCoeff(p) && p->coeff == 0;
+    return p->arr == NULL && p->coeff == 0;
 }
 
 /**
- * Usuwa wielomian z pamięci.
+ * Usuwa wielomian z pamięci. Jeśli tablica jednomianów jest współdzielona,
+ * zmniejsza jedynie jej licznik odwołań.
  * @param[in] p : wielomian
  */
 void PolyDestroy(Poly *p);
@@ -126,14 +150,15 @@ static inline void MonoDestroy(Mono *m) {
 }
 
 /**
- * Robi pełną, głęboką kopię wielomianu.
+ * Robi kopię wielomianu w czasie stałym. Kopia współdzieli tablicę
+ * jednomianów z @p p, zwiększając jej licznik odwołań.
  * @param[in] p : wielomian
  * @return skopiowany wielomian
  */
 Poly PolyClone(const Poly *p);
 
 /**
- * Robi pełną, głęboką kopię jednomianu.
+ * Robi kopię jednomianu w czasie stałym.
  * @param[in] m : jednomian
  * @return skopiowany jednomian
  */
@@ -159,13 +184,55 @@ Poly PolyAdd(const Poly *p, const Poly *q);
 Poly PolyAddMonos(size_t count, const Mono monos[]);
 
 /**
- * Mnoży dwa wielomiany.
+ * Dodaje w miejscu wielomian @p x do wielomianu @p acc.
+ * Tablica jednomianów @p acc jest powiększana w miejscu (z zamortyzowanym
+ * kosztem), a jej jednomiany nie są kopiowane.
+ * @param[in,out] acc : wielomian @f$acc@f$, po wywołaniu @f$acc + x@f$
+ * @param[in] x : wielomian @f$x@f$
+ */
+void PolyAddTo(Poly *acc, const Poly *x);
+
+/**
+ * Dodaje w miejscu iloczyn wielomianów @p a i @p b do wielomianu @p acc.
+ * Jeśli jeden z czynników jest współczynnikiem, iloczyn nie jest tworzony,
+ * a drugi czynnik przemnożony przez ten współczynnik dodawany jest wprost do
+ * @p acc. W przeciwnym przypadku jednomiany iloczynu przenoszone są do @p acc
+ * bez kopiowania.
+ * @param[in,out] acc : wielomian @f$acc@f$, po wywołaniu @f$acc + a * b@f$
+ * @param[in] a : wielomian @f$a@f$
+ * @param[in] b : wielomian @f$b@f$
+ */
+void PolyMulAddTo(Poly *acc, const Poly *a, const Poly *b);
+
+/**
+ * Mnoży dwa wielomiany. Jeśli uruchomiono pulę wątków (zob.
+ * @ref ThreadPoolInit(size_t threads)), iloczyny dużych wielomianów
+ * wyznaczane są równolegle; wynik jest taki sam jak przy mnożeniu
+ * sekwencyjnym.
  * @param[in] p : wielomian @f$p@f$
  * @param[in] q : wielomian @f$q@f$
  * @return @f$p * q@f$
  */
 Poly PolyMul(const Poly *p, const Poly *q);
 
+/**
+ * Podnosi wielomian do kwadratu. Iloczyn jednomianów o różnych indeksach
+ * wyznaczany jest tylko raz i podwajany.
+ * @param[in] p : wielomian @f$p@f$
+ * @return @f$p^2@f$
+ */
+Poly PolySquare(const Poly *p);
+
+/**
+ * Podnosi wielomian do potęgi. Wielomian o niewielu współczynnikach (np.
+ * dwumian) rozwijany jest ze wzoru wielomianowego, a pozostałe potęgowane są
+ * binarnie za pomocą @ref PolySquare(const Poly *p).
+ * @param[in] p : wielomian @f$p@f$
+ * @param[in] n : wykładnik, nieujemny
+ * @return @f$p^n@f$ (w szczególności @f$p^0 = 1@f$)
+ */
+Poly PolyPow(const Poly *p, poly_exp_t n);
+
 /**
  * Zwraca przeciwny wielomian.
  * @param[in] p : wielomian @f$p@f$
@@ -173,6 +240,15 @@ Poly PolyMul(const Poly *p, const Poly *q);
  */
 Poly PolyNeg(const Poly *p);
 
+/**
+ * Sprowadza współczynniki wielomianu do reszt modulo bieżący moduł
+ * współczynników (zob. @ref CoeffModulusSet(unsigned long p)), pomijając
+ * jednomiany, których współczynniki stały się zerowe.
+ * @param[in] p : wielomian
+ * @return wielomian o zredukowanych współczynnikach
+ */
+Poly PolyReduceCoeffs(const Poly *p);
+
 /**
  * Odejmuje wielomian od wielomianu.
  * @param[in] p : wielomian @f$p@f$
@@ -200,14 +276,86 @@ poly_exp_t PolyDegBy(const Poly *p, size_t var_idx);
  */
 poly_exp_t PolyDeg(const Poly *p);
 
+/**
+ * Liczy niezerowe współczynniki liczbowe w wielomianie, czyli jego jednomiany
+ * po rozwinięciu wszystkich zmiennych.
+ * @param[in] p : wielomian
+ * @return liczba niezerowych współczynników liczbowych
+ */
+size_t PolyTermCount(const Poly *p);
+
+/**
+ * Wyznacza głębokość zagnieżdżenia wielomianu, czyli liczbę zmiennych,
+ * od których zależy.
+ * @param[in] p : wielomian
+ * @return głębokość wielomianu
+ */
+size_t PolyDepth(const Poly *p);
+
+/** Liczba pierwszych zmiennych, dla których zapamiętywane są stopnie. */
+#define POLY_META_VARS 8
+
+/**
+ * To jest struktura opisująca wielomian.
+ * Dla wielomianu, który nie jest stały, jest ona wyznaczana przy pierwszym
+ * użyciu i zapamiętywana w jego tablicy jednomianów razem z opisami
+ * wszystkich jego poddrzew, a usuwana przy zmianie tablicy w miejscu.
+ * Dzięki temu @ref PolyDeg(const Poly *p),
+ * @ref PolyDegBy(const Poly *p, size_t var_idx),
+ * @ref PolyTermCount(const Poly *p) i @ref PolyDepth(const Poly *p) mają
+ * przy kolejnych wywołaniach koszt stały.
+ */
+typedef struct PolyMeta {
+    size_t terms; ///< liczba niezerowych współczynników liczbowych
+    size_t depth; ///< głębokość zagnieżdżenia
+    poly_exp_t deg; ///< stopień wielomianu
+    /** stopnie ze względu na pierwsze @ref POLY_META_VARS zmiennych */
+    poly_exp_t deg_by[POLY_META_VARS];
+} PolyMeta;
+
+/**
+ * Zwraca opis wielomianu.
+ * @param[in] p : wielomian
+ * @return opis wielomianu
+ */
+PolyMeta PolyGetMeta(const Poly *p);
+
+/**
+ * Ustawia opis wielomianu, który nie ma jeszcze żadnych jednomianów.
+ * @param[out] meta : opis wielomianu
+ */
+void PolyMetaInit(PolyMeta *meta);
+
+/**
+ * Uwzględnia w opisie wielomianu jego jednomian. Pozwala wyznaczyć opis
+ * wielomianu na podstawie znanych już opisów jego współczynników.
+ * @param[in,out] meta : opis wielomianu
+ * @param[in] mono : jednomian
+ * @param[in] inner : opis współczynnika jednomianu lub NULL, jeśli
+ * współczynnik jest wielomianem stałym
+ */
+void PolyMetaAddMono(PolyMeta *meta, const Mono *mono, const PolyMeta *inner);
+
 /**
  * Sprawdza równość dwóch wielomianów.
+ * Wielomiany o różnych skrótach (zob. @ref PolyHash(const Poly *p)) są
+ * odrzucane bez porównywania jednomianów.
  * @param[in] p : wielomian @f$p@f$
  * @param[in] q : wielomian @f$q@f$
  * @return @f$p = q@f$
  */
 bool PolyIsEq(const Poly *p, const Poly *q);
 
+/**
+ * Wyznacza skrót struktury wielomianu. Równe wielomiany mają równe skróty,
+ * a skrót nie zależy od platformy ani od rozmieszczenia wielomianu
+ * w pamięci. Skrót wielomianu, który nie jest stały, zapamiętywany jest
+ * w jego tablicy jednomianów, więc kolejne wywołania mają koszt stały.
+ * @param[in] p : wielomian
+ * @return skrót
+ */
+uint64_t PolyHash(const Poly *p);
+
 /**
  * Wylicza wartość wielomianu w punkcie @p x.
  * Wstawia pod pierwszą zmienną wielomianu wartość @p x.
@@ -224,9 +372,24 @@ bool PolyIsEq(const Poly *p, const Poly *q);
  */
 Poly PolyAt(const Poly *p, poly_coeff_t x);
 
+/**
+ * Wstawia pod pierwszą zmienną wielomianu kolejno wartości z tablicy @p xs.
+ * Daje ten sam wynik co @p n wywołań
+ * @ref PolyAt(const Poly *p, poly_coeff_t x), ale przechodzi po jednomianach
+ * @p p tylko raz, wyznaczając potęgi i sumy współczynników dla wszystkich
+ * punktów naraz.
+ * @param[in] p : wielomian @f$p@f$
+ * @param[in] n : liczba punktów
+ * @param[in] xs : tablica @p n wartości argumentu
+ * @param[out] out : tablica @p n wielomianów, w której na pozycji @f$j@f$
+ * zapisywany jest wielomian @f$p(xs_j, x_0, x_1, \ldots)@f$
+ */
+void PolyAtMany(const Poly *p, size_t n, const poly_coeff_t xs[], Poly out[]);
+
 /**
  * Wypisuje wielomian @p p, w taki sposób, że jednomiany są posortowane rosnąco
  * po wykładnikach.
+ * Wielomian trafia do bufora standardowego wyjścia (zob. @ref OutputFlush).
  * @param[in] p : wielomian
  */
 void PolyPrint(const Poly *p);
@@ -245,7 +408,7 @@ Poly PolyOwnMonos(size_t count, Mono *monos);
 
 /**
  * Sumuje listę jednomianów i tworzy z nich wielomian. Nie modyfikuje zawartości
- * tablicy @p monos. Jeśli jest to wymagane, to wykonuje pełne kopie jednomianów
+ * tablicy @p monos. Jeśli jest to wymagane, to wykonuje kopie jednomianów
  * z tablicy @p monos. Jeśli @p count lub @p monos jest równe zeru (NULL),
  * tworzy wielomian tożsamościowo równy zeru.
  * @param[in] count : liczba jednomianów
@@ -259,7 +422,12 @@ Poly PolyCloneMonos(size_t count, const Mono monos[]);
  * Pod pierwsze @p k zmiennych wielomianu @p podstawia kolejne wielomiany
  * z tablicy @p q. Funkcja dla wielomianu @f$ q_i @f$ tworzy tablicę wielomianów
  * @f$ q_i^1, q_i^2, q_i^4, ...@f$, by później móc łatwo wykonywać potęgowanie
- * wielomianów.
+ * wielomianów. Tablice te zapamiętywane są między wywołaniami (zob.
+ * @ref PowerCacheFill(const Poly *q, size_t count, Poly powers[])) i
+ * wydłużane, gdy potrzebna jest wyższa potęga. Jeśli uruchomiono pulę
+ * wątków, tablice potęg różnych wielomianów oraz złożenia jednomianów
+ * najwyższego poziomu @p p wyznaczane są równolegle, a złożenia jednomianów
+ * sumowane są parami.
  * @param[in] p : wielomian
  * @param[in] k : ilość podstawianych wielomianów
  * @param[in] q : tablica podstawianych wielomianów
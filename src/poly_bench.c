@@ -0,0 +1,452 @@
+/** @file
+ * Program mierzący wydajność wybranych algorytmów biblioteki wielomianów.
+ *
+ * @author Jan Kwiatkowski
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include "poly.h"
+#include "big_coeff.h"
+#include "mono_pool.h"
+#include "output.h"
+#include "poly_dense.h"
+#include "poly_ntt.h"
+#include "thread_pool.h"
+#include "utilities.h"
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+/** Minimalny czas pojedynczego pomiaru w sekundach. */
+#define MIN_MEASURE_TIME 0.2
+
+/**
+ * Zwraca bieżący czas w sekundach.
+ * @return czas w sekundach
+ */
+static double Now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec + (double) ts.tv_nsec * 1e-9;
+}
+
+/**
+ * Generator liczb pseudolosowych (xorshift), niezależny od platformy.
+ * @param[in,out] state : stan generatora
+ * @return kolejna liczba pseudolosowa
+ */
+static unsigned long NextRandom(unsigned long *state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+/**
+ * Tworzy wielomian jednej zmiennej o zadanych współczynnikach.
+ * @param[in] coeffs : współczynniki
+ * @param[in] n : liczba współczynników
+ * @return wielomian
+ */
+static Poly PolyFromVector(const poly_coeff_t *coeffs, size_t n) {
+    Mono *monos = SafeMalloc(n * sizeof(Mono));
+    for (size_t i = 0; i < n; i++) {
+        Poly c = PolyFromCoeff(coeffs[i]);
+        monos[i] = MonoFromPoly(&c, (poly_exp_t) i);
+    }
+    return PolyOwnMonos(n, monos);
+}
+
+/**
+ * Porównuje czasy mnożenia gęstych wektorów długości @p n algorytmem
+ * Karatsuby, za pomocą NTT oraz funkcją PolyMul().
+ * @param[in] n : długość mnożonych wektorów
+ */
+static void BenchDenseMul(size_t n) {
+    unsigned long state = 0x9e3779b97f4a7c15UL ^ n;
+    poly_coeff_t *a = SafeMalloc(n * sizeof(poly_coeff_t));
+    poly_coeff_t *b = SafeMalloc(n * sizeof(poly_coeff_t));
+    poly_coeff_t *out = SafeMalloc((2 * n - 1) * sizeof(poly_coeff_t));
+    poly_coeff_t *check = SafeMalloc((2 * n - 1) * sizeof(poly_coeff_t));
+    for (size_t i = 0; i < n; i++) {
+        a[i] = (poly_coeff_t) NextRandom(&state);
+        b[i] = (poly_coeff_t) NextRandom(&state);
+    }
+
+    double times[3];
+    size_t reps = 0;
+    double start = Now();
+    do {
+        KaratsubaMul(a, n, b, n, check);
+        reps++;
+    } while (Now() - start < MIN_MEASURE_TIME);
+    times[0] = (Now() - start) / (double) reps;
+
+    reps = 0;
+    start = Now();
+    do {
+        NttMul(a, n, b, n, out);
+        reps++;
+    } while (Now() - start < MIN_MEASURE_TIME);
+    times[1] = (Now() - start) / (double) reps;
+
+    for (size_t i = 0; i < 2 * n - 1; i++) {
+        if (out[i] != check[i]) {
+            fprintf(stderr, "NTT result differs at %zu\n", i);
+            exit(1);
+        }
+    }
+
+    Poly p = PolyFromVector(a, n);
+    Poly q = PolyFromVector(b, n);
+    reps = 0;
+    start = Now();
+    do {
+        Poly r = PolyMul(&p, &q);
+        PolyDestroy(&r);
+        reps++;
+    } while (Now() - start < MIN_MEASURE_TIME);
+    times[2] = (Now() - start) / (double) reps;
+    PolyDestroy(&p);
+    PolyDestroy(&q);
+
+    printf("%8zu %14.6f %14.6f %14.6f %s\n", n, times[0] * 1e3,
+           times[1] * 1e3, times[2] * 1e3,
+           times[1] < times[0] ? "NTT" : "Karatsuba");
+
+    free(a);
+    free(b);
+    free(out);
+    free(check);
+}
+
+/**
+ * Tworzy rzadki wielomian dwóch zmiennych o @p n jednomianach
+ * i pseudolosowych wykładnikach, dla którego nie opłaca się mnożenie gęste.
+ * @param[in] n : liczba jednomianów
+ * @param[in,out] state : stan generatora liczb pseudolosowych
+ * @return wielomian
+ */
+static Poly SparsePoly(size_t n, unsigned long *state) {
+    Mono *monos = SafeMalloc(n * sizeof(Mono));
+    poly_exp_t exp = 0;
+    for (size_t i = 0; i < n; i++) {
+        exp += 1 + (poly_exp_t) (NextRandom(state) % 100000);
+        Poly c = PolyFromCoeff((poly_coeff_t) NextRandom(state));
+        Mono inner = MonoFromPoly(&c, (poly_exp_t) (NextRandom(state) % 1000));
+        Poly p = PolyAddMonos(1, &inner);
+        monos[i] = MonoFromPoly(&p, exp);
+    }
+    return PolyOwnMonos(n, monos);
+}
+
+/**
+ * Mierzy czas pomnożenia rzadkich wielomianów o @p n jednomianach przy
+ * jednym wątku oraz przy domyślnej liczbie wątków puli.
+ * @param[in] n : liczba jednomianów czynników
+ */
+static void BenchSparseMul(size_t n) {
+    unsigned long state = 0x2545f4914f6cdd1dUL ^ n;
+    Poly p = SparsePoly(n, &state);
+    Poly q = SparsePoly(n, &state);
+
+    double times[2];
+    Poly results[2];
+    for (size_t k = 0; k < 2; k++) {
+        ThreadPoolInit(k == 0 ? 1 : 0);
+        size_t reps = 0;
+        double start = Now();
+        do {
+            if (reps > 0)
+                PolyDestroy(&results[k]);
+            results[k] = PolyMul(&p, &q);
+            reps++;
+        } while (Now() - start < MIN_MEASURE_TIME);
+        times[k] = (Now() - start) / (double) reps;
+    }
+
+    if (!PolyIsEq(&results[0], &results[1])) {
+        fprintf(stderr, "Parallel result differs for n = %zu\n", n);
+        exit(1);
+    }
+
+    printf("%8zu %14.6f %14.6f %8zu\n", n, times[0] * 1e3, times[1] * 1e3,
+           ThreadPoolSize());
+
+    ThreadPoolShutdown();
+    PolyDestroy(&p);
+    PolyDestroy(&q);
+    PolyDestroy(&results[0]);
+    PolyDestroy(&results[1]);
+}
+
+/**
+ * Komparator jednomianów po wykładnikach dla funkcji `qsort`.
+ * @param[in] a : jednomian
+ * @param[in] b : jednomian
+ * @return wynik porównania wykładników
+ */
+static int MonoCompByExp(const void *a, const void *b) {
+    poly_exp_t x = ((const Mono *) a)->exp, y = ((const Mono *) b)->exp;
+    return (x > y) - (x < y);
+}
+
+/**
+ * Porównuje czasy sortowania @p n jednomianów o pseudolosowych wykładnikach
+ * funkcją `qsort` oraz funkcją PolySort().
+ * @param[in] n : liczba jednomianów
+ */
+static void BenchSort(size_t n) {
+    unsigned long state = 0x9e3779b97f4a7c15UL ^ n;
+    Mono *monos = SafeMalloc(n * sizeof(Mono));
+    for (size_t i = 0; i < n; i++) {
+        monos[i].p = PolyZero();
+        monos[i].exp = (poly_exp_t) (NextRandom(&state) % (1UL << 31));
+    }
+
+    Mono *copy = SafeMalloc(n * sizeof(Mono));
+    double times[2];
+    for (size_t k = 0; k < 2; k++) {
+        size_t reps = 0;
+        double start = Now();
+        do {
+            memcpy(copy, monos, n * sizeof(Mono));
+            if (k == 0) {
+                qsort(copy, n, sizeof(Mono), MonoCompByExp);
+            }
+            else {
+                Poly p = {.size = n, .arr = copy};
+                PolySort(&p);
+            }
+            reps++;
+        } while (Now() - start < MIN_MEASURE_TIME);
+        times[k] = (Now() - start) / (double) reps;
+    }
+
+    printf("%8zu %14.6f %14.6f\n", n, times[0] * 1e3, times[1] * 1e3);
+
+    free(monos);
+    free(copy);
+}
+
+/**
+ * Rekurencyjna wersja funkcji PolyDestroy(), punkt odniesienia dla wersji
+ * iteracyjnej.
+ * @param[in] p : wielomian
+ */
+static void RecursiveDestroy(Poly *p) {
+    if (PolyIsBig(p)) {
+        BigUnref(p->big);
+    } else if (!PolyIsCoeff(p) && MonoArrayUnref(p->arr)) {
+        for (size_t i = 0; i < p->size; i++)
+            RecursiveDestroy(&p->arr[i].p);
+        MonoArrayFree(p->arr);
+    }
+}
+
+/**
+ * Rekurencyjna wersja funkcji PolyIsEq() bez skrótów, punkt odniesienia dla
+ * wersji iteracyjnej.
+ * @param[in] p : wielomian
+ * @param[in] q : wielomian
+ * @return czy wielomiany są równe
+ */
+static bool RecursiveIsEq(const Poly *p, const Poly *q) {
+    if (PolyIsCoeff(p) || PolyIsCoeff(q))
+        return PolyIsCoeff(p) && PolyIsCoeff(q) && p->arr == q->arr &&
+               p->coeff == q->coeff;
+    if (p->size != q->size)
+        return false;
+    for (size_t i = 0; i < p->size; i++) {
+        if (p->arr[i].exp != q->arr[i].exp ||
+            !RecursiveIsEq(&p->arr[i].p, &q->arr[i].p))
+            return false;
+    }
+    return true;
+}
+
+/**
+ * Rekurencyjna wersja funkcji PolyPrint(), punkt odniesienia dla wersji
+ * iteracyjnej.
+ * @param[in] p : wielomian
+ */
+static void RecursivePrint(const Poly *p) {
+    if (PolyIsCoeff(p)) {
+        printf("%ld", p->coeff);
+        return;
+    }
+    for (size_t i = 0; i < p->size; i++) {
+        if (i != 0)
+            printf("+");
+        printf("(");
+        RecursivePrint(&p->arr[i].p);
+        printf(",%d)", p->arr[i].exp);
+    }
+}
+
+/**
+ * Tworzy wielomian o @p depth poziomach zagnieżdżenia, na każdym poziomie
+ * z @p width jednomianami, z których tylko ostatni ma niestały
+ * współczynnik.
+ * @param[in] depth : głębokość wielomianu
+ * @param[in] width : liczba jednomianów na każdym poziomie
+ * @return wielomian
+ */
+static Poly DeepPoly(size_t depth, size_t width) {
+    Poly p = PolyFromCoeff(1);
+    for (size_t d = 0; d < depth; d++) {
+        Mono *monos = SafeMalloc(width * sizeof(Mono));
+        for (size_t i = 0; i + 1 < width; i++) {
+            Poly c = PolyFromCoeff((poly_coeff_t) (d + i + 1));
+            monos[i] = MonoFromPoly(&c, (poly_exp_t) i);
+        }
+        monos[width - 1] = MonoFromPoly(&p, (poly_exp_t) width);
+        p = PolyOwnMonos(width, monos);
+    }
+    return p;
+}
+
+/**
+ * Tworzy wielomian o @p depth poziomach zagnieżdżenia, w którym każdy
+ * jednomian, poza najgłębszymi, ma współczynnik z @p width jednomianami.
+ * @param[in] depth : głębokość wielomianu
+ * @param[in] width : liczba jednomianów każdego współczynnika
+ * @return wielomian
+ */
+static Poly WidePoly(size_t depth, size_t width) {
+    if (depth == 0)
+        return PolyFromCoeff(1);
+
+    Mono *monos = SafeMalloc(width * sizeof(Mono));
+    for (size_t i = 0; i < width; i++) {
+        Poly c = WidePoly(depth - 1, width);
+        monos[i] = MonoFromPoly(&c, (poly_exp_t) i);
+    }
+    return PolyOwnMonos(width, monos);
+}
+
+/**
+ * Rodzaj przejścia wielomianu mierzonego w @ref BenchTraversal.
+ */
+typedef enum Traversal {
+    TRAVERSAL_DESTROY, ///< usunięcie wielomianu
+    TRAVERSAL_IS_EQ, ///< porównanie z równym wielomianem
+    TRAVERSAL_PRINT, ///< wypisanie wielomianu do /dev/null
+    TRAVERSAL_COUNT ///< liczba rodzajów przejścia
+} Traversal;
+
+/**
+ * Mierzy średni czas jednego przejścia wielomianu.
+ * @param[in] traversal : rodzaj przejścia
+ * @param[in] recursive : czy użyć wersji rekurencyjnej
+ * @param[in] make : funkcja tworząca wielomian
+ * @param[in] depth : pierwszy parametr funkcji @p make
+ * @param[in] width : drugi parametr funkcji @p make
+ * @return czas w sekundach
+ */
+static double TimeTraversal(Traversal traversal, bool recursive,
+                            Poly (*make)(size_t, size_t), size_t depth,
+                            size_t width) {
+    Poly p = make(depth, width);
+    Poly q = make(depth, width);
+    // pierwsze porównanie wyznacza skróty, mierzymy kolejne
+    if (traversal == TRAVERSAL_IS_EQ && !recursive)
+        PolyIsEq(&p, &q);
+
+    int null_fd = open("/dev/null", O_WRONLY);
+    int stdout_fd = dup(STDOUT_FILENO);
+    fflush(stdout);
+    dup2(null_fd, STDOUT_FILENO);
+
+    double total = 0;
+    size_t reps = 0;
+    do {
+        double start = Now();
+        if (traversal == TRAVERSAL_DESTROY) {
+            if (recursive)
+                RecursiveDestroy(&p);
+            else
+                PolyDestroy(&p);
+            total += Now() - start;
+            p = make(depth, width);
+        } else if (traversal == TRAVERSAL_IS_EQ) {
+            if (!(recursive ? RecursiveIsEq(&p, &q) : PolyIsEq(&p, &q)))
+                exit(1);
+            total += Now() - start;
+        } else {
+            if (recursive)
+                RecursivePrint(&p);
+            else
+                PolyPrint(&p);
+            fflush(stdout);
+            OutputFlush();
+            total += Now() - start;
+        }
+        reps++;
+    } while (total < MIN_MEASURE_TIME);
+
+    dup2(stdout_fd, STDOUT_FILENO);
+    close(null_fd);
+    close(stdout_fd);
+    PolyDestroy(&p);
+    PolyDestroy(&q);
+    return total / (double) reps;
+}
+
+/**
+ * Porównuje czasy przejścia wielomianu przez iteracyjne funkcje biblioteki
+ * oraz przez ich rekurencyjne odpowiedniki: usunięcia, porównania z równym
+ * wielomianem i wypisania.
+ * @param[in] name : nazwa rodzaju wielomianu
+ * @param[in] make : funkcja tworząca wielomian
+ * @param[in] depth : głębokość wielomianu
+ * @param[in] width : drugi parametr funkcji @p make
+ */
+static void BenchTraversal(const char *name, Poly (*make)(size_t, size_t),
+                           size_t depth, size_t width) {
+    printf("%-6s %6zu %6zu", name, depth, width);
+    for (int t = 0; t < TRAVERSAL_COUNT; t++) {
+        printf(" %10.4f", TimeTraversal(t, true, make, depth, width) * 1e3);
+        printf(" %10.4f", TimeTraversal(t, false, make, depth, width) * 1e3);
+    }
+    printf("\n");
+}
+
+/**
+ * Uruchamia pomiary.
+ * @return kod wyjściowy programu
+ */
+int main() {
+    printf("Dense multiplication of two vectors of length n [ms], "
+           "NTT_THRESHOLD = %d\n", NTT_THRESHOLD);
+    printf("%8s %14s %14s %14s %s\n", "n", "Karatsuba", "NTT", "PolyMul",
+           "faster");
+    for (size_t n = 64; n <= 65536; n *= 2)
+        BenchDenseMul(n);
+
+    printf("\nSparse multiplication of two polynomials "
+           "with n monomials [ms]\n");
+    printf("%8s %14s %14s %8s\n", "n", "1 thread", "pool", "threads");
+    for (size_t n = 64; n <= 2048; n *= 2)
+        BenchSparseMul(n);
+
+    printf("\nSorting n monomials by exponent [ms]\n");
+    printf("%8s %14s %14s\n", "n", "qsort", "PolySort");
+    for (size_t n = 16; n <= 262144; n *= 4)
+        BenchSort(n);
+
+    printf("\nTraversal of deep and wide polynomials, recursive vs "
+           "iterative [ms]\n");
+    printf("%-6s %6s %6s %21s %21s %21s\n", "shape", "depth", "width",
+           "destroy", "is_eq", "print");
+    BenchTraversal("deep", DeepPoly, 10000, 1);
+    BenchTraversal("deep", DeepPoly, 10000, 8);
+    BenchTraversal("wide", WidePoly, 3, 100);
+    BenchTraversal("wide", WidePoly, 8, 6);
+
+    return 0;
+}
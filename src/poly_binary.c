@@ -0,0 +1,448 @@
+/** @file
+ * Implementacja modułu odpowiedzialnego za zapis wielomianów w formacie
+ * binarnym.
+ *
+ * @author Jan Kwiatkowski
+ */
+
+#include "poly_binary.h"
+#include "big_coeff.h"
+#include "coeff_mod.h"
+#include "mono_pool.h"
+#include "utilities.h"
+#include <limits.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/** Długość @ref POLY_BINARY_MAGIC w bajtach. */
+#define MAGIC_SIZE 4
+
+/** Długość nagłówka: znacznik, wersja, długość danych i suma kontrolna. */
+#define HEADER_SIZE (MAGIC_SIZE + 1 + 8 + 8)
+
+/** Najmniejsza pojemność bufora zapisu w bajtach. */
+#define BUFFER_MIN_CAPACITY 256
+
+/** Największa porcja danych przydzielana z góry przy odczycie. */
+#define READ_CHUNK_SIZE ((size_t) 1 << 20)
+
+/** Wartość @f$h@f$ węzła będącego współczynnikiem typu poly_coeff_t. */
+#define NODE_COEFF 0
+
+/** Wartość @f$h@f$ węzła będącego współczynnikiem dowolnej precyzji. */
+#define NODE_BIG 1
+
+/** Najmniejsza liczba bajtów zapisu jednomianu: wykładnik i węzeł. */
+#define MIN_MONO_SIZE 2
+
+/**
+ * Bufor bajtów zapisu wielomianu.
+ */
+typedef struct ByteBuffer {
+    uint8_t *data; ///< bajty
+    size_t size; ///< liczba zapisanych bajtów
+    size_t capacity; ///< pojemność bufora
+} ByteBuffer;
+
+/**
+ * Zapewnia miejsce na kolejne bajty w buforze.
+ * @param[in,out] buffer : bufor
+ * @param[in] n : liczba bajtów
+ */
+static void BufferReserve(ByteBuffer *buffer, size_t n) {
+    if (buffer->capacity - buffer->size >= n)
+        return;
+    while (buffer->capacity - buffer->size < n)
+        buffer->capacity = buffer->capacity < BUFFER_MIN_CAPACITY ?
+                           BUFFER_MIN_CAPACITY : 2 * buffer->capacity;
+    buffer->data = SafeRealloc(buffer->data, buffer->capacity);
+}
+
+/**
+ * Dopisuje do bufora liczbę w kodzie o zmiennej długości.
+ * @param[in,out] buffer : bufor
+ * @param[in] value : liczba
+ */
+static void BufferVarint(ByteBuffer *buffer, uint64_t value) {
+    BufferReserve(buffer, 10);
+    uint8_t *out = buffer->data + buffer->size;
+    while (value >= 0x80) {
+        *out++ = (uint8_t) (value | 0x80);
+        value >>= 7;
+    }
+    *out++ = (uint8_t) value;
+    buffer->size = (size_t) (out - buffer->data);
+}
+
+/**
+ * Zapisuje liczbę na ośmiu bajtach od najmniej znaczącego.
+ * @param[out] out : miejsce zapisu
+ * @param[in] value : liczba
+ */
+static void StoreWord(uint8_t *out, uint64_t value) {
+    for (int i = 0; i < 8; i++)
+        out[i] = (uint8_t) (value >> (8 * i));
+}
+
+/**
+ * Odczytuje liczbę zapisaną na ośmiu bajtach od najmniej znaczącego.
+ * @param[in] in : miejsce zapisu
+ * @return liczba
+ */
+static uint64_t LoadWord(const uint8_t *in) {
+    uint64_t value = 0;
+    for (int i = 0; i < 8; i++)
+        value |= (uint64_t) in[i] << (8 * i);
+    return value;
+}
+
+/**
+ * Wyznacza sumę kontrolną danych, przetwarzając je po osiem bajtów.
+ * @param[in] data : dane
+ * @param[in] size : liczba bajtów
+ * @return suma kontrolna
+ */
+static uint64_t Checksum(const uint8_t *data, size_t size) {
+    uint64_t sum = 0x9e3779b97f4a7c15UL ^ size;
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        sum ^= LoadWord(data + i) * 0xff51afd7ed558ccdUL;
+        sum = ((sum << 31) | (sum >> 33)) * 0xc4ceb9fe1a85ec53UL;
+    }
+
+    uint64_t tail = 0;
+    for (size_t j = 0; i + j < size; j++)
+        tail |= (uint64_t) data[i + j] << (8 * j);
+    sum ^= tail * 0xff51afd7ed558ccdUL;
+
+    sum ^= sum >> 33;
+    sum *= 0xff51afd7ed558ccdUL;
+    sum ^= sum >> 33;
+    return sum;
+}
+
+/**
+ * Dopisuje do bufora węzeł wielomianu stałego.
+ * @param[in,out] buffer : bufor
+ * @param[in] p : wielomian stały
+ */
+static void BufferCoeff(ByteBuffer *buffer, const Poly *p) {
+    if (!PolyIsBig(p)) {
+        uint64_t c = (uint64_t) p->coeff;
+        BufferVarint(buffer, NODE_COEFF);
+        BufferVarint(buffer, (c << 1) ^ (0 - (c >> 63)));
+        return;
+    }
+
+    const BigInt *big = p->big;
+    BufferVarint(buffer, NODE_BIG);
+    BufferVarint(buffer, 2 * (uint64_t) big->size + big->negative);
+    BufferReserve(buffer, 8 * big->size);
+    for (size_t i = 0; i < big->size; i++)
+        StoreWord(buffer->data + buffer->size + 8 * i, big->limbs[i]);
+    buffer->size += 8 * big->size;
+}
+
+/**
+ * Wielomian zapisywany przez @ref PolyWriteBinary.
+ */
+typedef struct WriteFrame {
+    const Poly *p; ///< wielomian
+    size_t i; ///< indeks kolejnego jednomianu do zapisania
+} WriteFrame;
+
+/**
+ * Dopisuje do bufora dane wielomianu, czyli jego drzewo w kolejności
+ * prefiksowej.
+ * @param[in,out] buffer : bufor
+ * @param[in] p : wielomian
+ */
+static void BufferPoly(ByteBuffer *buffer, const Poly *p) {
+    if (PolyIsCoeff(p)) {
+        BufferCoeff(buffer, p);
+        return;
+    }
+
+    WriteFrame local[WORK_STACK_LOCAL];
+    WriteFrame *stack = local;
+    size_t capacity = WORK_STACK_LOCAL, top = 0;
+    BufferVarint(buffer, (uint64_t) p->size + 1);
+    stack[top++] = (WriteFrame) {.p = p, .i = 0};
+
+    while (top > 0) {
+        WriteFrame *frame = &stack[top - 1];
+        if (frame->i == frame->p->size) {
+            top--;
+            continue;
+        }
+
+        const Mono *mono = &frame->p->arr[frame->i];
+        poly_exp_t gap = frame->i == 0 ? mono->exp :
+                         mono->exp - frame->p->arr[frame->i - 1].exp - 1;
+        BufferVarint(buffer, (uint64_t) gap);
+        frame->i++;
+
+        if (PolyIsCoeff(&mono->p)) {
+            BufferCoeff(buffer, &mono->p);
+        } else {
+            BufferVarint(buffer, (uint64_t) mono->p.size + 1);
+            if (top == capacity)
+                stack = WorkStackGrow(stack, local, &capacity,
+                                      sizeof(WriteFrame));
+            stack[top++] = (WriteFrame) {.p = &mono->p, .i = 0};
+        }
+    }
+
+    if (stack != local)
+        free(stack);
+}
+
+bool PolyWriteBinary(const Poly *p, FILE *file) {
+    ByteBuffer buffer = {.data = NULL, .size = 0, .capacity = 0};
+    BufferReserve(&buffer, HEADER_SIZE);
+    buffer.size = HEADER_SIZE;
+    BufferPoly(&buffer, p);
+
+    const uint8_t *payload = buffer.data + HEADER_SIZE;
+    size_t payload_size = buffer.size - HEADER_SIZE;
+    memcpy(buffer.data, POLY_BINARY_MAGIC, MAGIC_SIZE);
+    buffer.data[MAGIC_SIZE] = POLY_BINARY_VERSION;
+    StoreWord(buffer.data + MAGIC_SIZE + 1, payload_size);
+    StoreWord(buffer.data + MAGIC_SIZE + 9, Checksum(payload, payload_size));
+
+    bool written = fwrite(buffer.data, 1, buffer.size, file) == buffer.size;
+    free(buffer.data);
+    return written;
+}
+
+/**
+ * Dane odczytywane przez @ref PolyReadBinary.
+ */
+typedef struct Reader {
+    const uint8_t *pos; ///< pierwszy nieodczytany bajt
+    const uint8_t *end; ///< koniec danych
+} Reader;
+
+/**
+ * Odczytuje liczbę zapisaną w kodzie o zmiennej długości.
+ * @param[in,out] reader : dane
+ * @param[out] value : liczba
+ * @return czy liczba jest poprawna
+ */
+static bool ReadVarint(Reader *reader, uint64_t *value) {
+    uint64_t ret = 0;
+    for (unsigned shift = 0; shift < 64; shift += 7) {
+        if (reader->pos == reader->end)
+            return false;
+        uint8_t byte = *reader->pos++;
+        // ostatni bajt liczby 64-bitowej ma tylko jeden znaczący bit
+        if (shift == 63 && byte > 1)
+            return false;
+        ret |= (uint64_t) (byte & 0x7f) << shift;
+        if (byte < 0x80) {
+            *value = ret;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Odczytuje współczynnik dowolnej precyzji i sprowadza go do bieżącej
+ * arytmetyki.
+ * @param[in,out] reader : dane
+ * @param[out] coeff : współczynnik
+ * @return czy zapis współczynnika jest poprawny
+ */
+static bool ReadBig(Reader *reader, Poly *coeff) {
+    uint64_t header;
+    if (!ReadVarint(reader, &header) ||
+        header / 2 > (uint64_t) (reader->end - reader->pos) / 8)
+        return false;
+
+    size_t size = (size_t) (header / 2);
+    uint64_t *limbs = SafeMalloc((size + 1) * sizeof(uint64_t));
+    for (size_t i = 0; i < size; i++)
+        limbs[i] = LoadWord(reader->pos + 8 * i);
+    reader->pos += 8 * size;
+
+    Poly big = BigCoeffFromLimbs(limbs, size, header % 2 == 1);
+    free(limbs);
+    *coeff = CoeffPolyReduce(&big);
+    PolyDestroy(&big);
+    return true;
+}
+
+/**
+ * Wielomian odczytywany przez @ref PolyReadBinary.
+ */
+typedef struct ReadFrame {
+    Mono *arr; ///< docelowa tablica jednomianów
+    size_t size; ///< liczba jednomianów w tablicy
+    size_t left; ///< liczba jednomianów do odczytania
+    uint64_t exp; ///< wykładnik ostatnio odczytanego jednomianu
+} ReadFrame;
+
+/**
+ * Kończy odczyt wielomianu. Jednomiany, których współczynniki stały się
+ * zerami po sprowadzeniu do bieżącej arytmetyki, zostały już pominięte.
+ * @param[in] frame : odczytany wielomian
+ * @return wielomian w postaci, w jakiej przechowuje go biblioteka
+ */
+static Poly ReadFrameFinish(const ReadFrame *frame) {
+    if (frame->size == 0) {
+        MonoArrayFree(frame->arr);
+        return PolyZero();
+    }
+    if (frame->size == 1 && frame->arr[0].exp == 0 &&
+        PolyIsCoeff(&frame->arr[0].p)) {
+        Poly coeff = frame->arr[0].p;
+        MonoArrayFree(frame->arr);
+        return coeff;
+    }
+    return (Poly) {.size = frame->size, .arr = frame->arr};
+}
+
+/**
+ * Odtwarza wielomian z danych, tworząc od razu docelowe tablice jednomianów.
+ * @param[in,out] reader : dane
+ * @param[out] p : wielomian
+ * @return czy dane są poprawnym zapisem wielomianu
+ */
+static bool ReadPoly(Reader *reader, Poly *p) {
+    ReadFrame local[WORK_STACK_LOCAL];
+    ReadFrame *stack = local;
+    size_t capacity = WORK_STACK_LOCAL, top = 0;
+    bool correct = false;
+
+    while (true) {
+        // jednomian wielomianu z wierzchołka stosu zaczyna się wykładnikiem;
+        // przed pierwszym jednomianem exp == UINT64_MAX, więc exp + 1 == 0
+        if (top > 0) {
+            ReadFrame *frame = &stack[top - 1];
+            uint64_t gap;
+            if (!ReadVarint(reader, &gap) || gap > (uint64_t) INT_MAX ||
+                frame->exp + 1 + gap > (uint64_t) INT_MAX)
+                break;
+            frame->exp += 1 + gap;
+            frame->left--;
+        }
+
+        uint64_t h;
+        if (!ReadVarint(reader, &h))
+            break;
+
+        Poly node;
+        if (h == NODE_COEFF) {
+            uint64_t z;
+            if (!ReadVarint(reader, &z))
+                break;
+            node = PolyFromCoeff(CoeffReduce((poly_coeff_t) ((z >> 1) ^
+                                                             (0 - (z & 1)))));
+        } else if (h == NODE_BIG) {
+            if (!ReadBig(reader, &node))
+                break;
+        } else {
+            // każdy jednomian zajmuje co najmniej MIN_MONO_SIZE bajtów, więc
+            // uszkodzone dane nie powodują przydzielenia dużej tablicy
+            uint64_t n = h - 1;
+            if (n > (uint64_t) (reader->end - reader->pos) / MIN_MONO_SIZE)
+                break;
+            if (top == capacity)
+                stack = WorkStackGrow(stack, local, &capacity,
+                                      sizeof(ReadFrame));
+            stack[top++] = (ReadFrame) {.arr = MonoArrayAlloc((size_t) n),
+                                        .size = 0, .left = (size_t) n,
+                                        .exp = UINT64_MAX};
+            continue;
+        }
+
+        // odczytany węzeł jest współczynnikiem jednomianu rodzica; kończymy
+        // wielomiany, dopóki któryś nie ma kolejnych jednomianów
+        while (top > 0) {
+            ReadFrame *frame = &stack[top - 1];
+            if (!PolyIsZero(&node))
+                frame->arr[frame->size++] =
+                    (Mono) {.p = node, .exp = (poly_exp_t) frame->exp};
+            if (frame->left > 0)
+                break;
+            node = ReadFrameFinish(frame);
+            top--;
+        }
+
+        if (top == 0) {
+            *p = node;
+            correct = true;
+            break;
+        }
+    }
+
+    for (size_t f = 0; f < top; f++) {
+        for (size_t i = 0; i < stack[f].size; i++)
+            MonoDestroy(&stack[f].arr[i]);
+        MonoArrayFree(stack[f].arr);
+    }
+    if (stack != local)
+        free(stack);
+    return correct;
+}
+
+/**
+ * Odczytuje z pliku dokładnie @p size bajtów danych. Pamięć przydzielana
+ * jest porcjami, więc uszkodzona długość w nagłówku nie powoduje
+ * przydzielenia dużego bloku.
+ * @param[in,out] file : plik
+ * @param[in] size : liczba bajtów
+ * @return dane przydzielone funkcją malloc() lub NULL, jeśli plik jest
+ * krótszy
+ */
+static uint8_t* ReadPayload(FILE *file, uint64_t size) {
+    size_t capacity = size < READ_CHUNK_SIZE ? (size_t) size : READ_CHUNK_SIZE;
+    uint8_t *data = SafeMalloc(capacity);
+    size_t read = 0;
+    while (read < size) {
+        if (read == capacity) {
+            capacity = size - capacity < capacity ? (size_t) size :
+                       2 * capacity;
+            data = SafeRealloc(data, capacity);
+        }
+        size_t n = fread(data + read, 1, capacity - read, file);
+        if (n == 0) {
+            free(data);
+            return NULL;
+        }
+        read += n;
+    }
+    return data;
+}
+
+bool PolyReadBinary(FILE *file, Poly *p) {
+    uint8_t header[HEADER_SIZE];
+    if (fread(header, 1, HEADER_SIZE, file) != HEADER_SIZE ||
+        memcmp(header, POLY_BINARY_MAGIC, MAGIC_SIZE) != 0 ||
+        header[MAGIC_SIZE] != POLY_BINARY_VERSION)
+        return false;
+
+    uint64_t size = LoadWord(header + MAGIC_SIZE + 1);
+    if (size == 0)
+        return false;
+    uint8_t *data = ReadPayload(file, size);
+    if (data == NULL)
+        return false;
+
+    Reader reader = {.pos = data, .end = data + size};
+    Poly poly;
+    bool correct = Checksum(data, (size_t) size) ==
+                   LoadWord(header + MAGIC_SIZE + 9) &&
+                   ReadPoly(&reader, &poly);
+    free(data);
+
+    if (correct && reader.pos != reader.end) {
+        PolyDestroy(&poly);
+        correct = false;
+    }
+    if (correct)
+        *p = poly;
+    return correct;
+}
@@ -0,0 +1,63 @@
+/** @file
+ * Interfejs modułu odpowiedzialnego za zapis wielomianów w formacie
+ * binarnym.
+ * Zapis wielomianu składa się z nagłówka i danych. Nagłówek zawiera
+ * @ref POLY_BINARY_MAGIC, numer wersji formatu (@ref POLY_BINARY_VERSION),
+ * długość danych w bajtach oraz ich sumę kontrolną; liczby zapisane są na
+ * ośmiu bajtach od najmniej znaczącego.
+ * Dane to drzewo wielomianu w kolejności prefiksowej. Każdy węzeł zaczyna
+ * się liczbą @f$h@f$:
+ * - @f$h = 0@f$: współczynnik typu @ref poly_coeff_t, zapisany w kodzie
+ *   zig-zag (@f$0, -1, 1, -2, \ldots@f$ jako @f$0, 1, 2, 3, \ldots@f$);
+ * - @f$h = 1@f$: współczynnik dowolnej precyzji (zob. @ref BigInt): liczba
+ *   @f$2s + z@f$, gdzie @f$s@f$ to liczba słów modułu, a @f$z@f$ to znak,
+ *   po której następuje @f$s@f$ słów na ośmiu bajtach od najmniej
+ *   znaczącego;
+ * - @f$h = n + 1 \geq 2@f$: wielomian o @f$n@f$ jednomianach, po którym
+ *   następują jednomiany w kolejności rosnących wykładników, każdy jako
+ *   różnica wykładników (pierwszy wykładnik, a dalej różnica z poprzednim
+ *   pomniejszona o 1) i węzeł współczynnika.
+ *
+ * Liczby w danych, poza słowami modułu, zapisane są w kodzie o zmiennej
+ * długości: po 7 bitów w bajcie, od najmniej znaczących, z najstarszym bitem
+ * ustawionym we wszystkich bajtach poza ostatnim.
+ * Odczyt tworzy od razu docelowe tablice jednomianów, bez sortowania,
+ * i odrzuca dane, które nie są zapisem wielomianu w postaci, w jakiej
+ * przechowuje go biblioteka.
+ *
+ * @author Jan Kwiatkowski
+ */
+
+#ifndef POLYNOMIALS_POLY_BINARY_H
+#define POLYNOMIALS_POLY_BINARY_H
+
+#include "poly.h"
+#include <stdio.h>
+
+/** Pierwsze bajty zapisu wielomianu. */
+#define POLY_BINARY_MAGIC "PLYB"
+
+/** Wersja formatu zapisu. */
+#define POLY_BINARY_VERSION 1
+
+/**
+ * Zapisuje wielomian w formacie binarnym w bieżącym miejscu pliku.
+ * @param[in] p : wielomian
+ * @param[in,out] file : plik otwarty do zapisu
+ * @return czy udało się zapisać wielomian
+ */
+bool PolyWriteBinary(const Poly *p, FILE *file);
+
+/**
+ * Odczytuje wielomian zapisany w formacie binarnym od bieżącego miejsca
+ * pliku. Współczynniki sprowadzane są do bieżącej arytmetyki (zob.
+ * @ref PolyReduceCoeffs(const Poly *p)).
+ * @param[in,out] file : plik otwarty do odczytu
+ * @param[out] p : odczytany wielomian; nie jest zmieniany, jeśli odczyt się
+ * nie powiódł
+ * @return czy w pliku jest poprawny zapis wielomianu w bieżącej wersji
+ * formatu
+ */
+bool PolyReadBinary(FILE *file, Poly *p);
+
+#endif //POLYNOMIALS_POLY_BINARY_H
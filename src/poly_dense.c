@@ -0,0 +1,328 @@
+/** @file
+ * Implementacja modułu odpowiedzialnego za mnożenie wielomianów
+ * w reprezentacji gęstej.
+ * Obliczenia na gęstych wektorach wykonywane są na liczbach bez znaku, dzięki
+ * czemu przepełnienia dają ten sam wynik modulo @f$2^{64}@f$ co arytmetyka
+ * na typie @ref poly_coeff_t, a tożsamości wykorzystywane w algorytmie
+ * Karatsuby pozostają prawdziwe.
+ *
+ * @author Jan Kwiatkowski
+ */
+
+#include "poly_dense.h"
+#include "coeff_mod.h"
+#include "poly_ntt.h"
+#include "utilities.h"
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+/**
+ * Szacowany koszt wyznaczenia iloczynu pary niezerowych współczynników
+ * w mnożeniu rzadkim, wyrażony w kosztach jednej operacji na gęstym wektorze.
+ */
+#define SPARSE_TERM_COST 16.0
+
+/**
+ * Szacowany koszt przetworzenia jednej pozycji gęstego wektora podczas
+ * pakowania i rozpakowywania wielomianów.
+ */
+#define PACK_COST 4.0
+
+/** Typ, w którym wykonywana jest arytmetyka na gęstych wektorach. */
+typedef unsigned long dense_word_t;
+
+/**
+ * Struktura opisująca podstawienie Kroneckera dla pary mnożonych wielomianów.
+ * Zmienna o indeksie @f$v@f$ zamieniana jest na @f$x^{s_v}@f$, gdzie
+ * @f$s_v@f$ jest iloczynem ograniczeń na wykładniki poprzednich zmiennych.
+ */
+typedef struct Kronecker {
+    size_t vars; ///< liczba zmiennych
+    size_t deg[DENSE_MAX_VARS]; ///< stopnie iloczynu ze względu na zmienne
+    size_t stride[DENSE_MAX_VARS]; ///< kroki odpowiadające zmiennym
+    size_t length; ///< długość gęstego wektora iloczynu
+} Kronecker;
+
+/**
+ * Dodaje do @p out iloczyn wektorów @p a i @p b, wyznaczony algorytmem
+ * szkolnym.
+ * @param[in] a : pierwszy czynnik
+ * @param[in] n : długość @p a
+ * @param[in] b : drugi czynnik
+ * @param[in] m : długość @p b
+ * @param[in,out] out : tablica długości @p n + @p m - 1
+ */
+static void SchoolbookMulAdd(const dense_word_t *a, size_t n,
+                             const dense_word_t *b, size_t m,
+                             dense_word_t *out) {
+    for (size_t i = 0; i < n; i++) {
+        dense_word_t a_i = a[i];
+        if (a_i == 0)
+            continue;
+        for (size_t j = 0; j < m; j++)
+            out[i + j] += a_i * b[j];
+    }
+}
+
+static void DenseMulAdd(const dense_word_t *a, size_t n,
+                        const dense_word_t *b, size_t m, dense_word_t *out);
+
+/**
+ * Dodaje do @p out iloczyn wektorów @p a i @p b równej długości, wyznaczony
+ * algorytmem Karatsuby.
+ * @param[in] a : pierwszy czynnik
+ * @param[in] b : drugi czynnik
+ * @param[in] n : długość obu czynników
+ * @param[in,out] out : tablica długości 2 * @p n - 1
+ */
+static void KaratsubaMulAdd(const dense_word_t *a, const dense_word_t *b,
+                            size_t n, dense_word_t *out) {
+    if (n < KARATSUBA_THRESHOLD) {
+        SchoolbookMulAdd(a, n, b, n, out);
+        return;
+    }
+
+    // a = a0 + a1 x^h, b = b0 + b1 x^h, gdzie a0, b0 mają długość h,
+    // a a1, b1 mają długość k >= h
+    size_t h = n / 2;
+    size_t k = n - h;
+
+    dense_word_t *buf = SafeCalloc(8 * k, sizeof(dense_word_t));
+    dense_word_t *z0 = buf;
+    dense_word_t *z1 = z0 + 2 * k;
+    dense_word_t *z2 = z1 + 2 * k;
+    dense_word_t *sa = z2 + 2 * k;
+    dense_word_t *sb = sa + k;
+
+    // a * b = z0 + (z1 - z0 - z2) x^h + z2 x^2h,
+    // gdzie z0 = a0 * b0, z2 = a1 * b1, z1 = (a0 + a1) * (b0 + b1)
+    KaratsubaMulAdd(a, b, h, z0);
+    KaratsubaMulAdd(a + h, b + h, k, z2);
+
+    for (size_t i = 0; i < 2 * k - 1; i++)
+        out[2 * h + i] += z2[i];
+    for (size_t i = 0; i < 2 * h - 1; i++)
+        out[i] += z0[i];
+    for (size_t i = 0; i < 2 * k - 1; i++)
+        z1[i] -= z2[i];
+    for (size_t i = 0; i < 2 * h - 1; i++)
+        z1[i] -= z0[i];
+
+    for (size_t i = 0; i < k; i++) {
+        sa[i] = a[h + i] + (i < h ? a[i] : 0);
+        sb[i] = b[h + i] + (i < h ? b[i] : 0);
+    }
+    KaratsubaMulAdd(sa, sb, k, z1);
+
+    for (size_t i = 0; i < 2 * k - 1; i++)
+        out[h + i] += z1[i];
+
+    free(buf);
+}
+
+/**
+ * Dodaje do @p out iloczyn wektorów @p a i @p b dowolnych długości.
+ * Dłuższy z czynników dzielony jest na fragmenty o długości krótszego.
+ * @param[in] a : pierwszy czynnik
+ * @param[in] n : długość @p a
+ * @param[in] b : drugi czynnik
+ * @param[in] m : długość @p b
+ * @param[in,out] out : tablica długości @p n + @p m - 1
+ */
+static void DenseMulAdd(const dense_word_t *a, size_t n,
+                        const dense_word_t *b, size_t m, dense_word_t *out) {
+    if (n > m) {
+        DenseMulAdd(b, m, a, n, out);
+        return;
+    }
+
+    if (n < KARATSUBA_THRESHOLD) {
+        SchoolbookMulAdd(a, n, b, m, out);
+        return;
+    }
+
+    for (size_t offset = 0; offset < m; offset += n) {
+        if (m - offset >= n)
+            KaratsubaMulAdd(a, b + offset, n, out + offset);
+        else
+            DenseMulAdd(b + offset, m - offset, a, n, out + offset);
+    }
+}
+
+void KaratsubaMul(const poly_coeff_t a[], size_t n, const poly_coeff_t b[],
+                  size_t m, poly_coeff_t out[]) {
+    assert(n > 0 && m > 0);
+    memset(out, 0, (n + m - 1) * sizeof(poly_coeff_t));
+    DenseMulAdd((const dense_word_t *) a, n, (const dense_word_t *) b, m,
+                (dense_word_t *) out);
+}
+
+void DenseMul(const poly_coeff_t a[], size_t n, const poly_coeff_t b[],
+              size_t m, poly_coeff_t out[]) {
+    if (n >= NTT_THRESHOLD && m >= NTT_THRESHOLD)
+        NttMul(a, n, b, m, out);
+    else
+        KaratsubaMul(a, n, b, m, out);
+}
+
+/**
+ * Szacuje koszt mnożenia gęstych wektorów o zadanych długościach.
+ * @param[in] n : długość pierwszego wektora
+ * @param[in] m : długość drugiego wektora
+ * @return szacowana liczba operacji
+ */
+static double DenseMulCost(size_t n, size_t m) {
+    if (n > m)
+        return DenseMulCost(m, n);
+    if (n >= NTT_THRESHOLD)
+        return NttMulCost(n + m - 1);
+    if (n < KARATSUBA_THRESHOLD)
+        return (double) n * (double) m;
+
+    double karatsuba = (double) n * (double) n;
+    for (size_t k = n; k >= KARATSUBA_THRESHOLD; k = (k + 1) / 2)
+        karatsuba *= 0.75;
+
+    return karatsuba * (double) ((m + n - 1) / n);
+}
+
+/**
+ * Wyznacza długość gęstego wektora wielomianu po podstawieniu Kroneckera.
+ * @param[in] k : podstawienie Kroneckera
+ * @param[in] p : wielomian
+ * @return długość gęstego wektora
+ */
+static size_t KroneckerLength(const Kronecker *k, const Poly *p) {
+    size_t ret = 1;
+    for (size_t v = 0; v < k->vars; v++)
+        ret += (size_t) PolyDegBy(p, v) * k->stride[v];
+    return ret;
+}
+
+/**
+ * Zapisuje współczynniki wielomianu w gęstym wektorze.
+ * @param[in] k : podstawienie Kroneckera
+ * @param[in] p : wielomian
+ * @param[in] offset : pozycja odpowiadająca dotychczas wybranym wykładnikom
+ * @param[in] depth : indeks zmiennej głównej wielomianu @p p
+ * @param[in,out] vec : wyzerowany gęsty wektor
+ */
+static void KroneckerPack(const Kronecker *k, const Poly *p, size_t offset,
+                          size_t depth, dense_word_t *vec) {
+    if (PolyIsCoeff(p)) {
+        vec[offset] = (dense_word_t) p->coeff;
+        return;
+    }
+
+    assert(depth < k->vars);
+    for (size_t i = 0; i < p->size; i++) {
+        KroneckerPack(k, &p->arr[i].p,
+                      offset + (size_t) p->arr[i].exp * k->stride[depth],
+                      depth + 1, vec);
+    }
+}
+
+/**
+ * Odtwarza wielomian z gęstego wektora.
+ * @param[in] k : podstawienie Kroneckera
+ * @param[in] vec : gęsty wektor
+ * @param[in] offset : pozycja odpowiadająca dotychczas wybranym wykładnikom
+ * @param[in] depth : indeks zmiennej głównej odtwarzanego wielomianu
+ * @param[in] buffers : tablice pomocnicze na jednomiany dla kolejnych zmiennych
+ * @return odtworzony wielomian
+ */
+static Poly KroneckerUnpack(const Kronecker *k, const dense_word_t *vec,
+                            size_t offset, size_t depth, Mono **buffers) {
+    if (depth >= k->vars || depth >= DENSE_MAX_VARS)
+        return PolyFromCoeff((poly_coeff_t) vec[offset]);
+
+    Mono *monos = buffers[depth];
+    size_t count = 0;
+    for (size_t e = 0; e <= k->deg[depth]; e++) {
+        Poly poly = KroneckerUnpack(k, vec, offset + e * k->stride[depth],
+                                    depth + 1, buffers);
+        if (!PolyIsZero(&poly))
+            monos[count++] = (Mono) {.p = poly, .exp = (poly_exp_t) e};
+    }
+
+    if (count == 0)
+        return PolyZero();
+    if (count == 1 && monos[0].exp == 0 && PolyIsCoeff(&monos[0].p))
+        return monos[0].p;
+
+    Poly poly_ret = CreateNotCoeffPoly(count);
+    memcpy(poly_ret.arr, monos, count * sizeof(Mono));
+    return poly_ret;
+}
+
+/**
+ * Wyznacza podstawienie Kroneckera dla pary wielomianów.
+ * @param[in] p : wielomian @f$p@f$
+ * @param[in] q : wielomian @f$q@f$
+ * @param[out] k : podstawienie Kroneckera
+ * @return czy podstawienie mieści się w ograniczeniach na liczbę zmiennych
+ * i długość wektora
+ */
+static bool KroneckerInit(const Poly *p, const Poly *q, Kronecker *k) {
+    size_t depth_p = PolyDepth(p);
+    size_t depth_q = PolyDepth(q);
+    k->vars = depth_p > depth_q ? depth_p : depth_q;
+    if (k->vars > DENSE_MAX_VARS)
+        return false;
+
+    k->length = 1;
+    for (size_t v = 0; v < k->vars; v++) {
+        k->deg[v] = (size_t) PolyDegBy(p, v) + (size_t) PolyDegBy(q, v);
+        k->stride[v] = k->length;
+        if (k->deg[v] >= DENSE_MAX_LENGTH / k->length)
+            return false;
+        k->length *= k->deg[v] + 1;
+    }
+
+    return k->length <= DENSE_MAX_LENGTH;
+}
+
+bool PolyMulDense(const Poly *p, const Poly *q, Poly *result) {
+    assert(!PolyIsCoeff(p) && !PolyIsCoeff(q));
+
+    // algorytmy gęste liczą modulo 2^64
+    if (CoeffModActive() || CoeffExactActive())
+        return false;
+
+    Kronecker k;
+    if (!KroneckerInit(p, q, &k))
+        return false;
+
+    size_t length_p = KroneckerLength(&k, p);
+    size_t length_q = KroneckerLength(&k, q);
+    double dense_cost = DenseMulCost(length_p, length_q) +
+                        PACK_COST * (double) k.length;
+    double sparse_cost = SPARSE_TERM_COST * (double) PolyTermCount(p) *
+                         (double) PolyTermCount(q);
+    if (dense_cost >= sparse_cost)
+        return false;
+
+    dense_word_t *vec_p = SafeCalloc(length_p, sizeof(dense_word_t));
+    dense_word_t *vec_q = SafeCalloc(length_q, sizeof(dense_word_t));
+    dense_word_t *vec_ret = SafeMalloc(k.length * sizeof(dense_word_t));
+
+    KroneckerPack(&k, p, 0, 0, vec_p);
+    KroneckerPack(&k, q, 0, 0, vec_q);
+    DenseMul((const poly_coeff_t *) vec_p, length_p,
+             (const poly_coeff_t *) vec_q, length_q, (poly_coeff_t *) vec_ret);
+
+    Mono *buffers[DENSE_MAX_VARS];
+    for (size_t v = 0; v < k.vars; v++)
+        buffers[v] = SafeMalloc((k.deg[v] + 1) * sizeof(Mono));
+
+    *result = KroneckerUnpack(&k, vec_ret, 0, 0, buffers);
+
+    for (size_t v = 0; v < k.vars; v++)
+        free(buffers[v]);
+    free(vec_p);
+    free(vec_q);
+    free(vec_ret);
+
+    return true;
+}
@@ -0,0 +1,75 @@
+/** @file
+ * Interfejs modułu odpowiedzialnego za mnożenie wielomianów w reprezentacji
+ * gęstej.
+ * Wielomian kilku zmiennych zamieniany jest za pomocą podstawienia Kroneckera
+ * na gęsty wektor współczynników wielomianu jednej zmiennej. Wektory mnożone
+ * są algorytmem szkolnym lub algorytmem Karatsuby, a wynik zamieniany jest
+ * z powrotem na zagnieżdżoną reprezentację rzadką.
+ *
+ * @author Jan Kwiatkowski
+ */
+
+#ifndef POLYNOMIALS_POLY_DENSE_H
+#define POLYNOMIALS_POLY_DENSE_H
+
+#include "poly.h"
+
+/** Maksymalna liczba zmiennych, dla której stosowane jest mnożenie gęste. */
+#define DENSE_MAX_VARS 4
+
+/** Maksymalna długość gęstego wektora będącego wynikiem mnożenia. */
+#define DENSE_MAX_LENGTH ((size_t) 1 << 24)
+
+/**
+ * Długość krótszego czynnika, od której gęste wektory mnożone są algorytmem
+ * Karatsuby zamiast algorytmem szkolnym.
+ */
+#define KARATSUBA_THRESHOLD 32
+
+/**
+ * Mnoży dwa gęste wektory współczynników wielomianów jednej zmiennej.
+ * Arytmetyka jest arytmetyką typu @ref poly_coeff_t modulo @f$2^{64}@f$,
+ * tak jak w pozostałych operacjach na wielomianach.
+ * Dla wektorów dłuższych niż @ref NTT_THRESHOLD korzysta z
+ * @ref NttMul(const poly_coeff_t a[], size_t n, const poly_coeff_t b[],
+ * size_t m, poly_coeff_t out[]).
+ * @param[in] a : współczynniki pierwszego czynnika
+ * @param[in] n : długość tablicy @p a, dodatnia
+ * @param[in] b : współczynniki drugiego czynnika
+ * @param[in] m : długość tablicy @p b, dodatnia
+ * @param[out] out : tablica długości @p n + @p m - 1, w której zapisywany
+ * jest wynik
+ */
+void DenseMul(const poly_coeff_t a[], size_t n, const poly_coeff_t b[],
+              size_t m, poly_coeff_t out[]);
+
+/**
+ * Mnoży dwa gęste wektory współczynników algorytmem szkolnym lub algorytmem
+ * Karatsuby, niezależnie od ich długości.
+ * @param[in] a : współczynniki pierwszego czynnika
+ * @param[in] n : długość tablicy @p a, dodatnia
+ * @param[in] b : współczynniki drugiego czynnika
+ * @param[in] m : długość tablicy @p b, dodatnia
+ * @param[out] out : tablica długości @p n + @p m - 1, w której zapisywany
+ * jest wynik
+ */
+void KaratsubaMul(const poly_coeff_t a[], size_t n, const poly_coeff_t b[],
+                  size_t m, poly_coeff_t out[]);
+
+/**
+ * Mnoży dwa wielomiany niebędące współczynnikami za pomocą podstawienia
+ * Kroneckera, o ile według oszacowania gęstości jest to tańsze od mnożenia
+ * rzadkiego. Przy ustawionym module (zob.
+ * @ref CoeffModulusSet(unsigned long p)) oraz w trybie dokładnym (zob.
+ * @ref CoeffExactSet(void)) zawsze zwraca fałsz.
+ * Ograniczenia na wykładniki kolejnych zmiennych wyznaczane są za pomocą
+ * @ref PolyDegBy(const Poly *p, size_t var_idx).
+ * @param[in] p : wielomian @f$p@f$
+ * @param[in] q : wielomian @f$q@f$
+ * @param[out] result : miejsce, w którym zapisywany jest iloczyn
+ * @f$p * q@f$, jeśli funkcja zwróci prawdę
+ * @return czy iloczyn został wyznaczony
+ */
+bool PolyMulDense(const Poly *p, const Poly *q, Poly *result);
+
+#endif //POLYNOMIALS_POLY_DENSE_H
@@ -0,0 +1,219 @@
+/** @file
+ * Implementacja modułu odpowiedzialnego za wyznaczanie wartości wielomianu
+ * w punkcie, w którym podane są wartości wszystkich zmiennych.
+ * Plan wykonywany jest na stosie ramek, po jednej dla każdej zmiennej; ramka
+ * przechowuje sumę dotychczasowych wyrazów i bieżącą potęgę zmiennej.
+ * Ramka o numerze 0 jest ramką pomocniczą, do której trafia wynik.
+ * Obliczenia wykonywane są na liczbach bez znaku, dzięki czemu przepełnienia
+ * dają ten sam wynik co arytmetyka na typie @ref poly_coeff_t, a przy
+ * ustawionym module współczynników są resztami modulo ten moduł.
+ *
+ * @author Jan Kwiatkowski
+ */
+
+#include "poly_eval.h"
+#include "coeff_mod.h"
+#include "utilities.h"
+#include <stdlib.h>
+
+/**
+ * Liczba ramek, dla której pamięć na ramki nie jest przydzielana na
+ * stercie.
+ */
+#define EVAL_LOCAL_FRAMES 32
+
+/**
+ * Mnoży liczby w arytmetyce współczynników.
+ * @param[in] a : czynnik
+ * @param[in] b : czynnik
+ * @return @f$a b@f$
+ */
+static inline unsigned long EvalMul(unsigned long a, unsigned long b) {
+    return (unsigned long) CoeffMul((poly_coeff_t) a, (poly_coeff_t) b);
+}
+
+/**
+ * Dodaje liczby w arytmetyce współczynników.
+ * @param[in] a : składnik
+ * @param[in] b : składnik
+ * @return @f$a + b@f$
+ */
+static inline unsigned long EvalAdd(unsigned long a, unsigned long b) {
+    return (unsigned long) CoeffAdd((poly_coeff_t) a, (poly_coeff_t) b);
+}
+
+/**
+ * Podnosi liczbę do potęgi, będącej różnicą kolejnych wykładników.
+ * @param[in] x : podstawa
+ * @param[in] gap : wykładnik, nieujemny
+ * @return @f$x^{gap}@f$
+ */
+static inline unsigned long GapPow(unsigned long x, poly_exp_t gap) {
+    if (gap == 1)
+        return x;
+
+    unsigned long ret = 1;
+    while (gap > 0) {
+        if (gap % 2 == 1)
+            ret = EvalMul(ret, x);
+        x = EvalMul(x, x);
+        gap /= 2;
+    }
+    return ret;
+}
+
+/**
+ * Liczy instrukcje planu dla wielomianu niebędącego współczynnikiem oraz
+ * głębokość jego zagnieżdżenia.
+ * @param[in] p : wielomian, który nie jest stały
+ * @param[in,out] size : licznik instrukcji
+ * @return liczba zmiennych, od których zależy wielomian
+ */
+static size_t PlanCount(const Poly *p, size_t *size) {
+    size_t depth = 0;
+    *size += 2;
+    for (size_t i = 0; i < p->size; i++) {
+        if (PolyIsCoeff(&p->arr[i].p)) {
+            (*size)++;
+        } else {
+            size_t child_depth = PlanCount(&p->arr[i].p, size);
+            if (child_depth > depth)
+                depth = child_depth;
+        }
+    }
+    return depth + 1;
+}
+
+/**
+ * Zapisuje instrukcje planu dla wielomianu niebędącego współczynnikiem.
+ * @param[in] p : wielomian, który nie jest stały
+ * @param[in] gap : różnica wykładników jednomianu zawierającego @p p
+ * w wielomianie nadrzędnym
+ * @param[in,out] ops : tablica instrukcji
+ * @param[in,out] pos : pozycja, na której zapisywana jest kolejna instrukcja
+ */
+static void PlanEmit(const Poly *p, poly_exp_t gap, PolyEvalOp *ops,
+                     size_t *pos) {
+    ops[(*pos)++] = (PolyEvalOp) {.type = EVAL_OP_ENTER};
+
+    poly_exp_t prev_exp = 0;
+    for (size_t i = 0; i < p->size; i++) {
+        const Mono *mono = &p->arr[i];
+        if (PolyIsCoeff(&mono->p)) {
+            ops[(*pos)++] = (PolyEvalOp) {.type = EVAL_OP_TERM,
+                                          .gap = mono->exp - prev_exp,
+                                          .coeff = CoeffPolyLow(&mono->p)};
+        } else {
+            PlanEmit(&mono->p, mono->exp - prev_exp, ops, pos);
+        }
+        prev_exp = mono->exp;
+    }
+
+    ops[(*pos)++] = (PolyEvalOp) {.type = EVAL_OP_LEAVE, .gap = gap};
+}
+
+PolyEvalPlan* PolyEvalPlanCompile(const Poly *p) {
+    PolyEvalPlan *plan = SafeMalloc(sizeof(PolyEvalPlan));
+
+    if (PolyIsCoeff(p)) {
+        plan->size = 1;
+        plan->depth = 0;
+        plan->ops = SafeMalloc(sizeof(PolyEvalOp));
+        plan->ops[0] = (PolyEvalOp) {.type = EVAL_OP_TERM, .gap = 0,
+                                     .coeff = CoeffPolyLow(p)};
+        return plan;
+    }
+
+    plan->size = 0;
+    plan->depth = PlanCount(p, &plan->size);
+    plan->ops = SafeMalloc(plan->size * sizeof(PolyEvalOp));
+    size_t pos = 0;
+    PlanEmit(p, 0, plan->ops, &pos);
+    assert(pos == plan->size);
+
+    return plan;
+}
+
+poly_coeff_t PolyEvalPlanRun(const PolyEvalPlan *plan, size_t k,
+                             const poly_coeff_t x[]) {
+    size_t frames = plan->depth + 1;
+    unsigned long local[3 * EVAL_LOCAL_FRAMES];
+    unsigned long *buf = frames <= EVAL_LOCAL_FRAMES ?
+                         local : SafeMalloc(3 * frames * sizeof(unsigned long));
+    unsigned long *acc = buf, *power = buf + frames, *vals = buf + 2 * frames;
+
+    // ramka f > 0 odpowiada zmiennej o indeksie f - 1
+    vals[0] = 0;
+    for (size_t f = 1; f < frames; f++)
+        vals[f] = f - 1 < k ? (unsigned long) CoeffReduce(x[f - 1]) : 0;
+
+    size_t f = 0;
+    acc[0] = 0;
+    power[0] = 1;
+    const PolyEvalOp *op = plan->ops, *end = plan->ops + plan->size;
+    for (; op != end; op++) {
+        switch (op->type) {
+            case EVAL_OP_ENTER:
+                f++;
+                acc[f] = 0;
+                power[f] = 1;
+                break;
+            case EVAL_OP_TERM:
+                power[f] = EvalMul(power[f], GapPow(vals[f], op->gap));
+                acc[f] = EvalAdd(acc[f],
+                                 EvalMul(power[f], (unsigned long) op->coeff));
+                break;
+            case EVAL_OP_LEAVE: {
+                unsigned long value = acc[f--];
+                power[f] = EvalMul(power[f], GapPow(vals[f], op->gap));
+                acc[f] = EvalAdd(acc[f], EvalMul(power[f], value));
+                break;
+            }
+        }
+    }
+    assert(f == 0);
+
+    poly_coeff_t ret = (poly_coeff_t) acc[0];
+    if (buf != local)
+        free(buf);
+    return ret;
+}
+
+void PolyEvalPlanDestroy(PolyEvalPlan *plan) {
+    if (plan == NULL)
+        return;
+    free(plan->ops);
+    free(plan);
+}
+
+/**
+ * Funkcja pomocnicza do @ref PolyEvalPoint(const Poly *p, size_t k,
+ * const poly_coeff_t x[]).
+ * @param[in] p : wielomian
+ * @param[in] k : liczba wartości zmiennych
+ * @param[in] x : wartości zmiennych
+ * @param[in] depth : indeks zmiennej wielomianu @p p
+ * @return wartość wielomianu w punkcie
+ */
+static unsigned long EvalPointHelper(const Poly *p, size_t k,
+                                     const poly_coeff_t x[], size_t depth) {
+    if (PolyIsCoeff(p))
+        return (unsigned long) CoeffPolyLow(p);
+
+    unsigned long value = depth < k ? (unsigned long) CoeffReduce(x[depth]) : 0;
+    unsigned long power = 1, sum = 0;
+    poly_exp_t prev_exp = 0;
+    for (size_t i = 0; i < p->size; i++) {
+        power = EvalMul(power, GapPow(value, p->arr[i].exp - prev_exp));
+        prev_exp = p->arr[i].exp;
+        if (power == 0)
+            break;
+        sum = EvalAdd(sum, EvalMul(power, EvalPointHelper(&p->arr[i].p, k, x,
+                                                          depth + 1)));
+    }
+    return sum;
+}
+
+poly_coeff_t PolyEvalPoint(const Poly *p, size_t k, const poly_coeff_t x[]) {
+    return (poly_coeff_t) EvalPointHelper(p, k, x, 0);
+}
@@ -0,0 +1,96 @@
+/** @file
+ * Interfejs modułu odpowiedzialnego za wyznaczanie wartości wielomianu
+ * w punkcie, w którym podane są wartości wszystkich zmiennych.
+ * Wielomian kompilowany jest do planu obliczeń, czyli ciągłej tablicy
+ * instrukcji, które wykonywane są w jednej pętli bez rekurencji i bez
+ * odwoływania się do drzewa jednomianów. Plan można wykonać wielokrotnie
+ * dla różnych punktów.
+ * Wartości wyznaczane są w arytmetyce typu @ref poly_coeff_t, więc w trybie
+ * dokładnym (zob. @ref CoeffExactSet(void)) są one jedynie resztami
+ * modulo @f$2^{64}@f$ wartości dokładnych.
+ *
+ * @author Jan Kwiatkowski
+ */
+
+#ifndef POLYNOMIALS_POLY_EVAL_H
+#define POLYNOMIALS_POLY_EVAL_H
+
+#include "poly.h"
+
+/**
+ * Rodzaj instrukcji planu obliczeń.
+ */
+typedef enum PolyEvalOpType {
+    /** Rozpoczyna obliczanie wielomianu kolejnej zmiennej. */
+    EVAL_OP_ENTER,
+    /**
+     * Mnoży bieżącą potęgę zmiennej przez zmienną podniesioną do @p gap
+     * i dodaje do sumy jej iloczyn ze współczynnikiem @p coeff.
+     */
+    EVAL_OP_TERM,
+    /**
+     * Kończy obliczanie wielomianu kolejnej zmiennej i traktuje jego wartość
+     * jak współczynnik w instrukcji @ref EVAL_OP_TERM o różnicy wykładników
+     * @p gap w wielomianie nadrzędnym.
+     */
+    EVAL_OP_LEAVE
+} PolyEvalOpType;
+
+/**
+ * Instrukcja planu obliczeń.
+ */
+typedef struct PolyEvalOp {
+    poly_coeff_t coeff; ///< współczynnik jednomianu
+    poly_exp_t gap; ///< różnica wykładnika i poprzedniego wykładnika
+    PolyEvalOpType type; ///< rodzaj instrukcji
+} PolyEvalOp;
+
+/**
+ * Plan obliczeń wartości wielomianu.
+ */
+typedef struct PolyEvalPlan {
+    PolyEvalOp *ops; ///< instrukcje
+    size_t size; ///< liczba instrukcji
+    size_t depth; ///< liczba zmiennych, od których zależy wielomian
+} PolyEvalPlan;
+
+/**
+ * Kompiluje wielomian do planu obliczeń.
+ * @param[in] p : wielomian
+ * @return plan obliczeń, który należy usunąć funkcją
+ * @ref PolyEvalPlanDestroy(PolyEvalPlan *plan)
+ */
+PolyEvalPlan* PolyEvalPlanCompile(const Poly *p);
+
+/**
+ * Wykonuje plan obliczeń w punkcie @f$(x_0, x_1, \ldots, x_{k-1})@f$.
+ * Zmienne o indeksach nie mniejszych niż @p k mają wartość 0.
+ * @param[in] plan : plan obliczeń
+ * @param[in] k : liczba wartości zmiennych
+ * @param[in] x : wartości zmiennych
+ * @return wartość wielomianu w punkcie
+ */
+poly_coeff_t PolyEvalPlanRun(const PolyEvalPlan *plan, size_t k,
+                             const poly_coeff_t x[]);
+
+/**
+ * Usuwa plan obliczeń z pamięci.
+ * @param[in] plan : plan obliczeń lub NULL
+ */
+void PolyEvalPlanDestroy(PolyEvalPlan *plan);
+
+/**
+ * Wyznacza wartość wielomianu w punkcie @f$(x_0, x_1, \ldots, x_{k-1})@f$.
+ * Zmienne o indeksach nie mniejszych niż @p k mają wartość 0.
+ * Daje ten sam wynik co kolejne wywołania
+ * @ref PolyAt(const Poly *p, poly_coeff_t x), ale nie tworzy wielomianów
+ * pośrednich. Przy wielokrotnym wyznaczaniu wartości tego samego wielomianu
+ * lepiej raz skompilować plan obliczeń.
+ * @param[in] p : wielomian
+ * @param[in] k : liczba wartości zmiennych
+ * @param[in] x : wartości zmiennych
+ * @return wartość wielomianu w punkcie
+ */
+poly_coeff_t PolyEvalPoint(const Poly *p, size_t k, const poly_coeff_t x[]);
+
+#endif //POLYNOMIALS_POLY_EVAL_H
@@ -0,0 +1,766 @@
+/** @file
+ * Implementacja modułu odpowiedzialnego za obrazy stosu wielomianów.
+ *
+ * @author Jan Kwiatkowski
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "poly_image.h"
+#include "big_coeff.h"
+#include "coeff_mod.h"
+#include "mono_pool.h"
+#include "utilities.h"
+#include <fcntl.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/** Wyrównanie rekordów obrazu w bajtach. */
+#define IMAGE_ALIGN 16
+
+/** Rodzaj rekordu: tablica jednomianów. */
+#define RECORD_ARRAY 1
+
+/** Rodzaj rekordu: współczynnik dowolnej precyzji. */
+#define RECORD_BIG 2
+
+/** Rodzaj rekordu: tablica wielomianów stosu. */
+#define RECORD_STACK 3
+
+/** Przyrostek nazwy pliku tymczasowego, w którym powstaje obraz. */
+#define TEMP_SUFFIX ".tmp"
+
+/** Najmniejsza pojemność tablicy adresów zapisanych rekordów. */
+#define ADDRESS_MAP_MIN_CAPACITY 64
+
+/**
+ * Nagłówek obrazu.
+ */
+typedef struct ImageHeader {
+    char magic[8]; ///< @ref POLY_IMAGE_MAGIC uzupełnione zerami
+    uint64_t version; ///< @ref POLY_IMAGE_VERSION
+    uint64_t layout; ///< rozmiary struktur zapisanych w obrazie
+    uint64_t base; ///< adres, względem którego zapisano wskaźniki
+    uint64_t size; ///< rozmiar obrazu w bajtach
+    uint64_t stack; ///< położenie rekordu stosu, ostatniego w obrazie
+    uint64_t modulus; ///< moduł arytmetyki współczynników
+    uint64_t exact; ///< czy arytmetyka współczynników jest dokładna
+} ImageHeader;
+
+/**
+ * Początek rekordu obrazu.
+ */
+typedef struct ImageRecord {
+    uint64_t kind; ///< rodzaj rekordu
+    uint64_t count; ///< liczba jednomianów, słów liczby lub wielomianów
+} ImageRecord;
+
+/**
+ * Wielomian, którego tablice są zapisywane w obrazie.
+ */
+typedef struct ImageFrame {
+    const Poly *p; ///< wielomian, który nie jest stały
+    size_t i; ///< indeks kolejnego jednomianu do zapisania
+} ImageFrame;
+
+/**
+ * Stan zapisu obrazu.
+ */
+typedef struct ImageWriter {
+    FILE *file; ///< plik obrazu
+    uint64_t offset; ///< liczba zapisanych bajtów
+    bool correct; ///< czy wszystkie zapisy się powiodły
+    uintptr_t *keys; ///< zapisane tablice i liczby; 0 oznacza wolne miejsce
+    uint64_t *addresses; ///< adresy zapisanych rekordów w obrazie
+    size_t capacity; ///< pojemność tablicy adresów, potęga dwójki
+    size_t count; ///< liczba zapamiętanych adresów
+    Mono *monos; ///< bufor zapisywanych jednomianów
+    size_t monos_capacity; ///< pojemność bufora jednomianów
+    void *array_header; ///< bufor nagłówka zapisywanej tablicy
+} ImageWriter;
+
+/**
+ * Odwzorowany w pamięci obraz.
+ */
+typedef struct ImageMapping {
+    void *addr; ///< początek obrazu
+    size_t size; ///< rozmiar obrazu w bajtach
+    struct ImageMapping *next; ///< kolejny obraz
+} ImageMapping;
+
+/** Lista odwzorowanych obrazów. */
+static ImageMapping *image_mappings = NULL;
+
+/** Bajty zerowe do wyrównywania rekordów. */
+static const char ZEROS[IMAGE_ALIGN];
+
+/**
+ * Zaokrągla liczbę w górę do wielokrotności @ref IMAGE_ALIGN.
+ * @param[in] n : liczba
+ * @return zaokrąglona liczba
+ */
+static size_t AlignUp(size_t n) {
+    return (n + IMAGE_ALIGN - 1) & ~(size_t) (IMAGE_ALIGN - 1);
+}
+
+/**
+ * Zwraca rozmiary struktur zapisywanych w obrazie, po 12 bitów na każdą.
+ * @return rozmiary struktur
+ */
+static uint64_t ImageLayout(void) {
+    return (uint64_t) sizeof(Poly) | (uint64_t) sizeof(Mono) << 12 |
+           (uint64_t) MonoArrayHeaderSize() << 24 |
+           (uint64_t) sizeof(PolyMeta) << 36 | (uint64_t) sizeof(BigInt) << 48;
+}
+
+/**
+ * Zwraca położenie nagłówka tablicy względem początku jej rekordu.
+ * Między początkiem rekordu a nagłówkiem leży opis wielomianu.
+ * @return położenie nagłówka tablicy w bajtach
+ */
+static size_t ArrayHeaderOffset(void) {
+    return AlignUp(sizeof(ImageRecord) + sizeof(PolyMeta));
+}
+
+/**
+ * Zwraca położenie jednomianów względem początku rekordu tablicy.
+ * @return położenie jednomianów w bajtach
+ */
+static size_t ArrayMonosOffset(void) {
+    return ArrayHeaderOffset() + MonoArrayHeaderSize();
+}
+
+/**
+ * Zwraca rozmiar rekordu.
+ * @param[in] record : początek rekordu
+ * @return rozmiar rekordu w bajtach lub 0, jeśli rodzaj rekordu jest
+ * niepoprawny
+ */
+static uint64_t RecordSize(const ImageRecord *record) {
+    switch (record->kind) {
+        case RECORD_ARRAY:
+            return AlignUp(ArrayMonosOffset() + record->count * sizeof(Mono));
+        case RECORD_BIG:
+            return AlignUp(sizeof(ImageRecord) + sizeof(BigInt) +
+                           record->count * sizeof(uint64_t));
+        case RECORD_STACK:
+            return AlignUp(sizeof(ImageRecord) + record->count * sizeof(Poly));
+        default:
+            return 0;
+    }
+}
+
+/**
+ * Zwraca miejsce, w którym tablica lub liczba jest zapamiętana w tablicy
+ * adresów, albo wolne miejsce, w którym należy ją zapamiętać.
+ * @param[in] writer : stan zapisu
+ * @param[in] key : tablica lub liczba
+ * @return indeks w tablicy adresów
+ */
+static size_t AddressSlot(const ImageWriter *writer, uintptr_t key) {
+    size_t mask = writer->capacity - 1;
+    size_t i = (size_t) ((key >> 4) * 0x9e3779b97f4a7c15UL >> 20) & mask;
+    while (writer->keys[i] != 0 && writer->keys[i] != key)
+        i = (i + 1) & mask;
+    return i;
+}
+
+/**
+ * Zapamiętuje adres rekordu tablicy lub liczby w obrazie.
+ * @param[in,out] writer : stan zapisu
+ * @param[in] key : tablica lub liczba
+ * @param[in] address : adres rekordu
+ */
+static void AddressInsert(ImageWriter *writer, uintptr_t key,
+                          uint64_t address) {
+    if (2 * (writer->count + 1) > writer->capacity) {
+        uintptr_t *keys = writer->keys;
+        uint64_t *addresses = writer->addresses;
+        size_t capacity = writer->capacity;
+        writer->capacity = capacity == 0 ? ADDRESS_MAP_MIN_CAPACITY :
+                           2 * capacity;
+        writer->keys = SafeMalloc(writer->capacity * sizeof(uintptr_t));
+        memset(writer->keys, 0, writer->capacity * sizeof(uintptr_t));
+        writer->addresses = SafeMalloc(writer->capacity * sizeof(uint64_t));
+        for (size_t i = 0; i < capacity; i++) {
+            if (keys[i] != 0) {
+                size_t slot = AddressSlot(writer, keys[i]);
+                writer->keys[slot] = keys[i];
+                writer->addresses[slot] = addresses[i];
+            }
+        }
+        free(keys);
+        free(addresses);
+    }
+    size_t slot = AddressSlot(writer, key);
+    writer->keys[slot] = key;
+    writer->addresses[slot] = address;
+    writer->count++;
+}
+
+/**
+ * Sprawdza, czy tablica lub liczba jest już zapisana w obrazie.
+ * @param[in] writer : stan zapisu
+ * @param[in] key : tablica lub liczba
+ * @param[out] address : adres rekordu, jeśli jest zapisany
+ * @return czy tablica lub liczba jest zapisana
+ */
+static bool AddressFind(const ImageWriter *writer, uintptr_t key,
+                        uint64_t *address) {
+    if (writer->count == 0)
+        return false;
+    size_t slot = AddressSlot(writer, key);
+    if (writer->keys[slot] == 0)
+        return false;
+    *address = writer->addresses[slot];
+    return true;
+}
+
+/**
+ * Dopisuje bajty do obrazu.
+ * @param[in,out] writer : stan zapisu
+ * @param[in] data : bajty
+ * @param[in] size : liczba bajtów
+ */
+static void ImageWrite(ImageWriter *writer, const void *data, size_t size) {
+    if (size > 0 && fwrite(data, 1, size, writer->file) != size)
+        writer->correct = false;
+    writer->offset += size;
+}
+
+/**
+ * Dopisuje do obrazu bajty zerowe wyrównujące koniec rekordu.
+ * @param[in,out] writer : stan zapisu
+ */
+static void ImagePad(ImageWriter *writer) {
+    ImageWrite(writer, ZEROS, AlignUp(writer->offset) - writer->offset);
+}
+
+/**
+ * Zamienia wskaźniki wielomianu, którego tablice i liczby są już zapisane,
+ * na ich adresy w obrazie.
+ * @param[in] writer : stan zapisu
+ * @param[in] p : wielomian
+ * @return wielomian ze wskaźnikami do obrazu
+ */
+static Poly ImagePoly(const ImageWriter *writer, const Poly *p) {
+    Poly image = *p;
+    uint64_t address = 0;
+    if (PolyIsBig(p)) {
+        AddressFind(writer, (uintptr_t) p->big, &address);
+        image.big = (BigInt *) (uintptr_t) address;
+    } else if (!PolyIsCoeff(p)) {
+        AddressFind(writer, (uintptr_t) p->arr, &address);
+        image.arr = (Mono *) (uintptr_t) address;
+    }
+    return image;
+}
+
+/**
+ * Zapisuje rekord współczynnika dowolnej precyzji, jeśli nie był zapisany.
+ * @param[in,out] writer : stan zapisu
+ * @param[in] big : liczba
+ */
+static void WriteBig(ImageWriter *writer, const BigInt *big) {
+    uint64_t address;
+    if (AddressFind(writer, (uintptr_t) big, &address))
+        return;
+    AddressInsert(writer, (uintptr_t) big, POLY_IMAGE_BASE + writer->offset +
+                                           sizeof(ImageRecord));
+
+    ImageRecord record = {.kind = RECORD_BIG, .count = big->size};
+    ImageWrite(writer, &record, sizeof(record));
+    BigInt image;
+    memset(&image, 0, sizeof(image));
+    atomic_init(&image.refcount, BIG_IMMORTAL);
+    image.capacity = big->size;
+    image.size = big->size;
+    image.negative = big->negative;
+    ImageWrite(writer, &image, sizeof(image));
+    ImageWrite(writer, big->limbs, big->size * sizeof(uint64_t));
+    ImagePad(writer);
+}
+
+/**
+ * Zapisuje rekord tablicy jednomianów wielomianu, którego wszystkie
+ * poddrzewa są już zapisane.
+ * @param[in,out] writer : stan zapisu
+ * @param[in] p : wielomian, który nie jest stały
+ */
+static void WriteArray(ImageWriter *writer, const Poly *p) {
+    uint64_t start = POLY_IMAGE_BASE + writer->offset;
+    AddressInsert(writer, (uintptr_t) p->arr, start + ArrayMonosOffset());
+
+    ImageRecord record = {.kind = RECORD_ARRAY, .count = p->size};
+    ImageWrite(writer, &record, sizeof(record));
+    // skrót i opis zapamiętane przy pierwszym wyznaczeniu kosztują tu O(1)
+    PolyMeta known = PolyGetMeta(p), meta;
+    memset(&meta, 0, sizeof(meta));
+    meta.terms = known.terms;
+    meta.depth = known.depth;
+    meta.deg = known.deg;
+    memcpy(meta.deg_by, known.deg_by, sizeof(meta.deg_by));
+    ImageWrite(writer, &meta, sizeof(meta));
+    ImagePad(writer);
+    MonoArrayInitImmortal(writer->array_header, p->size, PolyHash(p),
+                          (const PolyMeta *) (uintptr_t)
+                              (start + sizeof(ImageRecord)));
+    ImageWrite(writer, writer->array_header, MonoArrayHeaderSize());
+
+    if (writer->monos_capacity < p->size) {
+        free(writer->monos);
+        writer->monos_capacity = p->size;
+        writer->monos = SafeMalloc(p->size * sizeof(Mono));
+    }
+    // bajty wyrównania jednomianów też trafiają do pliku
+    memset(writer->monos, 0, p->size * sizeof(Mono));
+    for (size_t i = 0; i < p->size; i++) {
+        writer->monos[i].p = ImagePoly(writer, &p->arr[i].p);
+        writer->monos[i].exp = p->arr[i].exp;
+    }
+    ImageWrite(writer, writer->monos, p->size * sizeof(Mono));
+    ImagePad(writer);
+}
+
+/**
+ * Zapisuje rekordy tablic i liczb wielomianu, których nie ma jeszcze
+ * w obrazie, każdą przed tablicami, które na nią wskazują. Poddrzewa
+ * przechodzone są bez rekurencji.
+ * @param[in,out] writer : stan zapisu
+ * @param[in] p : wielomian
+ */
+static void WritePoly(ImageWriter *writer, const Poly *p) {
+    uint64_t address;
+    if (PolyIsBig(p))
+        WriteBig(writer, p->big);
+    if (PolyIsCoeff(p) || AddressFind(writer, (uintptr_t) p->arr, &address))
+        return;
+
+    ImageFrame local[WORK_STACK_LOCAL];
+    ImageFrame *stack = local;
+    size_t capacity = WORK_STACK_LOCAL, top = 0;
+    stack[top++] = (ImageFrame) {.p = p, .i = 0};
+
+    while (top > 0) {
+        ImageFrame *frame = &stack[top - 1];
+        if (frame->i == frame->p->size) {
+            WriteArray(writer, frame->p);
+            top--;
+            continue;
+        }
+
+        const Poly *child = &frame->p->arr[frame->i++].p;
+        if (PolyIsBig(child)) {
+            WriteBig(writer, child->big);
+        } else if (!PolyIsCoeff(child) &&
+                   !AddressFind(writer, (uintptr_t) child->arr, &address)) {
+            if (top == capacity)
+                stack = WorkStackGrow(stack, local, &capacity,
+                                      sizeof(ImageFrame));
+            stack[top++] = (ImageFrame) {.p = child, .i = 0};
+        }
+    }
+
+    if (stack != local)
+        free(stack);
+}
+
+/**
+ * Zapisuje obraz wielomianów w pliku otwartym do zapisu.
+ * @param[in,out] file : plik
+ * @param[in] n : liczba wielomianów
+ * @param[in] polys : wielomiany
+ * @return czy udało się zapisać obraz
+ */
+static bool WriteImage(FILE *file, size_t n, const Poly polys[]) {
+    ImageWriter writer = {.file = file, .offset = 0, .correct = true,
+                          .keys = NULL, .addresses = NULL, .capacity = 0,
+                          .count = 0, .monos = NULL, .monos_capacity = 0,
+                          .array_header = SafeMalloc(MonoArrayHeaderSize())};
+
+    // nagłówek jest uzupełniany na końcu, gdy znane są rozmiary
+    ImageHeader header;
+    memset(&header, 0, sizeof(header));
+    ImageWrite(&writer, &header, sizeof(header));
+    ImagePad(&writer);
+
+    for (size_t i = 0; i < n; i++)
+        WritePoly(&writer, &polys[i]);
+
+    uint64_t stack = writer.offset;
+    ImageRecord record = {.kind = RECORD_STACK, .count = n};
+    ImageWrite(&writer, &record, sizeof(record));
+    for (size_t i = 0; i < n; i++) {
+        Poly image = ImagePoly(&writer, &polys[i]);
+        ImageWrite(&writer, &image, sizeof(image));
+    }
+    ImagePad(&writer);
+
+    memcpy(header.magic, POLY_IMAGE_MAGIC, sizeof(POLY_IMAGE_MAGIC));
+    header.version = POLY_IMAGE_VERSION;
+    header.layout = ImageLayout();
+    header.base = POLY_IMAGE_BASE;
+    header.size = writer.offset;
+    header.stack = stack;
+    header.modulus = coeff_modulus.p;
+    header.exact = coeff_modulus.exact;
+    bool correct = writer.correct && fseek(file, 0, SEEK_SET) == 0 &&
+                   fwrite(&header, sizeof(header), 1, file) == 1;
+
+    free(writer.keys);
+    free(writer.addresses);
+    free(writer.monos);
+    free(writer.array_header);
+    return correct;
+}
+
+bool PolyImageSave(const char *path, size_t n, const Poly polys[]) {
+    size_t length = strlen(path);
+    char *temp_path = SafeMalloc(length + sizeof(TEMP_SUFFIX));
+    memcpy(temp_path, path, length);
+    memcpy(temp_path + length, TEMP_SUFFIX, sizeof(TEMP_SUFFIX));
+
+    bool correct = false;
+    FILE *file = fopen(temp_path, "wb");
+    if (file != NULL) {
+        correct = WriteImage(file, n, polys);
+        correct &= fclose(file) == 0;
+        // zastąpienie pliku nie zmienia stron już odwzorowanego obrazu
+        if (correct)
+            correct = rename(temp_path, path) == 0;
+        if (!correct)
+            remove(temp_path);
+    }
+    free(temp_path);
+    return correct;
+}
+
+/**
+ * Stan przejścia po rekordach odczytywanego obrazu.
+ */
+typedef struct ImageCheck {
+    char *image; ///< początek obrazu w pamięci
+    const ImageHeader *header; ///< nagłówek obrazu
+    /**
+     * przesunięcie obrazu względem adresu, pod którym zapisano wskaźniki;
+     * jeśli jest niezerowe, wskaźniki są przesuwane, a obraz musi być
+     * dostępny do zapisu
+     */
+    uintptr_t delta;
+    /**
+     * rodzaje sprawdzonych rekordów, po jednym na każde @ref IMAGE_ALIGN
+     * bajtów obrazu, indeksowane położeniem początku rekordu
+     */
+    unsigned char *kinds;
+    void *array_header; ///< bufor oczekiwanego nagłówka tablicy
+} ImageCheck;
+
+/**
+ * Sprawdza wskaźnik wielomianu zapisanego w obrazie i przesuwa go, jeśli
+ * obraz jest odwzorowany pod innym adresem. Tablica musi wskazywać na
+ * jednomiany sprawdzonego rekordu tablicy o tej samej liczbie jednomianów,
+ * a liczba dowolnej precyzji na sprawdzony rekord liczby. Oba rekordy muszą
+ * zaczynać się przed @p limit.
+ * @param[in] check : stan przejścia
+ * @param[in,out] p : wielomian w obrazie
+ * @param[in] limit : położenie rekordu, w którym leży wielomian
+ * @param[out] inner : opis wielomianu zapisany w obrazie lub NULL, jeśli
+ * wielomian jest stały
+ * @return czy wskaźnik jest poprawny
+ */
+static bool CheckPoly(const ImageCheck *check, Poly *p, uint64_t limit,
+                      const PolyMeta **inner) {
+    *inner = NULL;
+    if (p->arr == NULL)
+        return true;
+
+    bool big = PolyIsBig(p);
+    uintptr_t target = big ? (uintptr_t) p->big : (uintptr_t) p->arr;
+    // odejmowanie modulo 2^64 zamienia adres sprzed obrazu na duże położenie
+    uint64_t offset = (uint64_t) target - check->header->base -
+                      (big ? sizeof(ImageRecord) : ArrayMonosOffset());
+    if (offset >= limit || offset % IMAGE_ALIGN != 0 ||
+        check->kinds[offset / IMAGE_ALIGN] != (big ? RECORD_BIG
+                                                   : RECORD_ARRAY))
+        return false;
+
+    if (!big) {
+        const ImageRecord *record =
+            (const ImageRecord *) (check->image + offset);
+        if (record->count != p->size)
+            return false;
+        *inner = (const PolyMeta *) (record + 1);
+    }
+
+    if (check->delta != 0) {
+        if (big)
+            p->big = (BigInt *) (target + check->delta);
+        else
+            p->arr = (Mono *) (target + check->delta);
+    }
+    return true;
+}
+
+/**
+ * Sprawdza, czy dwa opisy wielomianu są równe.
+ * @param[in] a : opis
+ * @param[in] b : opis
+ * @return czy opisy są równe
+ */
+static bool MetaEqual(const PolyMeta *a, const PolyMeta *b) {
+    return a->terms == b->terms && a->depth == b->depth && a->deg == b->deg &&
+           memcmp(a->deg_by, b->deg_by, sizeof(a->deg_by)) == 0;
+}
+
+/**
+ * Sprawdza rekord tablicy jednomianów i przesuwa jego wskaźniki.
+ * Wykładniki muszą rosnąć, współczynniki stałe nie mogą być zerowe,
+ * a zapisany opis wielomianu musi zgadzać się z opisem wyznaczonym na
+ * podstawie jednomianów.
+ * @param[in] check : stan przejścia
+ * @param[in] offset : położenie rekordu
+ * @return czy rekord jest poprawny
+ */
+static bool CheckArray(const ImageCheck *check, uint64_t offset) {
+    ImageRecord *record = (ImageRecord *) (check->image + offset);
+    Mono *arr = (Mono *) (check->image + offset + ArrayMonosOffset());
+    if (record->count == 0)
+        return false;
+
+    PolyMeta meta;
+    PolyMetaInit(&meta);
+    for (size_t i = 0; i < record->count; i++) {
+        const PolyMeta *inner;
+        if (arr[i].exp < 0 || (i > 0 && arr[i].exp <= arr[i - 1].exp) ||
+            !CheckPoly(check, &arr[i].p, offset, &inner) ||
+            (inner == NULL && PolyIsZero(&arr[i].p)))
+            return false;
+        PolyMetaAddMono(&meta, &arr[i], inner);
+    }
+    if (!MetaEqual(&meta, (const PolyMeta *) (record + 1)))
+        return false;
+
+    // nagłówek tablicy musi być taki, jaki utworzyłby zapis obrazu
+    uint64_t hash = MonoArrayGetHash(arr);
+    if (hash == 0)
+        return false;
+    void *array_header = check->image + offset + ArrayHeaderOffset();
+    MonoArrayInitImmortal(check->array_header, record->count, hash,
+                          (const PolyMeta *) (uintptr_t)
+                              (check->header->base + offset +
+                               sizeof(ImageRecord)));
+    if (memcmp(check->array_header, array_header, MonoArrayHeaderSize()) != 0)
+        return false;
+    if (check->delta != 0)
+        MonoArrayInitImmortal(array_header, record->count, hash,
+                              (const PolyMeta *) (record + 1));
+    return true;
+}
+
+/**
+ * Sprawdza rekord współczynnika dowolnej precyzji.
+ * @param[in] check : stan przejścia
+ * @param[in] offset : położenie rekordu
+ * @return czy rekord jest poprawny
+ */
+static bool CheckBig(const ImageCheck *check, uint64_t offset) {
+    const ImageRecord *record =
+        (const ImageRecord *) (check->image + offset);
+    const BigInt *big = (const BigInt *) (record + 1);
+    unsigned char negative;
+    memcpy(&negative, &big->negative, sizeof(negative));
+    return check->header->exact && record->count > 0 &&
+           atomic_load((atomic_size_t *) &big->refcount) == BIG_IMMORTAL &&
+           big->capacity == record->count && big->size == record->count &&
+           negative <= 1 && big->limbs[record->count - 1] != 0;
+}
+
+/**
+ * Sprawdza w jednym przejściu wszystkie rekordy obrazu, przesuwając przy
+ * tym jego wskaźniki, jeśli @p relocate jest prawdą.
+ * @param[in,out] image : początek obrazu w pamięci, dostępnej do zapisu,
+ * jeśli wskaźniki trzeba przesunąć
+ * @param[in] header : nagłówek obrazu
+ * @param[in] relocate : czy przesunąć wskaźniki do bieżącego położenia
+ * obrazu; w przeciwnym przypadku obraz jest sprawdzany tak, jakby leżał pod
+ * adresem, względem którego go zapisano
+ * @return czy obraz jest poprawny
+ */
+static bool CheckImage(char *image, const ImageHeader *header, bool relocate) {
+    ImageCheck check = {
+        .image = image, .header = header,
+        .delta = relocate ? (uintptr_t) image - (uintptr_t) header->base : 0,
+        .kinds = SafeCalloc(header->stack / IMAGE_ALIGN, 1),
+        .array_header = SafeMalloc(MonoArrayHeaderSize())};
+
+    bool correct = true;
+    uint64_t offset = AlignUp(sizeof(ImageHeader));
+    while (correct && offset < header->stack) {
+        ImageRecord *record = (ImageRecord *) (image + offset);
+        // każdy element rekordu zajmuje co najmniej bajt
+        uint64_t size = record->count <= header->stack - offset ?
+                        RecordSize(record) : 0;
+        correct = size != 0 && size <= header->stack - offset;
+        if (correct && record->kind == RECORD_ARRAY)
+            correct = CheckArray(&check, offset);
+        else if (correct && record->kind == RECORD_BIG)
+            correct = CheckBig(&check, offset);
+        else
+            correct = false;
+
+        // rekord staje się celem wskaźników dopiero po sprawdzeniu, więc
+        // wskazywane rekordy zawsze poprzedzają wskazujące
+        if (correct)
+            check.kinds[offset / IMAGE_ALIGN] = (unsigned char) record->kind;
+        offset += size;
+    }
+    correct &= offset == header->stack;
+
+    ImageRecord *record = (ImageRecord *) (image + header->stack);
+    Poly *polys = (Poly *) (record + 1);
+    for (size_t i = 0; correct && i < record->count; i++) {
+        const PolyMeta *inner;
+        correct = CheckPoly(&check, &polys[i], header->stack, &inner);
+    }
+
+    free(check.kinds);
+    free(check.array_header);
+    return correct;
+}
+
+/**
+ * Sprawdza nagłówek obrazu.
+ * @param[in] header : nagłówek
+ * @param[in] file_size : rozmiar pliku
+ * @return czy nagłówek opisuje obraz w bieżącej wersji formatu
+ */
+static bool CheckHeader(const ImageHeader *header, off_t file_size) {
+    char magic[sizeof(header->magic)] = POLY_IMAGE_MAGIC;
+    long page_size = sysconf(_SC_PAGESIZE);
+    return memcmp(header->magic, magic, sizeof(magic)) == 0 &&
+           header->version == POLY_IMAGE_VERSION &&
+           header->layout == ImageLayout() &&
+           page_size > 0 && header->base % (uint64_t) page_size == 0 &&
+           header->size == (uint64_t) file_size &&
+           header->stack >= AlignUp(sizeof(ImageHeader)) &&
+           header->stack <= header->size - sizeof(ImageRecord) &&
+           header->stack % IMAGE_ALIGN == 0 &&
+           header->modulus <= COEFF_MOD_MAX && header->exact <= 1 &&
+           (header->modulus == 0 || !header->exact);
+}
+
+bool PolyImageOpen(const char *path, PolyImage *image) {
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return false;
+
+    struct stat st;
+    ImageHeader header;
+    if (fstat(fd, &st) != 0 || st.st_size < (off_t) sizeof(header) ||
+        pread(fd, &header, sizeof(header), 0) != sizeof(header) ||
+        !CheckHeader(&header, st.st_size)) {
+        close(fd);
+        return false;
+    }
+
+    // jądro używa wskazanego adresu, jeśli jest wolny, a inaczej wybiera inny
+    size_t size = (size_t) header.size;
+    void *addr = mmap((void *) (uintptr_t) header.base, size, PROT_READ,
+                      MAP_PRIVATE, fd, 0);
+    if (addr == MAP_FAILED) {
+        close(fd);
+        return false;
+    }
+
+    const ImageRecord *record =
+        (const ImageRecord *) ((char *) addr + header.stack);
+    bool correct = record->kind == RECORD_STACK &&
+                   record->count <= header.size - header.stack &&
+                   RecordSize(record) == header.size - header.stack;
+    // obraz spod innego adresu zostanie być może przesunięty; do tego czasu
+    // strony się nie zmieniają, więc nie powstaje ich prywatna kopia
+    if (correct && (uintptr_t) addr != header.base)
+        correct = mprotect(addr, size, PROT_READ | PROT_WRITE) == 0;
+    correct = correct && CheckImage(addr, &header, false);
+    if (!correct) {
+        munmap(addr, size);
+        close(fd);
+        return false;
+    }
+
+    *image = (PolyImage) {.addr = addr, .size = size, .fd = fd,
+                          .base = header.base, .stack = header.stack,
+                          .modulus = header.modulus,
+                          .exact = header.exact != 0};
+    return true;
+}
+
+void PolyImageClose(PolyImage *image) {
+    munmap(image->addr, image->size);
+    close(image->fd);
+}
+
+bool PolyImageCommit(PolyImage *image, size_t *n, Poly **polys) {
+    bool correct = true;
+    if ((uintptr_t) image->addr != image->base) {
+        // adres bazowy mógł zostać zwolniony od czasu sprawdzenia obrazu
+        void *addr = mmap((void *) (uintptr_t) image->base, image->size,
+                          PROT_READ, MAP_PRIVATE, image->fd, 0);
+        if ((uintptr_t) addr == image->base) {
+            munmap(image->addr, image->size);
+            image->addr = addr;
+        } else {
+            if (addr != MAP_FAILED)
+                munmap(addr, image->size);
+            // strony zmienione przy przesuwaniu stają się prywatną kopią
+            ImageHeader header = {.base = image->base, .size = image->size,
+                                  .stack = image->stack,
+                                  .modulus = image->modulus,
+                                  .exact = image->exact};
+            correct = CheckImage(image->addr, &header, true) &&
+                      mprotect(image->addr, image->size, PROT_READ) == 0;
+        }
+    }
+    if (!correct) {
+        PolyImageClose(image);
+        return false;
+    }
+    close(image->fd);
+
+    ImageMapping *mapping = SafeMalloc(sizeof(ImageMapping));
+    *mapping = (ImageMapping) {.addr = image->addr, .size = image->size,
+                               .next = image_mappings};
+    image_mappings = mapping;
+
+    const ImageRecord *record =
+        (const ImageRecord *) ((char *) image->addr + image->stack);
+    *n = record->count;
+    *polys = SafeMalloc((*n > 0 ? *n : 1) * sizeof(Poly));
+    memcpy(*polys, record + 1, *n * sizeof(Poly));
+
+    if (image->exact)
+        CoeffExactSet();
+    else
+        CoeffModulusSet(image->modulus);
+    return true;
+}
+
+bool PolyImageLoad(const char *path, size_t *n, Poly **polys) {
+    PolyImage image;
+    return PolyImageOpen(path, &image) && PolyImageCommit(&image, n, polys);
+}
+
+void PolyImageRelease(void) {
+    while (image_mappings != NULL) {
+        ImageMapping *next = image_mappings->next;
+        munmap(image_mappings->addr, image_mappings->size);
+        free(image_mappings);
+        image_mappings = next;
+    }
+}
@@ -0,0 +1,125 @@
+/** @file
+ * Interfejs modułu odpowiedzialnego za obrazy stosu wielomianów.
+ * Obraz to plik, który po odwzorowaniu w pamięci funkcją mmap() jest od
+ * razu gotowym do użycia zbiorem tablic jednomianów i współczynników
+ * dowolnej precyzji, bez odczytywania i budowania ich na nowo.
+ * Obraz zaczyna się nagłówkiem, za którym leżą wyrównane rekordy: tablice
+ * jednomianów (każda razem z nagłówkiem puli, skrótem i opisem wielomianu),
+ * współczynniki dowolnej precyzji i na końcu tablica wielomianów stosu.
+ * Rekordy zapisane są w kolejności, w której każda tablica poprzedza
+ * tablice, które na nią wskazują, a tablica lub liczba współdzielona przez
+ * kilka wielomianów zapisana jest raz.
+ * Wskaźniki w obrazie są adresami, pod którymi leżałyby wskazywane rekordy,
+ * gdyby obraz był odwzorowany pod adresem @ref POLY_IMAGE_BASE. Jeśli ten
+ * adres jest wolny, obraz odwzorowywany jest pod nim tylko do odczytu
+ * i niczego nie trzeba poprawiać; w przeciwnym przypadku wskaźniki są
+ * przesuwane w prywatnej kopii stron w jednym przejściu po rekordach.
+ * Tablice i liczby z obrazu mają licznik odwołań, który nigdy się nie
+ * zmienia, więc są zawsze współdzielone: każda zmiana wielomianu tworzy
+ * kopię zmienianej tablicy.
+ * Obraz zapisywany jest w kolejności bajtów i rozmiarach struktur bieżącego
+ * komputera i jest przeznaczony do odczytu przez ten sam program. Przy
+ * odczycie sprawdzany jest nagłówek, a w jednym przejściu po rekordach,
+ * połączonym z przesuwaniem wskaźników, także to, że każdy wskaźnik prowadzi
+ * do wcześniejszego rekordu odpowiedniego rodzaju, a zapisane opisy
+ * wielomianów zgadzają się z jednomianami.
+ *
+ * @author Jan Kwiatkowski
+ */
+
+#ifndef POLYNOMIALS_POLY_IMAGE_H
+#define POLYNOMIALS_POLY_IMAGE_H
+
+#include "poly.h"
+
+/** Pierwsze bajty obrazu. */
+#define POLY_IMAGE_MAGIC "PLYIMG"
+
+/** Wersja formatu obrazu. */
+#define POLY_IMAGE_VERSION 1
+
+/** Adres, pod którym obraz można odwzorować bez poprawiania wskaźników. */
+#define POLY_IMAGE_BASE ((uintptr_t) 0x7e0000000000)
+
+/**
+ * Obraz odwzorowany w pamięci i sprawdzony, którego wielomiany nie są
+ * jeszcze używane.
+ */
+typedef struct PolyImage {
+    void *addr; ///< początek obrazu w pamięci
+    size_t size; ///< rozmiar obrazu w bajtach
+    int fd; ///< deskryptor pliku obrazu
+    uint64_t base; ///< adres, względem którego zapisano wskaźniki
+    uint64_t stack; ///< położenie rekordu stosu
+    unsigned long modulus; ///< moduł arytmetyki współczynników
+    bool exact; ///< czy arytmetyka współczynników jest dokładna
+} PolyImage;
+
+/**
+ * Zapisuje obraz wielomianów wraz z bieżącą arytmetyką współczynników.
+ * Obraz powstaje w pliku tymczasowym o nazwie @p path z przyrostkiem
+ * `.tmp`, który na koniec zastępuje plik @p path, więc zapis nie zmienia
+ * obrazu, który jest właśnie odwzorowany w pamięci.
+ * @param[in] path : ścieżka pliku
+ * @param[in] n : liczba wielomianów
+ * @param[in] polys : wielomiany
+ * @return czy udało się zapisać obraz
+ */
+bool PolyImageSave(const char *path, size_t n, const Poly polys[]);
+
+/**
+ * Odwzorowuje w pamięci obraz wielomianów i sprawdza go, nie zmieniając
+ * jeszcze żadnych stron. Pozwala sprawdzić nowy obraz, zanim zwolnione
+ * zostaną poprzednie (zob. @ref PolyImageRelease(void)), by potem
+ * odwzorować go pod zwolnionym adresem @ref POLY_IMAGE_BASE.
+ * Obraz należy przekazać do
+ * @ref PolyImageCommit(PolyImage *image, size_t *n, Poly **polys) albo
+ * @ref PolyImageClose(PolyImage *image).
+ * @param[in] path : ścieżka pliku
+ * @param[out] image : sprawdzony obraz
+ * @return czy plik jest poprawnym obrazem w bieżącej wersji formatu
+ */
+bool PolyImageOpen(const char *path, PolyImage *image);
+
+/**
+ * Usuwa z pamięci sprawdzony obraz, z którego nie skorzystano.
+ * @param[in,out] image : obraz
+ */
+void PolyImageClose(PolyImage *image);
+
+/**
+ * Udostępnia wielomiany sprawdzonego obrazu i ustawia zapisaną w nim
+ * arytmetykę współczynników (zob. @ref CoeffModulusSet(unsigned long p)
+ * i @ref CoeffExactSet(void)). Jeśli adres @ref POLY_IMAGE_BASE jest już
+ * wolny, obraz jest odwzorowywany pod nim ponownie, a w przeciwnym
+ * przypadku wskaźniki są przesuwane. Obraz pozostaje odwzorowany do
+ * wywołania @ref PolyImageRelease(void).
+ * @param[in,out] image : obraz zwrócony przez
+ * @ref PolyImageOpen(const char *path, PolyImage *image)
+ * @param[out] n : liczba wielomianów
+ * @param[out] polys : tablica wielomianów, którą należy zwolnić funkcją
+ * free(); wielomiany należy usunąć z pamięci jak każde inne
+ * @return czy udało się udostępnić wielomiany; jeśli nie, obraz jest
+ * usuwany z pamięci
+ */
+bool PolyImageCommit(PolyImage *image, size_t *n, Poly **polys);
+
+/**
+ * Odwzorowuje w pamięci obraz wielomianów, sprawdza go i udostępnia jego
+ * wielomiany tak jak
+ * @ref PolyImageCommit(PolyImage *image, size_t *n, Poly **polys).
+ * @param[in] path : ścieżka pliku
+ * @param[out] n : liczba wielomianów
+ * @param[out] polys : tablica wielomianów, którą należy zwolnić funkcją
+ * free(); wielomiany należy usunąć z pamięci jak każde inne
+ * @return czy plik jest poprawnym obrazem w bieżącej wersji formatu
+ */
+bool PolyImageLoad(const char *path, size_t *n, Poly **polys);
+
+/**
+ * Usuwa z pamięci wszystkie odwzorowane obrazy. Nie mogą już istnieć
+ * wielomiany, które z nich korzystają.
+ */
+void PolyImageRelease(void);
+
+#endif //POLYNOMIALS_POLY_IMAGE_H
@@ -0,0 +1,340 @@
+/** @file
+ * Implementacja modułu odpowiedzialnego za mnożenie gęstych wektorów
+ * współczynników za pomocą liczbowej transformaty Fouriera.
+ * Wszystkie obliczenia modulo liczby pierwsze wykonywane są w reprezentacji
+ * Montgomery'ego z @f$R = 2^{64}@f$. Redukcje zapisane są bez rozgałęzień,
+ * bo wyniki porównań w motylkach transformaty są nieprzewidywalne.
+ *
+ * @author Jan Kwiatkowski
+ */
+
+#include "poly_ntt.h"
+#include "utilities.h"
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <assert.h>
+
+/** Liczba liczb pierwszych wykorzystywanych w NTT. */
+#define NTT_PRIMES 3
+
+/** Typ 128-bitowej liczby bez znaku. */
+typedef unsigned __int128 uint128_t;
+
+/**
+ * Struktura przechowująca liczbę pierwszą postaci @f$c \cdot 2^k + 1@f$
+ * wraz ze stałymi potrzebnymi do arytmetyki Montgomery'ego.
+ */
+typedef struct NttPrime {
+    uint64_t p; ///< liczba pierwsza
+    uint64_t g; ///< generator grupy multiplikatywnej modulo @p p
+    uint64_t neg_inv; ///< @f$-p^{-1} \bmod 2^{64}@f$
+    uint64_t r2; ///< @f$R^2 \bmod p@f$
+} NttPrime;
+
+/** Liczby pierwsze, modulo które wyznaczane są iloczyny. */
+static NttPrime primes[NTT_PRIMES] = {
+        {.p = 0x3fffffee00000001UL, .g = 3},
+        {.p = 0x3fffffb400000001UL, .g = 19},
+        {.p = 0x3fffffa000000001UL, .g = 3},
+};
+
+/** Zapewnia jednokrotne wyznaczenie stałych w @ref primes. */
+static pthread_once_t primes_once = PTHREAD_ONCE_INIT;
+
+/** @f$p_0^{-1} \bmod p_1@f$ w reprezentacji Montgomery'ego modulo @f$p_1@f$. */
+static uint64_t inv_p0_mod_p1;
+
+/** @f$(p_0 p_1)^{-1} \bmod p_2@f$ w reprezentacji Montgomery'ego modulo
+ * @f$p_2@f$. */
+static uint64_t inv_p0p1_mod_p2;
+
+/** @f$p_0 \bmod p_2@f$ w reprezentacji Montgomery'ego modulo @f$p_2@f$. */
+static uint64_t p0_mod_p2;
+
+/**
+ * Redukcja Montgomery'ego.
+ * @param[in] pr : liczba pierwsza
+ * @param[in] t : liczba mniejsza od @f$p \cdot R@f$
+ * @return @f$t R^{-1} \bmod p@f$
+ */
+static inline uint64_t MontReduce(const NttPrime *pr, uint128_t t) {
+    uint64_t m = (uint64_t) t * pr->neg_inv;
+    uint64_t r = (uint64_t) ((t + (uint128_t) m * pr->p) >> 64);
+    return r - (pr->p & -(uint64_t) (r >= pr->p));
+}
+
+/**
+ * Mnoży dwie liczby w reprezentacji Montgomery'ego.
+ * @param[in] pr : liczba pierwsza
+ * @param[in] a : pierwszy czynnik
+ * @param[in] b : drugi czynnik
+ * @return iloczyn w reprezentacji Montgomery'ego
+ */
+static inline uint64_t MontMul(const NttPrime *pr, uint64_t a, uint64_t b) {
+    return MontReduce(pr, (uint128_t) a * b);
+}
+
+/**
+ * Zamienia dowolną 64-bitową liczbę na jej resztę modulo @p pr
+ * w reprezentacji Montgomery'ego.
+ * @param[in] pr : liczba pierwsza
+ * @param[in] a : liczba
+ * @return @f$a R \bmod p@f$
+ */
+static inline uint64_t ToMont(const NttPrime *pr, uint64_t a) {
+    return MontReduce(pr, (uint128_t) a * pr->r2);
+}
+
+/**
+ * Dodaje dwie reszty modulo @p pr.
+ * @param[in] pr : liczba pierwsza
+ * @param[in] a : reszta
+ * @param[in] b : reszta
+ * @return @f$(a + b) \bmod p@f$
+ */
+static inline uint64_t AddMod(const NttPrime *pr, uint64_t a, uint64_t b) {
+    uint64_t r = a + b;
+    return r - (pr->p & -(uint64_t) (r >= pr->p));
+}
+
+/**
+ * Odejmuje dwie reszty modulo @p pr.
+ * @param[in] pr : liczba pierwsza
+ * @param[in] a : reszta
+ * @param[in] b : reszta
+ * @return @f$(a - b) \bmod p@f$
+ */
+static inline uint64_t SubMod(const NttPrime *pr, uint64_t a, uint64_t b) {
+    return a - b + (pr->p & -(uint64_t) (a < b));
+}
+
+/**
+ * Podnosi liczbę w reprezentacji Montgomery'ego do potęgi.
+ * @param[in] pr : liczba pierwsza
+ * @param[in] base : podstawa w reprezentacji Montgomery'ego
+ * @param[in] exp : wykładnik
+ * @return potęga w reprezentacji Montgomery'ego
+ */
+static uint64_t MontPow(const NttPrime *pr, uint64_t base, uint64_t exp) {
+    uint64_t ret = ToMont(pr, 1);
+    while (exp > 0) {
+        if (exp % 2 == 1)
+            ret = MontMul(pr, ret, base);
+        base = MontMul(pr, base, base);
+        exp /= 2;
+    }
+    return ret;
+}
+
+/**
+ * Wyznacza stałe arytmetyki Montgomery'ego oraz stałe chińskiego twierdzenia
+ * o resztach.
+ */
+static void NttComputeConstants(void) {
+    for (size_t k = 0; k < NTT_PRIMES; k++) {
+        NttPrime *pr = &primes[k];
+        // odwrotność modulo 2^64 metodą Newtona
+        uint64_t inv = pr->p;
+        for (int i = 0; i < 6; i++)
+            inv *= 2 - pr->p * inv;
+        pr->neg_inv = -inv;
+        uint64_t r = -pr->p % pr->p;
+        pr->r2 = (uint64_t) ((uint128_t) r * r % pr->p);
+    }
+
+    const NttPrime *p1 = &primes[1], *p2 = &primes[2];
+    uint64_t p0_mont_1 = ToMont(p1, primes[0].p);
+    inv_p0_mod_p1 = MontPow(p1, p0_mont_1, p1->p - 2);
+    p0_mod_p2 = ToMont(p2, primes[0].p);
+    uint64_t p0p1_mont_2 = MontMul(p2, p0_mod_p2, ToMont(p2, p1->p));
+    inv_p0p1_mod_p2 = MontPow(p2, p0p1_mont_2, p2->p - 2);
+}
+
+/**
+ * Wyznacza stałe przy pierwszym wywołaniu, także gdy mnożenie wykonywane
+ * jest jednocześnie przez kilka wątków.
+ */
+static void NttInit(void) {
+    pthread_once(&primes_once, NttComputeConstants);
+}
+
+/**
+ * Wyznacza pierwiastki z jedności potrzebne we wszystkich etapach
+ * transformaty. Pierwiastki wykorzystywane w etapie łączącym bloki długości
+ * @f$h@f$ zapisywane są na pozycjach @f$h, \ldots, 2h - 1@f$.
+ * @param[in] pr : liczba pierwsza
+ * @param[out] roots : tablica długości @p n
+ * @param[in] n : długość transformaty, potęga dwójki
+ * @param[in] inverse : czy wyznaczyć pierwiastki dla transformaty odwrotnej
+ */
+static void NttRoots(const NttPrime *pr, uint64_t *roots, size_t n,
+                     bool inverse) {
+    if (n < 2)
+        return;
+
+    size_t half = n / 2;
+    uint64_t w = MontPow(pr, ToMont(pr, pr->g), (pr->p - 1) / n);
+    if (inverse)
+        w = MontPow(pr, w, pr->p - 2);
+
+    roots[half] = ToMont(pr, 1);
+    for (size_t j = 1; j < half; j++)
+        roots[half + j] = MontMul(pr, roots[half + j - 1], w);
+
+    // pierwiastek stopnia h jest kwadratem pierwiastka stopnia 2h
+    for (size_t j = half - 1; j > 0; j--)
+        roots[j] = roots[2 * j];
+}
+
+/**
+ * Wykonuje w miejscu transformatę wektora w reprezentacji Montgomery'ego
+ * (algorytm z podziałem w dziedzinie częstotliwości). Wynik zapisywany jest
+ * w kolejności odwróconych bitów indeksów, co nie przeszkadza w mnożeniu po
+ * współrzędnych i pozwala pominąć permutację.
+ * @param[in] pr : liczba pierwsza
+ * @param[in,out] a : wektor długości @p n
+ * @param[in] n : długość wektora, potęga dwójki
+ * @param[in] roots : pierwiastki z jedności wyznaczone przez
+ * @ref NttRoots(const NttPrime *pr, uint64_t *roots, size_t n, bool inverse)
+ */
+static void NttForward(const NttPrime *pr, uint64_t *a, size_t n,
+                       const uint64_t *roots) {
+    for (size_t half = n / 2; half >= 1; half >>= 1) {
+        const uint64_t *w = roots + half;
+        for (size_t i = 0; i < n; i += 2 * half) {
+            for (size_t j = 0; j < half; j++) {
+                uint64_t u = a[i + j];
+                uint64_t v = a[i + j + half];
+                a[i + j] = AddMod(pr, u, v);
+                a[i + j + half] = MontMul(pr, SubMod(pr, u, v), w[j]);
+            }
+        }
+    }
+}
+
+/**
+ * Wykonuje w miejscu transformatę odwrotną (bez dzielenia przez długość)
+ * wektora zapisanego w kolejności odwróconych bitów indeksów (algorytm
+ * z podziałem w dziedzinie czasu). Wynik zapisywany jest w zwykłej kolejności.
+ * @param[in] pr : liczba pierwsza
+ * @param[in,out] a : wektor długości @p n
+ * @param[in] n : długość wektora, potęga dwójki
+ * @param[in] roots : pierwiastki z jedności dla transformaty odwrotnej
+ * wyznaczone przez @ref NttRoots(const NttPrime *pr, uint64_t *roots,
+ * size_t n, bool inverse)
+ */
+static void NttInverse(const NttPrime *pr, uint64_t *a, size_t n,
+                       const uint64_t *roots) {
+    for (size_t half = 1; half < n; half <<= 1) {
+        const uint64_t *w = roots + half;
+        for (size_t i = 0; i < n; i += 2 * half) {
+            for (size_t j = 0; j < half; j++) {
+                uint64_t u = a[i + j];
+                uint64_t v = MontMul(pr, a[i + j + half], w[j]);
+                a[i + j] = AddMod(pr, u, v);
+                a[i + j + half] = SubMod(pr, u, v);
+            }
+        }
+    }
+}
+
+/**
+ * Wyznacza iloczyn wektorów modulo jedna z liczb pierwszych.
+ * @param[in] prime : liczba pierwsza
+ * @param[in] a : pierwszy czynnik
+ * @param[in] n : długość @p a
+ * @param[in] b : drugi czynnik
+ * @param[in] m : długość @p b
+ * @param[in] size : długość transformaty
+ * @param[out] res : reszty kolejnych współczynników iloczynu (poza
+ * reprezentacją Montgomery'ego), tablica długości @p n + @p m - 1
+ * @param[in] fa : tablica pomocnicza długości @p size
+ * @param[in] fb : tablica pomocnicza długości @p size
+ * @param[in] roots : tablica pomocnicza długości @p size
+ */
+static void NttMulModPrime(const NttPrime *prime, const uint64_t *a, size_t n,
+                           const uint64_t *b, size_t m, size_t size,
+                           uint64_t *res, uint64_t *fa, uint64_t *fb,
+                           uint64_t *roots) {
+    // lokalna kopia pozwala kompilatorowi trzymać stałe w rejestrach,
+    // bo zapisy do tablic nie mogą jej zmienić
+    const NttPrime local = *prime;
+    const NttPrime *pr = &local;
+
+    for (size_t i = 0; i < size; i++) {
+        fa[i] = i < n ? ToMont(pr, a[i]) : 0;
+        fb[i] = i < m ? ToMont(pr, b[i]) : 0;
+    }
+
+    NttRoots(pr, roots, size, false);
+    NttForward(pr, fa, size, roots);
+    NttForward(pr, fb, size, roots);
+
+    // odwrotność długości transformaty wliczamy w mnożenie po współrzędnych
+    uint64_t size_inv = MontPow(pr, ToMont(pr, size), pr->p - 2);
+    for (size_t i = 0; i < size; i++)
+        fa[i] = MontMul(pr, MontMul(pr, fa[i], fb[i]), size_inv);
+
+    NttRoots(pr, roots, size, true);
+    NttInverse(pr, fa, size, roots);
+
+    for (size_t i = 0; i < n + m - 1; i++)
+        res[i] = MontReduce(pr, fa[i]);
+}
+
+void NttMul(const poly_coeff_t a[], size_t n, const poly_coeff_t b[],
+            size_t m, poly_coeff_t out[]) {
+    assert(n > 0 && m > 0);
+    NttInit();
+
+    size_t length = n + m - 1;
+    size_t size = 1;
+    while (size < length)
+        size *= 2;
+
+    uint64_t *res = SafeMalloc(NTT_PRIMES * length * sizeof(uint64_t));
+    uint64_t *fa = SafeMalloc(size * sizeof(uint64_t));
+    uint64_t *fb = SafeMalloc(size * sizeof(uint64_t));
+    uint64_t *roots = SafeMalloc(size * sizeof(uint64_t));
+
+    for (size_t k = 0; k < NTT_PRIMES; k++) {
+        NttMulModPrime(&primes[k], (const uint64_t *) a, n,
+                       (const uint64_t *) b, m, size, res + k * length,
+                       fa, fb, roots);
+    }
+
+    // odtwarzamy współczynniki algorytmem Garnera:
+    // x = r0 + p0 * t1 + p0 * p1 * t2, gdzie t1 < p1 oraz t2 < p2,
+    // a wynik modulo 2^64 wyznaczamy zwykłą arytmetyką bez znaku
+    const NttPrime *p1 = &primes[1], *p2 = &primes[2];
+    const uint64_t *r0 = res, *r1 = res + length, *r2 = res + 2 * length;
+    for (size_t i = 0; i < length; i++) {
+        uint64_t t1 = MontMul(p1, SubMod(p1, r1[i], r0[i] % p1->p),
+                              inv_p0_mod_p1);
+        uint64_t partial = AddMod(p2, r0[i] % p2->p,
+                                  MontMul(p2, t1 % p2->p, p0_mod_p2));
+        uint64_t t2 = MontMul(p2, SubMod(p2, r2[i], partial), inv_p0p1_mod_p2);
+        uint64_t x = r0[i] + primes[0].p * (t1 + p1->p * t2);
+        out[i] = (poly_coeff_t) x;
+    }
+
+    free(res);
+    free(fa);
+    free(fb);
+    free(roots);
+}
+
+double NttMulCost(size_t length) {
+    double size = 1;
+    double log_size = 0;
+    while (size < (double) length) {
+        size *= 2;
+        log_size++;
+    }
+
+    // trzy transformaty o koszcie size / 2 * log(size) motylków dla każdej
+    // z liczb pierwszych, motylek kosztuje kilka zwykłych mnożeń
+    return NTT_PRIMES * 3.0 * size / 2 * log_size * 4.0;
+}
@@ -0,0 +1,46 @@
+/** @file
+ * Interfejs modułu odpowiedzialnego za mnożenie gęstych wektorów
+ * współczynników za pomocą liczbowej transformaty Fouriera (NTT).
+ * Iloczyn wyznaczany jest modulo trzy liczby pierwsze mniejsze od
+ * @f$2^{62}@f$, a następnie odtwarzany za pomocą chińskiego twierdzenia
+ * o resztach. Iloczyn tych liczb przekracza @f$n \cdot 2^{128}@f$, więc
+ * odtworzona wartość jest dokładna i daje ten sam wynik modulo @f$2^{64}@f$
+ * co arytmetyka na typie @ref poly_coeff_t.
+ *
+ * @author Jan Kwiatkowski
+ */
+
+#ifndef POLYNOMIALS_POLY_NTT_H
+#define POLYNOMIALS_POLY_NTT_H
+
+#include "poly.h"
+
+/**
+ * Długość krótszego czynnika, od której gęste wektory mnożone są za pomocą
+ * NTT zamiast algorytmem Karatsuby. Wartość dobrana na podstawie wyników
+ * programu `poly_bench`.
+ */
+#define NTT_THRESHOLD 4096
+
+/**
+ * Mnoży dwa gęste wektory współczynników za pomocą NTT.
+ * @param[in] a : współczynniki pierwszego czynnika
+ * @param[in] n : długość tablicy @p a, dodatnia
+ * @param[in] b : współczynniki drugiego czynnika
+ * @param[in] m : długość tablicy @p b, dodatnia
+ * @param[out] out : tablica długości @p n + @p m - 1, w której zapisywany
+ * jest wynik
+ */
+void NttMul(const poly_coeff_t a[], size_t n, const poly_coeff_t b[],
+            size_t m, poly_coeff_t out[]);
+
+/**
+ * Szacuje koszt mnożenia za pomocą NTT wektorów, których iloczyn ma zadaną
+ * długość.
+ * @param[in] length : długość iloczynu
+ * @return szacowana liczba operacji, porównywalna z liczbą mnożeń w algorytmie
+ * szkolnym
+ */
+double NttMulCost(size_t length);
+
+#endif //POLYNOMIALS_POLY_NTT_H
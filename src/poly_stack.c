@@ -16,11 +16,14 @@
 static void StackIncreaseSize(Stack *stack) {
     stack->arr_size *= 2;
     stack->arr = SafeRealloc(stack->arr, stack->arr_size * sizeof(Poly));
+    stack->plans = SafeRealloc(stack->plans,
+                               stack->arr_size * sizeof(PolyEvalPlan *));
 }
 
 Stack* StackCreate() {
     Stack *stack = SafeMalloc(sizeof(Stack));
     stack->arr = SafeMalloc(INIT_STACK_ARR_SIZE * sizeof(Poly));
+    stack->plans = SafeMalloc(INIT_STACK_ARR_SIZE * sizeof(PolyEvalPlan *));
     stack->arr_size = INIT_STACK_ARR_SIZE;
     stack->size = 0;
     return stack;
@@ -37,6 +40,7 @@ bool StackUnderflow(Stack *stack, size_t size) {
 void StackPush(Stack *stack, Poly *p) {
     if (stack->arr_size == stack->size)
         StackIncreaseSize(stack);
+    stack->plans[stack->size] = NULL;
     stack->arr[stack->size++] = *p;
 }
 
@@ -45,6 +49,14 @@ Poly* StackTop(Stack *stack) {
     return &stack->arr[stack->size - 1];
 }
 
+PolyEvalPlan* StackTopPlan(Stack *stack) {
+    assert(!StackIsEmpty(stack));
+    PolyEvalPlan **plan = &stack->plans[stack->size - 1];
+    if (*plan == NULL)
+        *plan = PolyEvalPlanCompile(StackTop(stack));
+    return *plan;
+}
+
 Poly* StackPrevTop(Stack *stack) {
     assert(!StackUnderflow(stack, 2));
     return &stack->arr[stack->size - 2];
@@ -52,7 +64,20 @@ Poly* StackPrevTop(Stack *stack) {
 
 Poly* StackPop(Stack *stack) {
     assert(!StackIsEmpty(stack));
-    return &stack->arr[--stack->size];
+    stack->size--;
+    PolyEvalPlanDestroy(stack->plans[stack->size]);
+    stack->plans[stack->size] = NULL;
+    return &stack->arr[stack->size];
+}
+
+void StackMap(Stack *stack, Poly (*f)(const Poly *p)) {
+    for (size_t i = 0; i < stack->size; i++) {
+        Poly mapped = f(&stack->arr[i]);
+        PolyDestroy(&stack->arr[i]);
+        stack->arr[i] = mapped;
+        PolyEvalPlanDestroy(stack->plans[i]);
+        stack->plans[i] = NULL;
+    }
 }
 
 void StackClear(Stack *stack) {
@@ -61,5 +86,6 @@ void StackClear(Stack *stack) {
         PolyDestroy(poly);
     }
     free(stack->arr);
+    free(stack->plans);
     free(stack);
 }
@@ -8,6 +8,7 @@
 #define POLYNOMIALS_POLY_STACK_H
 
 #include "poly.h"
+#include "poly_eval.h"
 
 /** Początkowy rozmiar tablicy utrzymującej stos. */
 #define INIT_STACK_ARR_SIZE 16
@@ -20,7 +21,12 @@ typedef struct Stack {
      * Tablica wielomianów utrzymująca stos.
      */
     Poly *arr;
-    size_t arr_size; ///< rozmiar tablicy @p arr
+    /**
+     * Tablica planów obliczeń wielomianów z tablicy @p arr, kompilowanych
+     * przy pierwszym użyciu (NULL, jeśli plan nie został jeszcze utworzony).
+     */
+    PolyEvalPlan **plans;
+    size_t arr_size; ///< rozmiar tablic @p arr i @p plans
     size_t size; ///< ilość wielomianów w tablicy @p arr
 } Stack;
 
@@ -59,6 +65,14 @@ void StackPush(Stack *stack, Poly *p);
  */
 Poly* StackTop(Stack *stack);
 
+/**
+ * Zwraca plan obliczeń wielomianu z wierzchołka stosu, kompilując go, jeśli
+ * nie został jeszcze utworzony. Plan jest usuwany razem z wielomianem.
+ * @param[in,out] stack : stos
+ * @return plan obliczeń wielomianu z wierzchołka stosu @p stack
+ */
+PolyEvalPlan* StackTopPlan(Stack *stack);
+
 /**
  * Zwraca drugi od góry wielomian ze stosu.
  * @param[in] stack : stos
@@ -73,6 +87,14 @@ Poly* StackPrevTop(Stack *stack);
  */
 Poly* StackPop(Stack *stack);
 
+/**
+ * Zastępuje każdy wielomian @f$p@f$ na stosie wielomianem @f$f(p)@f$
+ * i usuwa plany obliczeń zastąpionych wielomianów.
+ * @param[in,out] stack : stos
+ * @param[in] f : funkcja przekształcająca wielomian
+ */
+void StackMap(Stack *stack, Poly (*f)(const Poly *p));
+
 /**
  * Usuwa wszystkie wielomiany ze stosu oraz sam stos.
  * @param[in,out] stack : stos
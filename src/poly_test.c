@@ -2,11 +2,30 @@
 #undef NDEBUG
 #endif
 
+#define _POSIX_C_SOURCE 200809L
+
 #include "poly.h"
+#include "big_coeff.h"
+#include "coeff_mod.h"
+#include "mono_pool.h"
+#include "output.h"
+#include "poly_dense.h"
+#include "poly_ntt.h"
+#include "poly_binary.h"
+#include "poly_eval.h"
+#include "poly_image.h"
+#include "power_cache.h"
+#include "thread_pool.h"
 #include <assert.h>
 #include <stdbool.h>
 #include <stdarg.h>
+#include <stdatomic.h>
+#include <limits.h>
+#include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
 
 #define CHECK_PTR(p)  \
   do {                \
@@ -208,6 +227,46 @@ static bool SimpleAddMonosTest(void) {
     return res;
 }
 
+static bool TestUnsortedMonos(size_t n, size_t distinct, size_t mult,
+                              poly_exp_t stride) {
+    Mono *monos = calloc(n, sizeof(Mono));
+    CHECK_PTR(monos);
+    poly_coeff_t *sums = calloc(distinct, sizeof(poly_coeff_t));
+    CHECK_PTR(sums);
+    for (size_t i = 0; i < n; i++) {
+        size_t k = (i * mult) % distinct;
+        sums[k] += (poly_coeff_t) i + 1;
+        monos[i] = M(C((poly_coeff_t) i + 1), (poly_exp_t) k * stride);
+    }
+
+    Mono *expected = calloc(distinct, sizeof(Mono));
+    CHECK_PTR(expected);
+    size_t count = 0;
+    for (size_t k = 0; k < distinct; k++)
+        if (sums[k] != 0)
+            expected[count++] = M(C(sums[k]), (poly_exp_t) k * stride);
+    free(sums);
+
+    Poly res = PolyAddMonos(n, monos);
+    free(monos);
+    return TestEq(res, PolyOwnMonos(count, expected), true);
+}
+
+static bool SortMonosTest(void) {
+    bool res = true;
+    // sortowanie introsort, w tym fragmenty sortowane przez wstawianie
+    res &= TestUnsortedMonos(5, 5, 3, 1);
+    res &= TestUnsortedMonos(100, 100, 99, 1);
+    res &= TestUnsortedMonos(200, 37, 11, 1000);
+    res &= TestUnsortedMonos(255, 1, 1, 1);
+    // sortowanie pozycyjne, również po najbardziej znaczącej cyfrze
+    res &= TestUnsortedMonos(256, 256, 255, 1);
+    res &= TestUnsortedMonos(5000, 5000, 7919, 400000);
+    res &= TestUnsortedMonos(20000, 300, 17, 1 << 16);
+    res &= TestUnsortedMonos(4096, 2, 1, 1 << 30);
+    return res;
+}
+
 static bool SimpleMulTest(void) {
     bool res = true;
     res &= TestMul(C(2),
@@ -231,6 +290,269 @@ static bool SimpleMulTest(void) {
     return res;
 }
 
+static bool HeapMulTest(void) {
+    bool res = true;
+    // (1 + x + ... + x^9)(1 - x) = 1 - x^10
+    Mono m[10];
+    for (size_t i = 0; i < 10; i++)
+        m[i] = M(C(1), (poly_exp_t) i);
+    Poly a = PolyAddMonos(10, m);
+    res &= TestMul(PolyClone(&a),
+                   P(C(1), 0, C(-1), 1),
+                   P(C(1), 0, C(-1), 10));
+    // (y + 1)(1 + x + ... + x^9)(1 - x) = (y + 1) - (y + 1)x^10
+    for (size_t i = 0; i < 10; i++)
+        m[i] = M(P(C(1), 0, C(1), 1), (poly_exp_t) i);
+    Poly b = PolyAddMonos(10, m);
+    res &= TestMul(P(C(1), 0, C(-1), 1),
+                   PolyClone(&b),
+                   P(P(C(1), 0, C(1), 1), 0, P(C(-1), 0, C(-1), 1), 10));
+    // (1 + x + ... + x^9)^2
+    Mono sq[19];
+    for (size_t i = 0; i < 19; i++)
+        sq[i] = M(C(i < 10 ? (poly_coeff_t) i + 1 : 19 - (poly_coeff_t) i),
+                  (poly_exp_t) i);
+    res &= TestMul(PolyClone(&a),
+                   PolyClone(&a),
+                   PolyAddMonos(19, sq));
+    PolyDestroy(&a);
+    PolyDestroy(&b);
+    return res;
+}
+
+static bool DenseMulTest(void) {
+    bool res = true;
+    // (1 + x + ... + x^39)^2
+    Mono m[79];
+    for (size_t i = 0; i < 40; i++)
+        m[i] = M(C(1), (poly_exp_t) i);
+    Poly a = PolyAddMonos(40, m);
+    for (size_t i = 0; i < 79; i++)
+        m[i] = M(C(i < 40 ? (poly_coeff_t) i + 1 : 79 - (poly_coeff_t) i),
+                 (poly_exp_t) i);
+    res &= TestMul(PolyClone(&a),
+                   PolyClone(&a),
+                   PolyAddMonos(79, m));
+    // (1 + y + ... + y^5)(1 + x + ... + x^5)(1 - x)
+    //     = (1 + y + ... + y^5) - (1 + y + ... + y^5)x^6
+    Mono y[6];
+    for (size_t i = 0; i < 6; i++)
+        y[i] = M(C(1), (poly_exp_t) i);
+    Poly b = PolyAddMonos(6, y);
+    for (size_t i = 0; i < 6; i++)
+        m[i] = M(PolyClone(&b), (poly_exp_t) i);
+    Poly c = PolyAddMonos(6, m);
+    Poly neg_b = PolyNeg(&b);
+    res &= TestMul(c,
+                   P(C(1), 0, C(-1), 1),
+                   P(PolyClone(&b), 0, neg_b, 6));
+    PolyDestroy(&a);
+    PolyDestroy(&b);
+    return res;
+}
+
+static bool NttMulTest(void) {
+    // (1 + x + ... + x^4999)^2
+    const size_t n = 5000;
+    Mono *m = calloc(2 * n - 1, sizeof(Mono));
+    CHECK_PTR(m);
+    for (size_t i = 0; i < n; i++)
+        m[i] = M(C(1), (poly_exp_t) i);
+    Poly a = PolyAddMonos(n, m);
+    for (size_t i = 0; i < 2 * n - 1; i++) {
+        poly_coeff_t c = i < n ? (poly_coeff_t) (i + 1)
+                               : (poly_coeff_t) (2 * n - 1 - i);
+        m[i] = M(C(c), (poly_exp_t) i);
+    }
+    Poly sq = PolyAddMonos(2 * n - 1, m);
+    bool res = TestMul(PolyClone(&a), a, sq);
+
+    // współczynniki z pełnego zakresu, iloczyny odtwarzane modulo 2^64
+    poly_coeff_t *u = calloc(n, sizeof(poly_coeff_t));
+    poly_coeff_t *v = calloc(n, sizeof(poly_coeff_t));
+    poly_coeff_t *ntt = calloc(2 * n - 1, sizeof(poly_coeff_t));
+    poly_coeff_t *kar = calloc(2 * n - 1, sizeof(poly_coeff_t));
+    CHECK_PTR(u);
+    CHECK_PTR(v);
+    CHECK_PTR(ntt);
+    CHECK_PTR(kar);
+    unsigned long state = 88172645463325252UL;
+    for (size_t i = 0; i < n; i++) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        u[i] = i % 3 == 0 ? LONG_MIN : (poly_coeff_t) state;
+        v[i] = i % 5 == 0 ? LONG_MAX : (poly_coeff_t) (state * 31);
+    }
+    NttMul(u, n, v, n, ntt);
+    KaratsubaMul(u, n, v, n, kar);
+    res &= memcmp(ntt, kar, (2 * n - 1) * sizeof(poly_coeff_t)) == 0;
+
+    for (size_t i = 0; i < n; i++)
+        m[i] = M(C(u[i]), (poly_exp_t) i);
+    Poly pu = PolyAddMonos(n, m);
+    for (size_t i = 0; i < n; i++)
+        m[i] = M(C(v[i]), (poly_exp_t) i);
+    Poly pv = PolyAddMonos(n, m);
+    for (size_t i = 0; i < 2 * n - 1; i++)
+        m[i] = M(C(kar[i]), (poly_exp_t) i);
+    res &= TestMul(pu, pv, PolyAddMonos(2 * n - 1, m));
+
+    free(u);
+    free(v);
+    free(ntt);
+    free(kar);
+    free(m);
+    return res;
+}
+
+static Poly SparsePoly(size_t n, poly_exp_t scale, poly_coeff_t shift) {
+    Mono *m = calloc(n, sizeof(Mono));
+    CHECK_PTR(m);
+    for (size_t i = 0; i < n; i++) {
+        poly_coeff_t c = (poly_coeff_t) i + shift;
+        m[i] = M(P(C(c), 0, C(c * c), (poly_exp_t) (i % 3) + 1),
+                 (poly_exp_t) (i * i) * scale);
+    }
+    Poly ret = PolyAddMonos(n, m);
+    free(m);
+    return ret;
+}
+
+static bool ParallelMulTest(void) {
+    bool res = true;
+    Poly a = SparsePoly(100, 1000, 1);
+    Poly b = SparsePoly(120, 997, -200);
+    Poly c = SparsePoly(2, 1, 7);
+    Poly d = SparsePoly(3000, 3, 1L << 20);
+
+    ThreadPoolInit(1);
+    Poly ab = PolyMul(&a, &b);
+    Poly cd = PolyMul(&c, &d);
+
+    // wynik nie zależy od liczby wątków, także gdy części jest mniej niż
+    // wątków
+    for (size_t threads = 2; threads <= 5; threads++) {
+        ThreadPoolInit(threads);
+        res &= ThreadPoolSize() == threads;
+        res &= TestEq(PolyMul(&a, &b), PolyClone(&ab), true);
+        res &= TestEq(PolyMul(&b, &a), PolyClone(&ab), true);
+        res &= TestEq(PolyMul(&c, &d), PolyClone(&cd), true);
+    }
+    ThreadPoolShutdown();
+    res &= ThreadPoolSize() == 1;
+
+    PolyDestroy(&a);
+    PolyDestroy(&b);
+    PolyDestroy(&c);
+    PolyDestroy(&d);
+    PolyDestroy(&ab);
+    PolyDestroy(&cd);
+    return res;
+}
+
+// liczniki wykonań zadań testu puli wątków
+static atomic_size_t pool_runs[64];
+
+static void CountTask(void *arg, size_t i) {
+    atomic_fetch_add(&pool_runs[(size_t) arg + i], 1);
+}
+
+static void NestedTask(void *arg, size_t i) {
+    (void) arg;
+    // jedno długie zadanie, na które inne wątki czekają, zasypiając
+    if (i == 0)
+        nanosleep(&(struct timespec) {.tv_sec = 0, .tv_nsec = 20000000},
+                  NULL);
+    ThreadPoolRun(8, CountTask, (void *) (8 * i));
+}
+
+static bool ThreadPoolTest(void) {
+    bool res = true;
+    for (size_t threads = 1; threads <= 5; threads++) {
+        ThreadPoolInit(threads);
+        for (size_t round = 0; round < 5; round++) {
+            for (size_t i = 0; i < 64; i++)
+                atomic_store(&pool_runs[i], 0);
+            ThreadPoolRun(8, NestedTask, NULL);
+            for (size_t i = 0; i < 64; i++)
+                res &= atomic_load(&pool_runs[i]) == 1;
+        }
+    }
+    ThreadPoolShutdown();
+    return res;
+}
+
+static bool ParallelComposeTest(void) {
+    bool res = true;
+    // p = x_0^2 + x_0 x_1 + 3, q = (x_0 + 1, 2)
+    Poly p = P(C(3), 0, P(C(1), 1), 1, C(1), 2);
+    Poly q[2] = {P(C(1), 0, C(1), 1), C(2)};
+    Poly r = P(C(6), 0, C(4), 1, C(1), 2);
+    Poly big = SparsePoly(8, 1, 1);
+    Poly big_q[2] = {SparsePoly(2, 1, 2), SparsePoly(2, 1, 5)};
+
+    ThreadPoolInit(1);
+    res &= TestEq(PolyCompose(&p, 2, q), PolyClone(&r), true);
+    Poly composed = PolyCompose(&big, 2, big_q);
+    for (size_t threads = 2; threads <= 4; threads++) {
+        ThreadPoolInit(threads);
+        res &= TestEq(PolyCompose(&p, 2, q), PolyClone(&r), true);
+        res &= TestEq(PolyCompose(&big, 2, big_q), PolyClone(&composed),
+                      true);
+    }
+    ThreadPoolShutdown();
+
+    PolyDestroy(&p);
+    PolyDestroy(&q[0]);
+    PolyDestroy(&r);
+    PolyDestroy(&big);
+    PolyDestroy(&big_q[0]);
+    PolyDestroy(&big_q[1]);
+    PolyDestroy(&composed);
+    return res;
+}
+
+static bool PowerCacheTest(void) {
+    bool res = true;
+    PowerCacheClear();
+    // p = x_0^3 + 1, q = x_0 + 1
+    Poly p = P(C(1), 0, C(1), 3);
+    Poly q = P(C(1), 0, C(1), 1);
+    Poly r = P(C(2), 0, C(3), 1, C(3), 2, C(1), 3);
+    res &= TestEq(PolyCompose(&p, 1, &q), PolyClone(&r), true);
+    PowerCacheStats stats = PowerCacheGetStats();
+    res &= stats.entries == 1 && stats.misses == 1 && stats.hits == 0;
+
+    // równy wielomian o innej tablicy jednomianów trafia w ten sam wpis
+    Poly q_copy = P(C(1), 0, C(1), 1);
+    res &= TestEq(PolyCompose(&p, 1, &q_copy), PolyClone(&r), true);
+    stats = PowerCacheGetStats();
+    res &= stats.entries == 1 && stats.hits == 1;
+
+    // wyższa potęga wydłuża tablicę
+    Poly p9 = P(C(1), 9);
+    Poly q9 = PolyCompose(&p9, 1, &q);
+    stats = PowerCacheGetStats();
+    res &= stats.entries == 1 && stats.extensions == 1;
+    PowerCacheClear();
+    res &= TestEq(PolyCompose(&p9, 1, &q), q9, true);
+    stats = PowerCacheGetStats();
+    res &= stats.entries == 1 && stats.misses == 1 && stats.hits == 0;
+    res &= stats.terms == PolyTermCount(&q) + 3 + 5 + 9;
+
+    PowerCacheClear();
+    stats = PowerCacheGetStats();
+    res &= stats.entries == 0 && stats.terms == 0;
+
+    PolyDestroy(&p);
+    PolyDestroy(&q);
+    PolyDestroy(&r);
+    PolyDestroy(&q_copy);
+    PolyDestroy(&p9);
+    return res;
+}
+
 static bool SimpleNegTest(void) {
     Poly a = P(P(C(1), 0, C(2), 2), 0, P(C(1), 1), 1, C(1), 2);
     Poly b = PolyNeg(&a);
@@ -249,6 +571,146 @@ static bool SimpleSubTest(void) {
                    P(P(C(1), 0, C(4), 1, C(1), 2), 1));
 }
 
+static bool TestAddTo(Poly acc, Poly x, Poly res) {
+    PolyAddTo(&acc, &x);
+    bool is_eq = PolyIsEq(&acc, &res);
+    PolyDestroy(&acc);
+    PolyDestroy(&x);
+    PolyDestroy(&res);
+    return is_eq;
+}
+
+static bool TestMulAddTo(Poly acc, Poly a, Poly b, Poly res) {
+    PolyMulAddTo(&acc, &a, &b);
+    bool is_eq = PolyIsEq(&acc, &res);
+    PolyDestroy(&acc);
+    PolyDestroy(&a);
+    PolyDestroy(&b);
+    PolyDestroy(&res);
+    return is_eq;
+}
+
+static bool AccumulateTest(void) {
+    bool res = true;
+    res &= TestAddTo(C(1), C(2), C(3));
+    res &= TestAddTo(C(1), P(C(1), 1), P(C(1), 0, C(1), 1));
+    res &= TestAddTo(P(C(1), 0, C(1), 1), C(-1), P(C(1), 1));
+    res &= TestAddTo(P(C(1), 1, C(1), 5), P(C(1), 0, C(2), 3, C(1), 7),
+                     P(C(1), 0, C(1), 1, C(2), 3, C(1), 5, C(1), 7));
+    res &= TestAddTo(P(C(1), 0, P(C(1), 1), 2), P(C(-1), 0, P(C(-1), 1), 2),
+                     C(0));
+    res &= TestAddTo(P(P(C(1), 1), 1, C(1), 2), P(P(C(1), 0, C(-1), 1), 1),
+                     P(C(1), 1, C(1), 2));
+    res &= TestMulAddTo(C(1), C(2), C(3), C(7));
+    res &= TestMulAddTo(P(C(1), 1), C(-1), P(C(1), 1), C(0));
+    res &= TestMulAddTo(C(1), P(C(1), 0, C(1), 1), P(C(1), 0, C(-1), 1),
+                        P(C(2), 0, C(-1), 2));
+    res &= TestMulAddTo(C(0), P(C(1L << 32), 1), C(1L << 32), C(0));
+
+    // acc i x to ten sam wielomian lub współdzielą tablicę jednomianów
+    Poly a = P(P(C(1), 0, C(2), 1), 0, P(C(3), 1), 1, P(C(1), 2), 2);
+    Poly b = PolyClone(&a);
+    PolyAddTo(&a, &a);
+    res &= TestEq(PolyClone(&a),
+                  P(P(C(2), 0, C(4), 1), 0, P(C(6), 1), 1, P(C(2), 2), 2),
+                  true);
+    PolyAddTo(&b, &b);
+    res &= PolyIsEq(&a, &b);
+    Poly c = PolyClone(&a);
+    PolyAddTo(&a, &c);
+    res &= TestEq(PolyClone(&a),
+                  P(P(C(4), 0, C(8), 1), 0, P(C(12), 1), 1, P(C(4), 2), 2),
+                  true);
+    res &= TestEq(PolyClone(&c),
+                  P(P(C(2), 0, C(4), 1), 0, P(C(6), 1), 1, P(C(2), 2), 2),
+                  true);
+    Poly three = C(3);
+    PolyMulAddTo(&b, &b, &three);
+    res &= TestEq(PolyClone(&b),
+                  P(P(C(8), 0, C(16), 1), 0, P(C(24), 1), 1, P(C(8), 2), 2),
+                  true);
+    PolyMulAddTo(&three, &c, &three);
+    res &= TestEq(PolyClone(&three),
+                  P(P(C(9), 0, C(12), 1), 0, P(C(18), 1), 1, P(C(6), 2), 2),
+                  true);
+    PolyDestroy(&a);
+    PolyDestroy(&b);
+    PolyDestroy(&c);
+    PolyDestroy(&three);
+
+    // 1 + x + ... + x^99 zsumowane po jednym jednomianie
+    Poly acc = PolyZero();
+    Mono m[100];
+    for (size_t i = 0; i < 100; i++) {
+        Poly x = P(C(1), (poly_exp_t) (99 - i));
+        PolyAddTo(&acc, &x);
+        PolyDestroy(&x);
+        m[i] = M(C(1), (poly_exp_t) i);
+    }
+    Poly sum = PolyAddMonos(100, m);
+    res &= PolyIsEq(&acc, &sum);
+    PolyDestroy(&acc);
+    PolyDestroy(&sum);
+    return res;
+}
+
+static bool MonoPoolTest(void) {
+    bool res = true;
+    Mono *arrs[300];
+    for (size_t i = 0; i < 300; i++) {
+        size_t n = i * 7 + 1;
+        arrs[i] = MonoArrayAlloc(n);
+        res &= MonoArrayCapacity(arrs[i]) >= n;
+        for (size_t j = 0; j < n; j++)
+            arrs[i][j] = (Mono) {.p = PolyFromCoeff((poly_coeff_t) i),
+                                 .exp = (poly_exp_t) j};
+    }
+    for (size_t i = 0; i < 300; i += 2)
+        MonoArrayFree(arrs[i]);
+    for (size_t i = 1; i < 300; i += 2) {
+        size_t n = i * 7 + 1, m = i % 4 == 1 ? 3 * n : n / 3 + 1;
+        arrs[i] = MonoArrayRealloc(arrs[i], m);
+        res &= MonoArrayCapacity(arrs[i]) >= m;
+        for (size_t j = 0; j < n && j < m; j++)
+            res &= arrs[i][j].p.coeff == (poly_coeff_t) i &&
+                   arrs[i][j].exp == (poly_exp_t) j;
+        MonoArrayFree(arrs[i]);
+    }
+    return res;
+}
+
+static bool SharedCloneTest(void) {
+    bool res = true;
+    Poly a = P(P(C(1), 0, C(2), 1), 0, P(C(3), 2), 2, C(4), 5);
+    Poly b = PolyClone(&a);
+    res &= a.arr == b.arr;
+
+    // modyfikacja kopii nie zmienia oryginału
+    Poly x = P(P(C(1), 1), 2);
+    PolyAddTo(&b, &x);
+    res &= a.arr != b.arr;
+    res &= TestEq(PolyClone(&a),
+                  P(P(C(1), 0, C(2), 1), 0, P(C(3), 2), 2, C(4), 5), true);
+    res &= TestEq(PolyClone(&b),
+                  P(P(C(1), 0, C(2), 1), 0, P(C(1), 1, C(3), 2), 2, C(4), 5),
+                  true);
+    // niezmienione poddrzewa są współdzielone
+    res &= a.arr[0].p.arr == b.arr[0].p.arr;
+
+    Poly sum = PolyAdd(&a, &x);
+    res &= sum.arr[0].p.arr == a.arr[0].p.arr;
+    Poly diff = PolySub(&b, &x);
+    res &= PolyIsEq(&diff, &a);
+    res &= diff.arr[0].p.arr == a.arr[0].p.arr;
+
+    PolyDestroy(&a);
+    res &= TestEq(PolyClone(&b), sum, true);
+    PolyDestroy(&b);
+    PolyDestroy(&x);
+    PolyDestroy(&diff);
+    return res;
+}
+
 #define POLY_P P(P(C(1), 3), 0, P(C(1), 2), 2, C(1), 3)
 
 static bool SimpleDegByTest(void) {
@@ -270,6 +732,71 @@ static bool SimpleDegTest(void) {
     return res;
 }
 
+static bool MetaTest(void) {
+    bool res = true;
+    Poly p = POLY_P;
+    PolyMeta meta = PolyGetMeta(&p);
+    res &= meta.terms == 3 && meta.depth == 2 && meta.deg == 4;
+    res &= meta.deg_by[0] == 3 && meta.deg_by[1] == 3 && meta.deg_by[2] == 0;
+    PolyDestroy(&p);
+
+    // x_0 x_1^2 ... x_11^12, głębszy niż liczba zapamiętywanych stopni
+    Poly q = C(1);
+    for (poly_exp_t e = 12; e > 0; e--)
+        q = P(q, e);
+    res &= PolyDepth(&q) == 12 && PolyDeg(&q) == 78;
+    for (size_t v = 0; v < 14; v++)
+        res &= PolyDegBy(&q, v) == (v < 12 ? (poly_exp_t) v + 1 : 0);
+
+    // zmiana w miejscu unieważnia zapamiętany opis
+    Poly shared = PolyClone(&q);
+    Poly one = C(1);
+    PolyAddTo(&q, &one);
+    res &= PolyTermCount(&q) == 2 && PolyTermCount(&shared) == 1;
+    Poly x = P(C(1), 0, C(1), 9);
+    PolyAddTo(&q, &x);
+    res &= PolyTermCount(&q) == 3 && PolyDegBy(&q, 0) == 9;
+
+    Poly args[12];
+    for (size_t i = 0; i < 12; i++)
+        args[i] = P(C(1), 1);
+    Poly composed = PolyCompose(&shared, 12, args);
+    res &= TestEq(composed, P(C(1), 78), true);
+    for (size_t i = 0; i < 12; i++)
+        PolyDestroy(&args[i]);
+
+    PolyDestroy(&q);
+    PolyDestroy(&shared);
+    PolyDestroy(&x);
+    return res;
+}
+
+static Poly DeepPoly(size_t depth, poly_coeff_t leaf) {
+    Poly p = C(leaf);
+    for (size_t i = 0; i < depth; i++) {
+        Mono m[] = {M(C(1), 0), M(p, 1)};
+        p = PolyAddMonos(2, m);
+    }
+    return p;
+}
+
+static bool DeepTest(void) {
+    // przechodzenie bez rekurencji nie jest ograniczone stosem wywołań
+    bool res = true;
+    Poly a = DeepPoly(200000, 1);
+    Poly b = DeepPoly(200000, 1);
+    Poly c = DeepPoly(200000, 2);
+    res &= PolyIsEq(&a, &b) && !PolyIsEq(&a, &c);
+    res &= PolyHash(&a) == PolyHash(&b);
+    res &= PolyDepth(&a) == 200000 && PolyDeg(&a) == 200000;
+    res &= PolyTermCount(&a) == 200001;
+    res &= PolyDegBy(&a, 150000) == 1 && PolyDegBy(&a, 200000) == 0;
+    PolyDestroy(&a);
+    PolyDestroy(&b);
+    PolyDestroy(&c);
+    return res;
+}
+
 static bool SimpleIsEqTest(void) {
     bool res = true;
     res &= TestEq(C(0), C(0), true);
@@ -290,6 +817,38 @@ static bool SimpleIsEqTest(void) {
     return res;
 }
 
+static bool HashTest(void) {
+    bool res = true;
+    Poly a = SparsePoly(50, 3, 1);
+    Poly b = SparsePoly(50, 3, 1);
+    Poly c = SparsePoly(50, 3, 2);
+    res &= a.arr != b.arr && PolyHash(&a) == PolyHash(&b);
+    res &= PolyHash(&a) != PolyHash(&c);
+    res &= PolyIsEq(&a, &b) && !PolyIsEq(&a, &c);
+    res &= PolyHash(&(Poly) {.coeff = 5, .arr = NULL}) ==
+           PolyHash(&(Poly) {.coeff = 5, .arr = NULL});
+
+    // zmiana w miejscu unieważnia zapamiętany skrót, także w poddrzewach
+    Poly shared = PolyClone(&a);
+    Poly x = P(P(C(1), 0, C(1), 1), 0);
+    PolyAddTo(&a, &x);
+    Poly sum = PolyAdd(&b, &x);
+    res &= PolyHash(&a) == PolyHash(&sum) && PolyIsEq(&a, &sum);
+    res &= PolyHash(&shared) == PolyHash(&b) && PolyIsEq(&shared, &b);
+    res &= !PolyIsEq(&a, &b);
+    Poly diff = PolySub(&sum, &x);
+    res &= PolyIsEq(&diff, &b);
+
+    PolyDestroy(&a);
+    PolyDestroy(&b);
+    PolyDestroy(&c);
+    PolyDestroy(&shared);
+    PolyDestroy(&x);
+    PolyDestroy(&sum);
+    PolyDestroy(&diff);
+    return res;
+}
+
 static bool SimpleAtTest(void) {
     bool res = true;
     res &= TestAt(C(2), 1, C(2));
@@ -297,6 +856,142 @@ static bool SimpleAtTest(void) {
     res &= TestAt(P(C(3), 1, C(2), 3, C(1), 5), 10, C(102030));
     res &= TestAt(P(P(C(1), 4), 0, P(C(1), 2), 2, C(1), 3), 2,
                   P(C(8), 0, C(4), 2, C(1), 4));
+    res &= TestAt(P(C(1), 0, C(1), 1, C(1), 2, P(C(1), 1), 3), -1,
+                  P(C(1), 0, C(-1), 1));
+    res &= TestAt(P(C(7), 0, P(C(1), 1), 1, C(1), 9), 0, C(7));
+    res &= TestAt(P(P(C(1), 0, C(1), 1), 0, P(C(-2), 1), 1), 2,
+                  P(C(1), 0, C(-3), 1));
+    return res;
+}
+
+static bool AtManyTest(void) {
+    bool res = true;
+    const poly_coeff_t xs[] = {0, 1, -1, 2, 3, -7, 1L << 32, 123456789};
+    const size_t n = sizeof(xs) / sizeof(xs[0]);
+    Poly polys[] = {
+        C(5),
+        P(C(1), 0, C(1), 18),
+        P(C(3), 1, C(2), 3, C(1), 5, C(-4), 64),
+        P(P(C(1), 4), 0, P(C(1), 2), 2, C(1), 3),
+        P(P(C(1), 0, C(1), 1), 0, P(C(-2), 1), 1, P(C(1), 0, C(1), 2), 70),
+    };
+    for (size_t i = 0; i < sizeof(polys) / sizeof(polys[0]); i++) {
+        Poly out[sizeof(xs) / sizeof(xs[0])];
+        PolyAtMany(&polys[i], n, xs, out);
+        for (size_t j = 0; j < n; j++) {
+            Poly expected = PolyAt(&polys[i], xs[j]);
+            res &= PolyIsEq(&out[j], &expected);
+            PolyDestroy(&expected);
+            PolyDestroy(&out[j]);
+        }
+        PolyDestroy(&polys[i]);
+    }
+    return res;
+}
+
+static bool EvalPointTest(void) {
+    bool res = true;
+    const poly_coeff_t x[] = {3, -2, 1L << 31, 7};
+    Poly polys[] = {
+        C(5),
+        P(C(1), 0, C(1), 18),
+        P(P(C(1), 4), 0, P(C(1), 2), 2, C(1), 3),
+        P(P(C(1), 0, P(C(2), 1, C(-1), 3), 1), 0, P(C(-2), 1), 1,
+          P(P(C(4), 0, C(1), 2), 0, C(1), 2), 70),
+    };
+    for (size_t i = 0; i < sizeof(polys) / sizeof(polys[0]); i++) {
+        PolyEvalPlan *plan = PolyEvalPlanCompile(&polys[i]);
+        for (size_t k = 0; k <= 4; k++) {
+            // wartość wyznaczona kolejnymi wywołaniami PolyAt()
+            Poly value = PolyClone(&polys[i]);
+            for (size_t j = 0; j < 4; j++) {
+                Poly next = PolyAt(&value, j < k ? x[j] : 0);
+                PolyDestroy(&value);
+                value = next;
+            }
+            res &= PolyIsCoeff(&value);
+            res &= PolyEvalPoint(&polys[i], k, x) == value.coeff;
+            res &= PolyEvalPlanRun(plan, k, x) == value.coeff;
+            PolyDestroy(&value);
+        }
+        PolyEvalPlanDestroy(plan);
+        PolyDestroy(&polys[i]);
+    }
+    return res;
+}
+
+static bool ModTest(void) {
+    bool res = true;
+    res &= !CoeffModulusSet(1) && !CoeffModulusSet(2) && !CoeffModulusSet(8);
+    res &= !CoeffModulusSet(COEFF_MOD_MAX + 1);
+    res &= !CoeffModActive();
+
+    // mnożenie gęste w trybie modularnym nie jest używane; małe
+    // współczynniki nie przepełniają się, więc wynik to redukcja wyniku
+    // obliczonego modulo 2^64
+    Mono m[40];
+    for (size_t i = 0; i < 40; i++)
+        m[i] = M(C((poly_coeff_t) i % 5 + 1), (poly_exp_t) i);
+    Poly dense = PolyAddMonos(40, m);
+    Poly dense_sq = PolyMul(&dense, &dense);
+
+    res &= CoeffModulusSet(7);
+    res &= CoeffModActive();
+    res &= TestAdd(C(3), C(5), C(1));
+    res &= TestMul(P(C(3), 1), P(C(5), 1), P(C(1), 2));
+    res &= TestMul(P(C(1), 0, C(1), 1), P(C(6), 0, C(1), 1),
+                   P(C(6), 0, C(1), 2));
+    res &= TestSub(C(2), C(5), C(4));
+    res &= TestSub(P(C(1), 1), P(C(1), 1), C(0));
+    res &= TestEq(PolyNeg(&(Poly) {.coeff = 3, .arr = NULL}), C(4), true);
+    res &= TestAt(P(C(1), 0, C(1), 3), 2, C(2));
+    res &= TestAt(P(C(1), 0, C(1), 3), -1, C(0));
+    res &= TestAt(P(P(C(1), 1), 1), 3, P(C(3), 1));
+
+    Poly p = P(C(1), 0, C(1), 3);
+    poly_coeff_t xs[] = {2, 9, -1};
+    Poly out[3];
+    PolyAtMany(&p, 3, xs, out);
+    res &= PolyIsEq(&out[0], &(Poly) {.coeff = 2, .arr = NULL});
+    res &= PolyIsEq(&out[1], &(Poly) {.coeff = 2, .arr = NULL});
+    res &= PolyIsZero(&out[2]);
+    res &= PolyEvalPoint(&p, 1, xs) == 2;
+    PolyEvalPlan *plan = PolyEvalPlanCompile(&p);
+    res &= PolyEvalPlanRun(plan, 1, xs + 2) == 0;
+    PolyEvalPlanDestroy(plan);
+
+    // x^2 o (x + 6) = x^2 + 12x + 36 = x^2 + 5x + 1
+    Poly sq = P(C(1), 2);
+    Poly q = P(C(6), 0, C(1), 1);
+    res &= TestEq(PolyCompose(&sq, 1, &q), P(C(1), 0, C(5), 1, C(1), 2), true);
+
+    Poly big = P(C(7), 1, C(8), 2);
+    res &= TestEq(PolyReduceCoeffs(&big), P(C(1), 2), true);
+    Poly dense_mod = PolyReduceCoeffs(&dense);
+    res &= TestEq(PolyMul(&dense_mod, &dense_mod), PolyReduceCoeffs(&dense_sq),
+                  true);
+
+    // duży moduł pierwszy 2^61 - 1
+    unsigned long prime = (1UL << 61) - 1;
+    res &= CoeffModulusSet(prime);
+    poly_coeff_t a = (poly_coeff_t) (prime - 3), b = 123456789123456789L;
+    poly_coeff_t ab = (poly_coeff_t) ((unsigned __int128) a * b % prime);
+    res &= TestMul(C(a), C(b), C(ab));
+    res &= TestMul(P(C(a), 1), P(C(b), 2), P(C(ab), 3));
+    res &= TestAdd(C(a), C(5), C(2));
+    res &= CoeffReduce(-1) == (poly_coeff_t) prime - 1;
+
+    res &= CoeffModulusSet(0);
+    res &= !CoeffModActive();
+    for (size_t i = 0; i < 3; i++)
+        PolyDestroy(&out[i]);
+    PolyDestroy(&p);
+    PolyDestroy(&sq);
+    PolyDestroy(&q);
+    PolyDestroy(&big);
+    PolyDestroy(&dense);
+    PolyDestroy(&dense_sq);
+    PolyDestroy(&dense_mod);
     return res;
 }
 
@@ -306,19 +1001,560 @@ static bool OverflowTest(void) {
     res &= TestAt(P(C(1), 64), 2, C(0));
     res &= TestAt(P(C(1), 0, C(1), 64), 2, C(1));
     res &= TestAt(P(P(C(1), 1), 64), 2, C(0));
+    res &= TestAt(P(C(3), 0, P(C(1), 1), 64, C(5), 70), 2, C(3));
+    return res;
+}
+
+static Poly RepeatedMul(const Poly *p, poly_exp_t n) {
+    Poly ret = C(1);
+    for (poly_exp_t i = 0; i < n; i++) {
+        Poly prev = ret;
+        ret = PolyMul(&prev, p);
+        PolyDestroy(&prev);
+    }
+    return ret;
+}
+
+static bool TestPow(Poly p, poly_exp_t n) {
+    Poly pow = PolyPow(&p, n);
+    Poly expected = RepeatedMul(&p, n);
+    bool is_eq = PolyIsEq(&pow, &expected);
+    PolyDestroy(&p);
+    PolyDestroy(&pow);
+    PolyDestroy(&expected);
+    return is_eq;
+}
+
+static bool PowTest(void) {
+    bool res = true;
+    res &= TestEq(PolyPow(&(Poly) {.coeff = 0, .arr = NULL}, 0), C(1), true);
+    res &= TestPow(C(3), 40);
+    res &= TestPow(P(C(1), 0, C(1), 1), 0);
+    res &= TestPow(P(C(1), 0, C(1), 1), 1);
+
+    // rozwinięcie ze wzoru wielomianowego
+    Poly binomial = P(C(1), 0, C(1), 1);
+    res &= TestEq(PolyPow(&binomial, 4), P(C(1), 0, C(4), 1, C(6), 2, C(4), 3,
+                                           C(1), 4), true);
+    PolyDestroy(&binomial);
+    res &= TestPow(P(C(2), 0, C(-3), 5), 17);
+    res &= TestPow(P(P(C(1), 1), 0, C(1), 1), 9);
+    res &= TestPow(P(P(C(1), 0, C(1), 1), 0, P(C(5), 2), 3), 12);
+    res &= TestPow(P(C(3), 1, C(-7), 2, C(11), 3), 70);
+
+    // potęgowanie binarne z podnoszeniem do kwadratu
+    res &= TestPow(P(C(1), 0, C(1), 1), 300);
+    res &= TestPow(P(C(1), 0, C(2), 1, C(3), 2, C(4), 3, P(C(5), 1), 4), 11);
+    Poly sparse = SparsePoly(60, 100, 1);
+    Poly square = PolySquare(&sparse);
+    res &= TestEq(PolyMul(&sparse, &sparse), square, true);
+    res &= TestPow(sparse, 3);
+
+    // przepełnienie i arytmetyka modularna
+    res &= TestPow(P(C(1L << 40), 0, C(3), 1, C(5), 9), 6);
+    res &= TestPow(P(C(1L << 40), 0, C(3), 1, C(5), 9, C(7), 10, C(1), 11), 6);
+    res &= CoeffModulusSet(101);
+    res &= TestPow(P(C(1), 0, C(1), 1), 101);
+    Poly frobenius = P(C(1), 0, C(1), 1);
+    res &= TestEq(PolyPow(&frobenius, 101), P(C(1), 0, C(1), 101), true);
+    PolyDestroy(&frobenius);
+    res &= TestEq(PolyPow(&(Poly) {.coeff = 5, .arr = NULL}, 100), C(1), true);
+    res &= CoeffModulusSet(0);
+    CoeffExactSet();
+    res &= TestPow(P(C(1L << 40), 0, C(3), 1, C(5), 9), 6);
+    res &= TestPow(P(C(1L << 40), 0, C(3), 1, C(5), 9, C(7), 10, C(1), 11), 6);
+    res &= CoeffModulusSet(0);
+    return res;
+}
+
+static Poly Big(const char *digits) {
+    Poly ret;
+    bool parsed = BigCoeffParse(digits, digits + strlen(digits), &ret);
+    assert(parsed);
+    (void) parsed;
+    return ret;
+}
+
+static bool ExactTest(void) {
+    bool res = true;
+    CoeffExactSet();
+    res &= CoeffExactActive() && !CoeffModActive();
+
+    // te same działania co w OverflowTest, ale bez przepełnienia
+    res &= TestMul(P(C(1L << 32), 1), C(1L << 32),
+                   P(Big("18446744073709551616"), 1));
+    res &= TestAt(P(C(1), 64), 2, Big("18446744073709551616"));
+    res &= TestAt(P(C(1), 0, C(1), 64), 2, Big("18446744073709551617"));
+    res &= TestAt(P(P(C(1), 1), 64), 2, P(Big("18446744073709551616"), 1));
+
+    // wyniki mieszczące się w poly_coeff_t nie są liczbami dowolnej precyzji
+    res &= TestAdd(C(LONG_MAX), C(1), Big("9223372036854775808"));
+    res &= TestSub(Big("9223372036854775808"), C(1), C(LONG_MAX));
+    res &= TestMul(C(LONG_MIN), C(-1), Big("9223372036854775808"));
+    res &= TestEq(PolyNeg(&(Poly) {.coeff = LONG_MIN, .arr = NULL}),
+                  Big("9223372036854775808"), true);
+    res &= TestEq(Big("-9223372036854775808"), C(LONG_MIN), true);
+    res &= TestEq(Big("-000"), C(0), true);
+    Poly sum = PolyAdd(&(Poly) {.coeff = LONG_MAX, .arr = NULL},
+                       &(Poly) {.coeff = 1, .arr = NULL});
+    Poly diff = PolySub(&sum, &(Poly) {.coeff = 1, .arr = NULL});
+    res &= PolyIsBig(&sum) && !PolyIsBig(&diff) && diff.coeff == LONG_MAX;
+    PolyDestroy(&sum);
+    PolyDestroy(&diff);
+
+    Poly invalid;
+    res &= !BigCoeffParse("12a", "12a" + 3, &invalid);
+    res &= !BigCoeffParse("-", "-" + 1, &invalid);
+
+    // (x + 2^62)^2 = x^2 + 2^63 x + 2^124
+    res &= TestMul(P(C(1L << 62), 0, C(1), 1), P(C(1L << 62), 0, C(1), 1),
+                   P(Big("21267647932558653966460912964485513216"), 0,
+                     Big("9223372036854775808"), 1, C(1), 2));
+    Poly x_cubed = P(C(1), 3);
+    Poly q = C(1L << 40);
+    res &= TestEq(PolyCompose(&x_cubed, 1, &q),
+                  Big("1329227995784915872903807060280344576"), true);
+
+    Poly p = P(C(1), 0, C(1), 64);
+    poly_coeff_t xs[] = {2, -2, 0};
+    Poly out[3];
+    PolyAtMany(&p, 3, xs, out);
+    res &= TestEq(out[0], Big("18446744073709551617"), true);
+    res &= TestEq(out[1], Big("18446744073709551617"), true);
+    res &= TestEq(out[2], C(1), true);
+
+    // iloczyn wielomianów o dużych współczynnikach zgadza się modulo liczba
+    // pierwsza z iloczynem reszt
+    Poly a = SparsePoly(30, 7, 1L << 31);
+    Poly a_sq = PolyMul(&a, &a);
+    Poly a_sq_neg = PolyNeg(&a_sq);
+    res &= TestEq(PolyAdd(&a_sq, &a_sq_neg), C(0), true);
+    unsigned long prime = (1UL << 61) - 1;
+    res &= CoeffModulusSet(prime);
+    res &= !CoeffExactActive();
+    Poly a_mod = PolyReduceCoeffs(&a);
+    res &= TestEq(PolyReduceCoeffs(&a_sq), PolyMul(&a_mod, &a_mod), true);
+
+    // wyjście z trybu dokładnego zostawia wartości modulo 2^64
+    res &= CoeffModulusSet(0);
+    Poly big = P(Big("18446744073709551617"), 1);
+    res &= TestEq(PolyReduceCoeffs(&big), P(C(1), 1), true);
+
+    PolyDestroy(&x_cubed);
+    PolyDestroy(&q);
+    PolyDestroy(&p);
+    PolyDestroy(&a);
+    PolyDestroy(&a_sq);
+    PolyDestroy(&a_sq_neg);
+    PolyDestroy(&a_mod);
+    PolyDestroy(&big);
+    return res;
+}
+
+// wypisuje wielomian do pliku podstawionego pod standardowe wyjście
+static bool TestPrint(Poly p, const char *expected) {
+    FILE *file = tmpfile();
+    CHECK_PTR(file);
+    int stdout_fd = dup(STDOUT_FILENO);
+    OutputFlush();
+    dup2(fileno(file), STDOUT_FILENO);
+    PolyPrint(&p);
+    OutputFlush();
+    dup2(stdout_fd, STDOUT_FILENO);
+    close(stdout_fd);
+    PolyDestroy(&p);
+
+    size_t length = strlen(expected);
+    char *printed = malloc(length + 1);
+    CHECK_PTR(printed);
+    rewind(file);
+    size_t read = fread(printed, 1, length + 1, file);
+    bool res = read == length && memcmp(printed, expected, length) == 0;
+    free(printed);
+    fclose(file);
+    return res;
+}
+
+static bool PrintTest(void) {
+    bool res = true;
+    res &= TestPrint(C(0), "0");
+    res &= TestPrint(C(-7), "-7");
+    res &= TestPrint(C(LONG_MIN), "-9223372036854775808");
+    res &= TestPrint(C(LONG_MAX), "9223372036854775807");
+    res &= TestPrint(P(C(10), 0, P(C(-99), 100), 2147483647),
+                     "(10,0)+((-99,100),2147483647)");
+    res &= TestPrint(P(Big("-100000000000000000000000000000000000000001"), 3),
+                     "(-100000000000000000000000000000000000000001,3)");
+    res &= TestPrint(Big("10000000000000000000"), "10000000000000000000");
+
+    // wielomian dłuższy niż bufor wyjścia wypisywany jest w kilku porcjach
+    size_t n = 3 * OUTPUT_BUFFER_SIZE / 10;
+    Mono *monos = malloc(n * sizeof(Mono));
+    char *expected = malloc(n * 32);
+    CHECK_PTR(monos);
+    CHECK_PTR(expected);
+    size_t length = 0;
+    for (size_t i = 0; i < n; i++) {
+        monos[i] = M(C((poly_coeff_t) i * 1000003 - 99), (poly_exp_t) i);
+        length += (size_t) sprintf(expected + length, i == 0 ? "(%ld,%zu)" :
+                                   "+(%ld,%zu)", (long) i * 1000003 - 99, i);
+    }
+    res &= TestPrint(PolyOwnMonos(n, monos), expected);
+    free(expected);
+    return res;
+}
+
+// zapisuje wielomian w formacie binarnym i porównuje go z odczytanym
+static bool TestBinary(Poly p) {
+    FILE *file = tmpfile();
+    CHECK_PTR(file);
+    Poly read;
+    bool res = PolyWriteBinary(&p, file);
+    rewind(file);
+    res &= PolyReadBinary(file, &read);
+    // plik nie zawiera niczego poza zapisem wielomianu
+    res &= fgetc(file) == EOF;
+    fclose(file);
+    if (res) {
+        res = PolyIsEq(&p, &read) && PolyHash(&p) == PolyHash(&read);
+        PolyDestroy(&read);
+    }
+    PolyDestroy(&p);
+    return res;
+}
+
+// zapisuje wielomian, zmienia bajt zapisu i sprawdza, że odczyt się nie uda
+static bool TestBinaryCorrupt(Poly p, long offset, int byte) {
+    FILE *file = tmpfile();
+    CHECK_PTR(file);
+    bool res = PolyWriteBinary(&p, file);
+    PolyDestroy(&p);
+    if (offset < 0) {
+        // ucinamy zapis o -offset bajtów
+        long size = ftell(file);
+        res &= fflush(file) == 0;
+        res &= ftruncate(fileno(file), size + offset) == 0;
+    } else {
+        fseek(file, offset, SEEK_SET);
+        fputc(byte, file);
+    }
+    rewind(file);
+    Poly read = C(42);
+    res &= !PolyReadBinary(file, &read) && read.coeff == 42 &&
+           PolyIsCoeff(&read);
+    fclose(file);
+    return res;
+}
+
+static bool BinaryTest(void) {
+    bool res = true;
+    res &= TestBinary(C(0));
+    res &= TestBinary(C(-1));
+    res &= TestBinary(C(LONG_MIN));
+    res &= TestBinary(C(LONG_MAX));
+    res &= TestBinary(P(C(1), 0, C(-2), 5, C(3), INT_MAX));
+    res &= TestBinary(P(P(C(1), 1), 0, P(C(1), 0, P(C(LONG_MIN), 7), 2), 3));
+    res &= TestBinary(SparsePoly(1000, 13, -5000));
+    res &= TestBinary(DeepPoly(200000, 3));
+
+    CoeffExactSet();
+    res &= TestBinary(Big("-340282366920938463463374607431768211456"));
+    res &= TestBinary(P(Big("18446744073709551616"), 2,
+                        P(Big("-9223372036854775809"), 1), 4));
+
+    // odczyt poza trybem dokładnym i modulo p sprowadza współczynniki
+    FILE *file = tmpfile();
+    CHECK_PTR(file);
+    Poly big = P(Big("18446744073709551617"), 1, C(-1), 2, C(7), 3);
+    res &= PolyWriteBinary(&big, file);
+    res &= PolyWriteBinary(&big, file);
+    PolyDestroy(&big);
+    rewind(file);
+    Poly read;
+    res &= CoeffModulusSet(0);
+    res &= PolyReadBinary(file, &read);
+    res &= TestEq(read, P(C(1), 1, C(-1), 2, C(7), 3), true);
+    res &= CoeffModulusSet(7);
+    res &= PolyReadBinary(file, &read);
+    res &= TestEq(read, P(C(3), 1, C(6), 2), true);
+    res &= !PolyReadBinary(file, &read);
+    res &= CoeffModulusSet(0);
+    fclose(file);
+
+    // nagłówek ma 21 bajtów: znacznik, wersję, długość i sumę kontrolną
+    Poly p = P(C(1), 0, P(C(2), 1), 3);
+    res &= TestBinaryCorrupt(PolyClone(&p), 0, 'Q');
+    res &= TestBinaryCorrupt(PolyClone(&p), 4, POLY_BINARY_VERSION + 1);
+    res &= TestBinaryCorrupt(PolyClone(&p), 5, 0xff);
+    res &= TestBinaryCorrupt(PolyClone(&p), 13, 0);
+    res &= TestBinaryCorrupt(PolyClone(&p), 22, 7);
+    res &= TestBinaryCorrupt(PolyClone(&p), -1, 0);
+    res &= TestBinaryCorrupt(PolyClone(&p), -10, 0);
+    PolyDestroy(&p);
+    return res;
+}
+
+// sprawdza, że wielomiany z obrazu są równe zapisanym i mają te same opisy
+static bool TestImagePolys(size_t n, const Poly polys[], const Poly read[]) {
+    bool res = true;
+    for (size_t i = 0; i < n; i++) {
+        PolyMeta meta = PolyGetMeta(&polys[i]);
+        PolyMeta read_meta = PolyGetMeta(&read[i]);
+        res &= PolyIsEq(&polys[i], &read[i]) &&
+               PolyHash(&polys[i]) == PolyHash(&read[i]) &&
+               meta.terms == read_meta.terms &&
+               meta.depth == read_meta.depth && meta.deg == read_meta.deg;
+    }
+    return res;
+}
+
+// zapisuje jeden wielomian w obrazie i odczytuje go, sprawdzając arytmetykę
+static bool TestImageMode(const char *path, Poly p) {
+    CoeffModulus modulus = coeff_modulus;
+    size_t n;
+    Poly *read;
+    bool res = PolyImageSave(path, 1, &p);
+    CoeffModulusSet(0);
+    res &= PolyImageLoad(path, &n, &read);
+    if (res) {
+        res = n == 1 && TestImagePolys(1, &p, read) &&
+              coeff_modulus.p == modulus.p &&
+              coeff_modulus.exact == modulus.exact;
+        PolyDestroy(&read[0]);
+        free(read);
+    }
+    PolyDestroy(&p);
+    CoeffModulusSet(0);
+    return res;
+}
+
+// zapisuje obraz i psuje po kolei każdy zapisany w nim wskaźnik, sprawdzając,
+// że zepsutego obrazu nie da się odczytać
+static bool TestImageCorrupt(const char *path, size_t n, const Poly polys[]) {
+    bool res = PolyImageSave(path, n, polys);
+    FILE *file = fopen(path, "rb");
+    CHECK_PTR(file);
+    fseek(file, 0, SEEK_END);
+    size_t size = (size_t) ftell(file);
+    rewind(file);
+    uint64_t *words = malloc(size);
+    CHECK_PTR(words);
+    res &= fread(words, 1, size, file) == size;
+    fclose(file);
+
+    size_t corrupted = 0;
+    size_t empty_n;
+    Poly *empty;
+    // pomijamy nagłówek obrazu, w którym zapisany jest adres bazowy
+    for (size_t i = 64 / sizeof(uint64_t); i < size / sizeof(uint64_t); i++) {
+        uint64_t word = words[i];
+        if (word < POLY_IMAGE_BASE || word >= POLY_IMAGE_BASE + size)
+            continue;
+        uint64_t bad[] = {0xdead0000, word + 16};
+        for (size_t j = 0; j < sizeof(bad) / sizeof(bad[0]); j++) {
+            words[i] = bad[j];
+            file = fopen(path, "wb");
+            CHECK_PTR(file);
+            res &= fwrite(words, 1, size, file) == size;
+            fclose(file);
+            res &= !PolyImageLoad(path, &empty_n, &empty);
+        }
+        words[i] = word;
+        corrupted++;
+    }
+    free(words);
+    return res && corrupted > 0;
+}
+
+static bool ImageCorruptTest(void) {
+    char path[] = "/tmp/poly_test_image_XXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0)
+        return false;
+    close(fd);
+
+    Poly p = P(P(C(1), 1), 0, P(C(1), 0, P(C(2), 7), 2), 3);
+    Poly polys[] = {PolyClone(&p), P(PolyClone(&p), 1), C(3), p};
+    size_t n = sizeof(polys) / sizeof(polys[0]);
+
+    // obraz odwzorowywany pod adresem, względem którego go zapisano
+    bool res = TestImageCorrupt(path, n, polys);
+    // adres jest zajęty, więc obraz jest przesuwany
+    size_t held_n;
+    Poly *held;
+    res &= PolyImageSave(path, n, polys) &&
+           PolyImageLoad(path, &held_n, &held);
+    if (!res)
+        return false;
+    res &= TestImageCorrupt(path, n, polys);
+    for (size_t i = 0; i < n; i++)
+        PolyDestroy(&polys[i]);
+
+    // wskaźniki na liczby dowolnej precyzji
+    CoeffExactSet();
+    Poly big[] = {P(Big("18446744073709551616"), 2,
+                    P(Big("-9223372036854775809"), 1), 4),
+                  Big("36893488147419103232")};
+    res &= TestImageCorrupt(path, 2, big);
+    PolyDestroy(&big[0]);
+    PolyDestroy(&big[1]);
+    CoeffModulusSet(0);
+
+    for (size_t i = 0; i < held_n; i++)
+        PolyDestroy(&held[i]);
+    free(held);
+    remove(path);
+    PolyImageRelease();
+    return res;
+}
+
+static bool ImageTest(void) {
+    char path[] = "/tmp/poly_test_image_XXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0)
+        return false;
+    close(fd);
+
+    Poly shared = SparsePoly(1000, 13, -5000);
+    Poly polys[] = {C(0), C(LONG_MIN),
+                    P(P(C(1), 1), 0, P(C(1), 0, P(C(LONG_MIN), 7), 2), 3),
+                    PolyClone(&shared), PolyClone(&shared),
+                    DeepPoly(200000, 3), P(PolyClone(&shared), 2, C(1), 3)};
+    size_t n = sizeof(polys) / sizeof(polys[0]);
+    PolyDestroy(&shared);
+    bool res = PolyImageSave(path, n, polys);
+
+    // drugi obraz nie zmieści się pod tym samym adresem i zostanie przesunięty
+    size_t first_n, second_n;
+    Poly *first, *second;
+    res &= PolyImageLoad(path, &first_n, &first);
+    res &= PolyImageLoad(path, &second_n, &second);
+    if (!res)
+        return false;
+    res &= first_n == n && second_n == n;
+    res &= TestImagePolys(n, polys, first) && TestImagePolys(n, polys, second);
+    // tablica współdzielona przez kilka wielomianów jest zapisana raz
+    res &= first[3].arr == first[4].arr &&
+           first[6].arr[0].p.arr == first[3].arr;
+    res &= second[3].arr == second[4].arr && second[3].arr != first[3].arr;
+
+    // zmiana wielomianu z obrazu tworzy kopię tablicy
+    Poly x = P(C(5), 13);
+    Poly expected = PolyAdd(&polys[3], &x);
+    PolyAddTo(&first[3], &x);
+    res &= PolyIsEq(&first[3], &expected) && PolyIsEq(&first[4], &polys[4]);
+    res &= !PolyIsEq(&first[3], &first[4]);
+    PolyDestroy(&expected);
+    expected = PolyMul(&polys[2], &polys[6]);
+    Poly product = PolyMul(&second[2], &second[6]);
+    res &= PolyIsEq(&product, &expected);
+    PolyDestroy(&product);
+    PolyDestroy(&expected);
+    expected = PolyNeg(&polys[6]);
+    Poly neg = PolyNeg(&second[6]);
+    res &= PolyIsEq(&neg, &expected);
+    PolyDestroy(&neg);
+    PolyDestroy(&expected);
+    PolyDestroy(&x);
+
+    for (size_t i = 0; i < n; i++) {
+        PolyDestroy(&polys[i]);
+        PolyDestroy(&first[i]);
+        PolyDestroy(&second[i]);
+    }
+    free(first);
+    free(second);
+
+    // obraz przywraca arytmetykę, w której go zapisano
+    CoeffModulusSet(1000003);
+    res &= TestImageMode(path, P(C(5), 1, P(C(1000002), 2), 3));
+    CoeffExactSet();
+    res &= TestImageMode(path, P(Big("18446744073709551616"), 2,
+                                 P(Big("-9223372036854775809"), 1), 4));
+
+    // sprawdzony obraz trafia pod adres zwolniony przez poprzednie obrazy
+    Poly q = P(C(1), 1, C(2), 3);
+    PolyImage image;
+    res &= PolyImageSave(path, 1, &q) && PolyImageOpen(path, &image);
+    if (!res)
+        return false;
+    res &= (uintptr_t) image.addr != POLY_IMAGE_BASE;
+    PolyImageRelease();
+    size_t moved_n;
+    Poly *moved;
+    res &= PolyImageCommit(&image, &moved_n, &moved);
+    if (!res)
+        return false;
+    res &= moved_n == 1 && (uintptr_t) moved[0].arr > POLY_IMAGE_BASE &&
+           (uintptr_t) moved[0].arr < POLY_IMAGE_BASE + image.size &&
+           PolyIsEq(&moved[0], &q);
+    PolyDestroy(&moved[0]);
+    free(moved);
+    res &= PolyImageOpen(path, &image);
+    PolyImageClose(&image);
+    PolyDestroy(&q);
+
+    // pusty stos
+    size_t empty_n;
+    Poly *empty;
+    res &= PolyImageSave(path, 0, NULL);
+    res &= PolyImageLoad(path, &empty_n, &empty) && empty_n == 0;
+    free(empty);
+
+    // niepoprawne pliki
+    Poly p = C(1);
+    res &= !PolyImageSave("/nonexistent/poly_image", 1, &p);
+    res &= !PolyImageLoad("/nonexistent/poly_image", &empty_n, &empty);
+    res &= PolyImageSave(path, 1, &p);
+    res &= truncate(path, 64) == 0;
+    res &= !PolyImageLoad(path, &empty_n, &empty);
+    FILE *file = fopen(path, "wb");
+    CHECK_PTR(file);
+    res &= PolyWriteBinary(&p, file);
+    fclose(file);
+    res &= !PolyImageLoad(path, &empty_n, &empty);
+
+    remove(path);
+    PolyImageRelease();
     return res;
 }
 
 int main() {
     assert(SimpleAddTest());
     assert(SimpleAddMonosTest());
+    assert(SortMonosTest());
     assert(SimpleMulTest());
+    assert(HeapMulTest());
+    assert(DenseMulTest());
+    assert(NttMulTest());
+    assert(ParallelMulTest());
+    assert(ParallelComposeTest());
+    assert(ThreadPoolTest());
+    assert(PowerCacheTest());
     assert(SimpleNegTest());
     assert(SimpleSubTest());
+    assert(AccumulateTest());
+    assert(MonoPoolTest());
+    assert(SharedCloneTest());
     assert(SimpleDegByTest());
     assert(SimpleDegTest());
+    assert(MetaTest());
     assert(SimpleIsEqTest());
+    assert(HashTest());
+    assert(DeepTest());
     assert(SimpleAtTest());
+    assert(AtManyTest());
+    assert(EvalPointTest());
     assert(OverflowTest());
+    assert(ModTest());
+    assert(ExactTest());
+    assert(PowTest());
+    assert(PrintTest());
+    assert(BinaryTest());
+    assert(ImageTest());
+    assert(ImageCorruptTest());
+    PowerCacheClear();
+    MonoPoolRelease();
+    BigArenaRelease();
     return 0;
 }
@@ -0,0 +1,232 @@
+/** @file
+ * Implementacja modułu przechowującego tablice potęg podstawianych
+ * wielomianów.
+ * Wpisy trzymane są w tablicy haszującej z łańcuchowaniem oraz na liście
+ * dwukierunkowej uporządkowanej od ostatnio używanego. Wielomiany w pamięci
+ * podręcznej współdzielą tablice jednomianów z wielomianami zwracanymi przez
+ * @ref PowerCacheFill(const Poly *q, size_t count, Poly powers[]), więc
+ * zapisanie i odczytanie tablicy potęg nie kopiuje jednomianów.
+ * Potęgi brakujące w pamięci podręcznej wyznaczane są poza sekcją krytyczną.
+ *
+ * @author Jan Kwiatkowski
+ */
+
+#include "power_cache.h"
+#include "coeff_mod.h"
+#include "utilities.h"
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+/**
+ * Tablica potęg jednego wielomianu.
+ */
+typedef struct PowerCacheEntry {
+    uint64_t hash; ///< skrót wielomianu @p key
+    Poly key; ///< wielomian, którego potęgi są pamiętane
+    Poly *powers; ///< potęgi @f$key^{2^0}, key^{2^1}, \ldots@f$
+    size_t size; ///< liczba pamiętanych potęg
+    size_t terms; ///< łączna liczba współczynników pamiętanych potęg
+    struct PowerCacheEntry *chain; ///< następny wpis w tym samym kubełku
+    struct PowerCacheEntry *prev; ///< wpis użyty później
+    struct PowerCacheEntry *next; ///< wpis użyty wcześniej
+} PowerCacheEntry;
+
+/** Kubełki tablicy haszującej. */
+static PowerCacheEntry *buckets[POWER_CACHE_BUCKETS];
+
+/** Ostatnio użyty wpis. */
+static PowerCacheEntry *lru_head = NULL;
+
+/** Najdawniej użyty wpis. */
+static PowerCacheEntry *lru_tail = NULL;
+
+/** Statystyki pamięci podręcznej. */
+static PowerCacheStats stats;
+
+/**
+ * Moduł współczynników i tryb dokładny, w których wyznaczono pamiętane
+ * potęgi.
+ */
+static CoeffModulus cache_modulus = {.p = 0, .exact = false};
+
+/** Muteks chroniący pamięć podręczną. */
+static pthread_mutex_t cache_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * Wyszukuje tablicę potęg wielomianu.
+ * @param[in] hash : skrót wielomianu
+ * @param[in] q : wielomian
+ * @return wpis lub NULL, jeśli wielomianu nie ma w pamięci podręcznej
+ */
+static PowerCacheEntry* Find(uint64_t hash, const Poly *q) {
+    PowerCacheEntry *entry = buckets[hash % POWER_CACHE_BUCKETS];
+    while (entry != NULL && (entry->hash != hash || !PolyIsEq(&entry->key, q)))
+        entry = entry->chain;
+    return entry;
+}
+
+/**
+ * Wypina wpis z listy wpisów uporządkowanej od ostatnio używanego.
+ * @param[in,out] entry : wpis
+ */
+static void LruUnlink(PowerCacheEntry *entry) {
+    if (entry->prev != NULL)
+        entry->prev->next = entry->next;
+    else
+        lru_head = entry->next;
+    if (entry->next != NULL)
+        entry->next->prev = entry->prev;
+    else
+        lru_tail = entry->prev;
+}
+
+/**
+ * Wstawia wpis na początek listy wpisów uporządkowanej od ostatnio
+ * używanego.
+ * @param[in,out] entry : wpis
+ */
+static void LruPushFront(PowerCacheEntry *entry) {
+    entry->prev = NULL;
+    entry->next = lru_head;
+    if (lru_head != NULL)
+        lru_head->prev = entry;
+    else
+        lru_tail = entry;
+    lru_head = entry;
+}
+
+/**
+ * Usuwa wpis z pamięci podręcznej i zwalnia go.
+ * @param[in] entry : wpis
+ */
+static void Remove(PowerCacheEntry *entry) {
+    PowerCacheEntry **link = &buckets[entry->hash % POWER_CACHE_BUCKETS];
+    while (*link != entry)
+        link = &(*link)->chain;
+    *link = entry->chain;
+    LruUnlink(entry);
+
+    stats.entries--;
+    stats.terms -= entry->terms;
+    for (size_t i = 0; i < entry->size; i++)
+        PolyDestroy(&entry->powers[i]);
+    free(entry->powers);
+    PolyDestroy(&entry->key);
+    free(entry);
+}
+
+/**
+ * Zapamiętuje potęgi wielomianu, wydłużając istniejącą tablicę lub tworząc
+ * nową, a następnie usuwa najdawniej używane tablice, dopóki pamięć podręczna
+ * przekracza limit @ref POWER_CACHE_MAX_TERMS.
+ * @param[in] hash : skrót wielomianu
+ * @param[in] q : wielomian
+ * @param[in] count : liczba potęg
+ * @param[in] powers : potęgi
+ * @param[in] terms : liczby współczynników kolejnych potęg
+ */
+static void Store(uint64_t hash, const Poly *q, size_t count,
+                  const Poly powers[], const size_t terms[]) {
+    PowerCacheEntry *entry = Find(hash, q);
+    if (entry == NULL) {
+        entry = SafeMalloc(sizeof(PowerCacheEntry));
+        *entry = (PowerCacheEntry) {.hash = hash, .key = PolyClone(q),
+                                    .powers = NULL, .size = 0, .terms = 0};
+        entry->chain = buckets[hash % POWER_CACHE_BUCKETS];
+        buckets[hash % POWER_CACHE_BUCKETS] = entry;
+        stats.entries++;
+    } else {
+        LruUnlink(entry);
+    }
+    LruPushFront(entry);
+
+    // inny wątek mógł w międzyczasie zapamiętać dłuższą tablicę
+    if (entry->size < count) {
+        entry->powers = SafeRealloc(entry->powers, count * sizeof(Poly));
+        for (size_t i = entry->size; i < count; i++) {
+            entry->powers[i] = PolyClone(&powers[i]);
+            entry->terms += terms[i];
+            stats.terms += terms[i];
+        }
+        entry->size = count;
+    }
+
+    while (stats.terms > POWER_CACHE_MAX_TERMS) {
+        Remove(lru_tail);
+        stats.evictions++;
+    }
+}
+
+void PowerCacheFill(const Poly *q, size_t count, Poly powers[]) {
+    assert(count > 0);
+
+    // potęgi współczynników wyznacza się szybciej, niż wyszukuje
+    if (PolyIsCoeff(q)) {
+        powers[0] = PolyClone(q);
+        for (size_t i = 1; i < count; i++)
+            powers[i] = PolySquare(&powers[i - 1]);
+        return;
+    }
+
+    uint64_t hash = PolyHash(q);
+    size_t known = 0;
+
+    pthread_mutex_lock(&cache_lock);
+    // potęgi wyznaczone modulo inny moduł lub w innym trybie są nieaktualne
+    if (cache_modulus.p != coeff_modulus.p ||
+        cache_modulus.exact != coeff_modulus.exact) {
+        while (lru_head != NULL)
+            Remove(lru_head);
+        cache_modulus = coeff_modulus;
+    }
+    PowerCacheEntry *entry = Find(hash, q);
+    if (entry == NULL) {
+        stats.misses++;
+    } else {
+        known = entry->size < count ? entry->size : count;
+        for (size_t i = 0; i < known; i++)
+            powers[i] = PolyClone(&entry->powers[i]);
+        LruUnlink(entry);
+        LruPushFront(entry);
+        if (known == count)
+            stats.hits++;
+        else
+            stats.extensions++;
+    }
+    pthread_mutex_unlock(&cache_lock);
+
+    if (known == count)
+        return;
+
+    size_t *terms = SafeMalloc(count * sizeof(size_t));
+    if (known == 0) {
+        powers[0] = PolyClone(q);
+        known = 1;
+    }
+    for (size_t i = 0; i < count; i++) {
+        if (i >= known)
+            powers[i] = PolySquare(&powers[i - 1]);
+        terms[i] = PolyTermCount(&powers[i]);
+    }
+
+    pthread_mutex_lock(&cache_lock);
+    Store(hash, q, count, powers, terms);
+    pthread_mutex_unlock(&cache_lock);
+    free(terms);
+}
+
+PowerCacheStats PowerCacheGetStats(void) {
+    pthread_mutex_lock(&cache_lock);
+    PowerCacheStats ret = stats;
+    pthread_mutex_unlock(&cache_lock);
+    return ret;
+}
+
+void PowerCacheClear(void) {
+    pthread_mutex_lock(&cache_lock);
+    while (lru_head != NULL)
+        Remove(lru_head);
+    stats = (PowerCacheStats) {0};
+    pthread_mutex_unlock(&cache_lock);
+}
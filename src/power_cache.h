@@ -0,0 +1,64 @@
+/** @file
+ * Interfejs modułu przechowującego tablice potęg podstawianych wielomianów
+ * między kolejnymi wywołaniami
+ * @ref PolyCompose(const Poly *p, size_t k, const Poly q[]).
+ * Dla wielomianu @f$q@f$ pamiętana jest tablica
+ * @f$q, q^2, q^4, \ldots@f$, wydłużana, gdy potrzebna jest wyższa potęga.
+ * Tablice wyszukiwane są po skrócie struktury wielomianu, a łączna liczba
+ * współczynników w pamięci podręcznej jest ograniczona; po jej przekroczeniu
+ * usuwane są najdawniej używane tablice. Zmiana modułu współczynników (zob.
+ * @ref CoeffModulusSet(unsigned long p)) lub włączenie trybu dokładnego
+ * unieważnia wszystkie tablice.
+ * Z modułu można korzystać jednocześnie z wielu wątków.
+ *
+ * @author Jan Kwiatkowski
+ */
+
+#ifndef POLYNOMIALS_POWER_CACHE_H
+#define POLYNOMIALS_POWER_CACHE_H
+
+#include "poly.h"
+
+/** Liczba kubełków tablicy haszującej. */
+#define POWER_CACHE_BUCKETS 256
+
+/**
+ * Maksymalna łączna liczba współczynników (zob.
+ * @ref PolyTermCount(const Poly *p)) wielomianów w pamięci podręcznej.
+ */
+#define POWER_CACHE_MAX_TERMS ((size_t) 1 << 22)
+
+/**
+ * Statystyki pamięci podręcznej.
+ */
+typedef struct PowerCacheStats {
+    size_t entries; ///< liczba pamiętanych tablic potęg
+    size_t terms; ///< łączna liczba współczynników pamiętanych wielomianów
+    size_t hits; ///< liczba zapytań, dla których tablica była kompletna
+    size_t extensions; ///< liczba zapytań, dla których tablica była za krótka
+    size_t misses; ///< liczba zapytań o nieznany wielomian
+    size_t evictions; ///< liczba usuniętych tablic
+} PowerCacheStats;
+
+/**
+ * Wyznacza potęgi @f$q^{2^0}, q^{2^1}, \ldots, q^{2^{count - 1}}@f$,
+ * korzystając z pamięci podręcznej i uzupełniając ją.
+ * @param[in] q : wielomian
+ * @param[in] count : liczba potęg, dodatnia
+ * @param[out] powers : tablica długości @p count, w której zapisywane są
+ * potęgi; należy je usunąć funkcją @ref PolyDestroy(Poly *p)
+ */
+void PowerCacheFill(const Poly *q, size_t count, Poly powers[]);
+
+/**
+ * Zwraca statystyki pamięci podręcznej.
+ * @return statystyki
+ */
+PowerCacheStats PowerCacheGetStats(void);
+
+/**
+ * Usuwa wszystkie tablice potęg z pamięci podręcznej i zeruje statystyki.
+ */
+void PowerCacheClear(void);
+
+#endif //POLYNOMIALS_POWER_CACHE_H
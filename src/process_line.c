@@ -6,6 +6,8 @@
 
 #include "process_line.h"
 #include "calc_functions.h"
+#include "coeff_mod.h"
+#include "output.h"
 #include "poly_stack.h"
 #include "utilities.h"
 #include <stdbool.h>
@@ -13,9 +15,14 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <errno.h>
+#include <limits.h>
+#include <stdint.h>
 
 /** Liczba komend. */
-#define NUMBER_OF_COMMANDS 12
+#define NUMBER_OF_COMMANDS 17
+
+/** Liczba komend, które mogą zmienić arytmetykę współczynników. */
+#define ARITHMETIC_COMMANDS 3
 
 /**
  * Struktura przechowująca wskaźnik na funkcję oraz jej nazwę.
@@ -41,19 +48,53 @@ const Command FUNCTION_NAMES[NUMBER_OF_COMMANDS] = {
         {Sub, "SUB"},
         {IsEq, "IS_EQ"},
         {Deg, "DEG"},
+        {Hash, "HASH"},
+        {Stat, "STAT"},
         {Print, "PRINT"},
         {Pop, "POP"},
+        {PowerCacheInfo, "POWER_CACHE"},
+        {PowerCacheReset, "POWER_CACHE_CLEAR"},
+        {Exact, "EXACT"},
 };
 
 /** Nazwa komendy @ref DegBy(Stack *stack, size_t idx). */
 const char *DEG_BY_COMMAND = "DEG_BY";
 /** Nazwa komendy @ref At(Stack *stack, poly_coeff_t x). */
 const char *AT_COMMAND = "AT";
+/**
+ * Nazwa komendy @ref AtBatch(Stack *stack, size_t n, const poly_coeff_t xs[]).
+ */
+const char *AT_BATCH_COMMAND = "AT_BATCH";
 /** Nazwa komendy @ref Compose(Stack *stack, size_t k). */
 const char *COMPOSE_COMMAND = "COMPOSE";
+/** Nazwa komendy @ref Eval(Stack *stack, size_t k, bool *correct). */
+const char *EVAL_COMMAND = "EVAL";
+/** Nazwa komendy @ref Mod(Stack *stack, size_t p, bool *correct). */
+const char *MOD_COMMAND = "MOD";
+/** Nazwa komendy @ref Pow(Stack *stack, poly_exp_t n). */
+const char *POW_COMMAND = "POW";
+/**
+ * Nazwa komendy @ref SaveBin(Stack *stack, const char *path, bool *correct).
+ */
+const char *SAVE_BIN_COMMAND = "SAVE_BIN";
+/**
+ * Nazwa komendy @ref LoadBin(Stack *stack, const char *path, bool *correct).
+ */
+const char *LOAD_BIN_COMMAND = "LOAD_BIN";
+/**
+ * Nazwa komendy @ref Checkpoint(Stack *stack, const char *path,
+ * bool *correct).
+ */
+const char *CHECKPOINT_COMMAND = "CHECKPOINT";
+/**
+ * Nazwa komendy @ref Restore(Stack *stack, const char *path, bool *correct).
+ */
+const char *RESTORE_COMMAND = "RESTORE";
+/** Nazwy komend, które mogą zmienić arytmetykę współczynników. */
+const char *ARITHMETIC_COMMAND_NAMES[ARITHMETIC_COMMANDS] = {
+    "MOD", "EXACT", "RESTORE"
+};
 
-/** Znaki dopuszczalne w wielomianie. */
-const char *ALLOWED_POLY_CHARS = "0123456789-+,()";
 /** Znaki dopuszczalne w liczbie. */
 const char *ALLOWED_NUMBER_CHARS = "0123456789-";
 
@@ -63,12 +104,25 @@ const long MAX_POLY_EXP_T = 2147483647;
 /** Komendy wykonywane są w systemie dziesiętnym. */
 const int BASE = 10;
 
+/**
+ * Wypisuje na standardowe wyjście diagnostyczne informację o błędzie
+ * w danym wierszu. Wcześniej opróżnia bufor standardowego wyjścia, aby
+ * komunikaty pojawiały się w kolejności wykonywania komend.
+ * @param[in] index : numer wiersza
+ * @param[in] message : opis błędu
+ */
+static void PrintError(const size_t *index, const char *message) {
+    if (output_buffer.size > 0)
+        OutputFlush();
+    fprintf(stderr, "ERROR %zu %s\n", *index, message);
+}
+
 /**
  * Wypisuje informację o błędnej nazwie komendy w danym wierszu.
  * @param[in] index : numer wiersza
  */
 static void WrongCommandError(const size_t *index) {
-    fprintf(stderr, "ERROR %zu WRONG COMMAND\n", *index);
+    PrintError(index, "WRONG COMMAND");
 }
 
 /**
@@ -76,7 +130,7 @@ static void WrongCommandError(const size_t *index) {
  * @param[in] index : numer wiersza
  */
 static void WrongPolyError(const size_t *index) {
-    fprintf(stderr, "ERROR %zu WRONG POLY\n", *index);
+    PrintError(index, "WRONG POLY");
 }
 
 /**
@@ -85,7 +139,7 @@ static void WrongPolyError(const size_t *index) {
  * @param[in] index : numer wiersza
  */
 static void AtWrongValueError(const size_t *index) {
-    fprintf(stderr, "ERROR %zu AT WRONG VALUE\n", *index);
+    PrintError(index, "AT WRONG VALUE");
 }
 
 /**
@@ -94,7 +148,7 @@ static void AtWrongValueError(const size_t *index) {
  * @param[in] index : numer wiersza
  */
 static void DegByWrongVariableError(const size_t *index) {
-    fprintf(stderr, "ERROR %zu DEG BY WRONG VARIABLE\n", *index);
+    PrintError(index, "DEG BY WRONG VARIABLE");
 }
 
 /**
@@ -105,7 +159,7 @@ static void DegByWrongVariableError(const size_t *index) {
  * @param[in] index : numer wiersza
  */
 static void StackUnderflowError(const size_t *index) {
-    fprintf(stderr, "ERROR %zu STACK UNDERFLOW\n", *index);
+    PrintError(index, "STACK UNDERFLOW");
 }
 
 /**
@@ -113,18 +167,84 @@ static void StackUnderflowError(const size_t *index) {
  * @param[in] index : numer wiersza
  */
 static void ComposeError(const size_t *index) {
-    fprintf(stderr, "ERROR %zu COMPOSE WRONG PARAMETER\n", *index);
+    PrintError(index, "COMPOSE WRONG PARAMETER");
+}
+
+/**
+ * Wypisuje informację o błędnym argumencie funkcji
+ * @ref Eval(Stack *stack, size_t k, bool *correct) w danym wierszu.
+ * @param[in] index : numer wiersza
+ */
+static void EvalWrongParameterError(const size_t *index) {
+    PrintError(index, "EVAL WRONG PARAMETER");
+}
+
+/**
+ * Wypisuje informację o tym, że wartości zmiennych w funkcji
+ * @ref Eval(Stack *stack, size_t k, bool *correct) nie są wielomianami
+ * stałymi.
+ * @param[in] index : numer wiersza
+ */
+static void EvalWrongValueError(const size_t *index) {
+    PrintError(index, "EVAL WRONG VALUE");
+}
+
+/**
+ * Wypisuje informację o błędnym argumencie funkcji
+ * @ref Mod(Stack *stack, size_t p, bool *correct) w danym wierszu.
+ * @param[in] index : numer wiersza
+ */
+static void ModWrongValueError(const size_t *index) {
+    PrintError(index, "MOD WRONG VALUE");
+}
+
+/**
+ * Wypisuje informację o błędnym argumencie funkcji
+ * @ref Pow(Stack *stack, poly_exp_t n) w danym wierszu.
+ * @param[in] index : numer wiersza
+ */
+static void PowWrongValueError(const size_t *index) {
+    PrintError(index, "POW WRONG VALUE");
+}
+
+/**
+ * Wypisuje informację o tym, że nie udało się zapisać pliku komendą
+ * @ref SaveBin(Stack *stack, const char *path, bool *correct) w danym
+ * wierszu.
+ * @param[in] index : numer wiersza
+ */
+static void SaveBinWrongFileError(const size_t *index) {
+    PrintError(index, "SAVE_BIN WRONG FILE");
+}
+
+/**
+ * Wypisuje informację o tym, że nie udało się odczytać wielomianu z pliku
+ * komendą @ref LoadBin(Stack *stack, const char *path, bool *correct)
+ * w danym wierszu.
+ * @param[in] index : numer wiersza
+ */
+static void LoadBinWrongFileError(const size_t *index) {
+    PrintError(index, "LOAD_BIN WRONG FILE");
+}
+
+/**
+ * Wypisuje informację o tym, że nie udało się zapisać obrazu stosu komendą
+ * @ref Checkpoint(Stack *stack, const char *path, bool *correct) w danym
+ * wierszu.
+ * @param[in] index : numer wiersza
+ */
+static void CheckpointWrongFileError(const size_t *index) {
+    PrintError(index, "CHECKPOINT WRONG FILE");
 }
 
 /**
- * Tworzy 'zerowy' jednomian.
- * Funkcja jest potrzebna by zwrócić jakikolwiek jednomian w przypadku błędnego
- * wielomianu w funkcji @ref CreateMono(char *begin, char *end, bool *is_poly).
- * @return Jednomian składający się z wielomianu zerowego podniesionego do
- * zerowej potęgi.
+ * Wypisuje informację o tym, że nie udało się odczytać obrazu stosu komendą
+ * @ref Restore(Stack *stack, const char *path, bool *correct) w danym
+ * wierszu.
+ * @param[in] index : numer wiersza
  */
-static Mono MonoZero() {
-    return (Mono) {.p = PolyZero(), .exp = 0};
+static void RestoreWrongFileError(const size_t *index) {
+    PrintError(index, "RESTORE WRONG FILE");
 }
 
 /**
@@ -137,22 +257,6 @@ static bool IsLetter(char ch) {
     return (ascii >= 'a' && ascii <= 'z') || (ascii >= 'A' && ascii <= 'Z');
 }
 
-/**
- * Sprawdza czy napis zawiera tylko i wyłącznie znaki dopuszczalne
- * w wielomianie.
- * @param[in] characters : liczba znaków
- * @param[in] input : ciąg znaków
- * @return czy napis zawiera tylko i wyłącznie znaki dopuszczalne w wielomianie
- */
-static bool CheckPolyChars(const size_t *characters, const char *input) {
-    for (size_t i = 0; i < *characters; i++) {
-        char *ch = strchr(ALLOWED_POLY_CHARS, input[i]);
-        if (ch == NULL)
-            return false;
-    }
-    return true;
-}
-
 /**
  * Sprawdza czy napis zawiera tylko i wyłącznie znaki dopuszczalne w liczbie.
  * @param[in] input : ciąg znaków
@@ -167,22 +271,6 @@ static bool CheckNumberChars(char *input) {
     return true;
 }
 
-/**
- * Z ciągu znaków tworzy liczbę typu @ref poly_exp_t (o ile to możliwe).
- * @param[in] begin : początek ciągu znaków
- * @param[in,out] endptr : miejsce, do którego funkcja strtoll() przetworzyła
- * ciąg znaków
- * @return liczba typu @ref poly_exp_t
- */
-static poly_exp_t StrToPolyExp(char *begin, char **endptr) {
-    long val = strtoll(begin, endptr, BASE);
-    if (val > MAX_POLY_EXP_T || val < 0) {
-        errno = ERANGE;
-        return 0;
-    }
-    return (poly_exp_t) (val);
-}
-
 /**
  * Sprawdza czy komenda wymagająca podania argumentów ma po nazwie spację oraz
  * co najmniej jeden znak i nie zawiera znaku '\0'.
@@ -199,24 +287,23 @@ static bool CheckArguments(const size_t *read_characters, const size_t *length,
 }
 
 /**
- * Przetwarza wiersz zawierający na początku komendę wymagająca podania jako
- * argumentu zmiennej typu size_t.
- * Sprawdza poprawność argumentów, jeśli są poprawne wykonuje tą komendę.
+ * Sprawdza poprawność argumentu typu size_t komendy znajdującej się na
+ * początku wiersza i wyznacza jego wartość.
+ * W przypadku niepoprawnego argumentu wypisuje stosowny komunikat.
  * @param[in] index : numer wiersza
  * @param[in] read_characters : długość ciągu znaków
  * @param[in] input : ciąg znaków
- * @param[in,out] stack : stos
  * @param[in] length : długość wiersza
  * @param[in] command_name : nazwa komendy
  * @param[in] error : funkcja, którą należy wywołać w przypadku niepoprawnego
  * argumentu w komendzie
- * @param[in] function : funkcja, którą należy wywołać jeśli argument jest
- * poprawny
+ * @param[out] value : wartość argumentu
+ * @return czy argument jest poprawny
  */
-static void Size_TCommand(const size_t *index, const size_t *read_characters,
-                       char *input, Stack *stack, const size_t *length,
-                       const char *command_name, void (*error)(const size_t*),
-                       bool (*function)(Stack*, size_t)) {
+static bool ParseSize_TArgument(const size_t *index,
+                                const size_t *read_characters, char *input,
+                                const size_t *length, const char *command_name,
+                                void (*error)(const size_t*), size_t *value) {
     size_t command_length = strlen(command_name);
 
     if (!CheckArguments(read_characters, &command_length, input, length)) {
@@ -225,28 +312,126 @@ static void Size_TCommand(const size_t *index, const size_t *read_characters,
             WrongCommandError(index);
         else
             error(index);
-        return;
+        return false;
     }
 
     // na początku liczby nie może być '+' ani '-'
     if (input[command_length + 1] == '+' || input[command_length + 1] == '-' ||
         !CheckNumberChars(input + command_length + 1)) {
         error(index);
-        return;
+        return false;
     }
 
     char *endptr;
-    size_t value = strtoull(&input[command_length + 1], &endptr, BASE);
+    *value = strtoull(&input[command_length + 1], &endptr, BASE);
 
     // sprawdzenie czy na wejściu podano liczbę z poprawnego zakresu oraz czy
     // w linii nie ma dodatkowych znaków
-    if (CheckErrno() && *endptr == '\0') {
+    if (CheckErrno() && *endptr == '\0')
+        return true;
+
+    error(index);
+    return false;
+}
+
+/**
+ * Przetwarza wiersz zawierający na początku komendę wymagająca podania jako
+ * argumentu zmiennej typu size_t.
+ * Sprawdza poprawność argumentów, jeśli są poprawne wykonuje tą komendę.
+ * @param[in] index : numer wiersza
+ * @param[in] read_characters : długość ciągu znaków
+ * @param[in] input : ciąg znaków
+ * @param[in,out] stack : stos
+ * @param[in] length : długość wiersza
+ * @param[in] command_name : nazwa komendy
+ * @param[in] error : funkcja, którą należy wywołać w przypadku niepoprawnego
+ * argumentu w komendzie
+ * @param[in] function : funkcja, którą należy wywołać jeśli argument jest
+ * poprawny
+ */
+static void Size_TCommand(const size_t *index, const size_t *read_characters,
+                       char *input, Stack *stack, const size_t *length,
+                       const char *command_name, void (*error)(const size_t*),
+                       bool (*function)(Stack*, size_t)) {
+    size_t value;
+    if (ParseSize_TArgument(index, read_characters, input, length,
+                            command_name, error, &value)) {
         if (!function(stack, value))
             StackUnderflowError(index);
     }
-    else {
-        error(index);
+}
+
+/**
+ * Przetwarza wiersz zawierający na początku komendę
+ * @ref Eval(Stack *stack, size_t k, bool *correct).
+ * Sprawdza poprawność argumentów, jeśli są poprawne wykonuje tą komendę.
+ * @param[in] index : numer wiersza
+ * @param[in] read_characters : długość ciągu znaków
+ * @param[in] input : ciąg znaków
+ * @param[in,out] stack : stos
+ * @param[in] length : długość wiersza
+ */
+static void ProcessEval(const size_t *index, const size_t *read_characters,
+                        char *input, Stack *stack, const size_t *length) {
+    size_t k;
+    if (!ParseSize_TArgument(index, read_characters, input, length,
+                             EVAL_COMMAND, &EvalWrongParameterError, &k))
+        return;
+
+    bool correct = true;
+    if (!Eval(stack, k, &correct))
+        StackUnderflowError(index);
+    else if (!correct)
+        EvalWrongValueError(index);
+}
+
+/**
+ * Przetwarza wiersz zawierający na początku komendę
+ * @ref Mod(Stack *stack, size_t p, bool *correct).
+ * Sprawdza poprawność argumentów, jeśli są poprawne wykonuje tą komendę.
+ * @param[in] index : numer wiersza
+ * @param[in] read_characters : długość ciągu znaków
+ * @param[in] input : ciąg znaków
+ * @param[in,out] stack : stos
+ * @param[in] length : długość wiersza
+ */
+static void ProcessMod(const size_t *index, const size_t *read_characters,
+                       char *input, Stack *stack, const size_t *length) {
+    size_t p;
+    if (!ParseSize_TArgument(index, read_characters, input, length,
+                             MOD_COMMAND, &ModWrongValueError, &p))
+        return;
+
+    bool correct = true;
+    Mod(stack, p, &correct);
+    if (!correct)
+        ModWrongValueError(index);
+}
+
+/**
+ * Przetwarza wiersz zawierający na początku komendę
+ * @ref Pow(Stack *stack, poly_exp_t n).
+ * Sprawdza poprawność argumentów, jeśli są poprawne wykonuje tą komendę.
+ * @param[in] index : numer wiersza
+ * @param[in] read_characters : długość ciągu znaków
+ * @param[in] input : ciąg znaków
+ * @param[in,out] stack : stos
+ * @param[in] length : długość wiersza
+ */
+static void ProcessPow(const size_t *index, const size_t *read_characters,
+                       char *input, Stack *stack, const size_t *length) {
+    size_t n;
+    if (!ParseSize_TArgument(index, read_characters, input, length,
+                             POW_COMMAND, &PowWrongValueError, &n))
+        return;
+
+    if (n > (size_t) MAX_POLY_EXP_T) {
+        PowWrongValueError(index);
+        return;
     }
+
+    if (!Pow(stack, (poly_exp_t) n))
+        StackUnderflowError(index);
 }
 
 /**
@@ -293,6 +478,102 @@ static void ProcessAt(const size_t *index, const size_t *read_characters,
     }
 }
 
+/**
+ * Przetwarza wiersz zawierający na początku komendę
+ * @ref AtBatch(Stack *stack, size_t n, const poly_coeff_t xs[]).
+ * Argumentami są liczby oddzielone pojedynczymi spacjami, każda w tej samej
+ * postaci co argument komendy @ref At(Stack *stack, poly_coeff_t x).
+ * Sprawdza poprawność argumentów, jeśli są poprawne wykonuje tą komendę.
+ * @param[in] index : numer wiersza
+ * @param[in] read_characters : długość ciągu znaków
+ * @param[in] input : ciąg znaków
+ * @param[in,out] stack : stos
+ * @param[in] length : długość wiersza
+ */
+static void ProcessAtBatch(const size_t *index, const size_t *read_characters,
+                           char *input, Stack *stack, const size_t *length) {
+    size_t at_batch_length = strlen(AT_BATCH_COMMAND);
+
+    if (!CheckArguments(read_characters, &at_batch_length, input, length)) {
+        if ((*read_characters != at_batch_length &&
+        input[at_batch_length] != ' ')
+        || (*read_characters == at_batch_length &&
+        *read_characters != *length))
+            WrongCommandError(index);
+        else
+            AtWrongValueError(index);
+        return;
+    }
+
+    char *begin = input + at_batch_length + 1;
+    size_t n = 1;
+    for (char *i = begin; *i != '\0'; i++) {
+        if (*i == ' ')
+            n++;
+    }
+
+    poly_coeff_t *xs = SafeMalloc(n * sizeof(poly_coeff_t));
+    bool correct = true;
+    for (size_t i = 0; i < n && correct; i++) {
+        // liczba zaczyna się cyfrą lub znakiem '-'
+        if (*begin != '-' && (*begin < '0' || *begin > '9')) {
+            correct = false;
+            break;
+        }
+
+        char *endptr;
+        xs[i] = strtoll(begin, &endptr, BASE);
+        correct = CheckErrno() && endptr != begin &&
+                  (*endptr == ' ' || *endptr == '\0') &&
+                  (*endptr == '\0') == (i + 1 == n);
+        begin = endptr + 1;
+    }
+
+    if (!correct)
+        AtWrongValueError(index);
+    else if (!AtBatch(stack, n, xs))
+        StackUnderflowError(index);
+    free(xs);
+}
+
+/**
+ * Przetwarza wiersz zawierający na początku komendę, której argumentem jest
+ * ścieżka pliku, czyli cała pozostała część wiersza.
+ * Sprawdza poprawność argumentów, jeśli są poprawne wykonuje tą komendę.
+ * @param[in] index : numer wiersza
+ * @param[in] read_characters : długość ciągu znaków
+ * @param[in] input : ciąg znaków
+ * @param[in,out] stack : stos
+ * @param[in] length : długość wiersza
+ * @param[in] command_name : nazwa komendy
+ * @param[in] error : funkcja, którą należy wywołać w przypadku niepoprawnego
+ * argumentu lub błędu pliku
+ * @param[in] function : funkcja, którą należy wywołać jeśli argument jest
+ * poprawny
+ */
+static void FileCommand(const size_t *index, const size_t *read_characters,
+                        char *input, Stack *stack, const size_t *length,
+                        const char *command_name,
+                        void (*error)(const size_t*),
+                        bool (*function)(Stack*, const char*, bool*)) {
+    size_t command_length = strlen(command_name);
+
+    if (!CheckArguments(read_characters, &command_length, input, length)) {
+        if ((*read_characters != command_length && input[command_length] != ' ')
+        || (*read_characters == command_length && *read_characters != *length))
+            WrongCommandError(index);
+        else
+            error(index);
+        return;
+    }
+
+    bool correct = true;
+    if (!function(stack, input + command_length + 1, &correct))
+        StackUnderflowError(index);
+    else if (!correct)
+        error(index);
+}
+
 /**
  * Przetwarza wiersz zawierający nazwę komendy.
  * W przypadku błędnej nazwy wypisuje stosowny komunikat.
@@ -306,9 +587,17 @@ static void ProcessCommand(const size_t *index, const size_t *read_characters,
                            char *input, Stack *stack, const size_t *length) {
     size_t deg_by_length = strlen(DEG_BY_COMMAND);
     size_t at_length = strlen(AT_COMMAND);
+    size_t at_batch_length = strlen(AT_BATCH_COMMAND);
     size_t compose_length = strlen(COMPOSE_COMMAND);
-
-    // należy osobno sprawdzić DegBy() oraz At()
+    size_t eval_length = strlen(EVAL_COMMAND);
+    size_t mod_length = strlen(MOD_COMMAND);
+    size_t pow_length = strlen(POW_COMMAND);
+    size_t save_bin_length = strlen(SAVE_BIN_COMMAND);
+    size_t load_bin_length = strlen(LOAD_BIN_COMMAND);
+    size_t checkpoint_length = strlen(CHECKPOINT_COMMAND);
+    size_t restore_length = strlen(RESTORE_COMMAND);
+
+    // należy osobno sprawdzić komendy przyjmujące argumenty
     if (*read_characters >= deg_by_length &&
     strncmp(DEG_BY_COMMAND, input, deg_by_length) == 0) {
         Size_TCommand(index, read_characters, input, stack, length,
@@ -321,11 +610,58 @@ static void ProcessCommand(const size_t *index, const size_t *read_characters,
                       COMPOSE_COMMAND, &ComposeError, &Compose);
         return;
     }
+    else if (*read_characters >= eval_length &&
+    strncmp(EVAL_COMMAND, input, eval_length) == 0) {
+        ProcessEval(index, read_characters, input, stack, length);
+        return;
+    }
+    else if (*read_characters >= mod_length &&
+    strncmp(MOD_COMMAND, input, mod_length) == 0) {
+        ProcessMod(index, read_characters, input, stack, length);
+        return;
+    }
+    // nazwa POW jest początkiem nazwy POWER_CACHE
+    else if (*read_characters >= pow_length &&
+    strncmp(POW_COMMAND, input, pow_length) == 0 &&
+    (*read_characters == pow_length || input[pow_length] == ' ')) {
+        ProcessPow(index, read_characters, input, stack, length);
+        return;
+    }
+    else if (*read_characters >= at_batch_length &&
+    strncmp(AT_BATCH_COMMAND, input, at_batch_length) == 0) {
+        ProcessAtBatch(index, read_characters, input, stack, length);
+        return;
+    }
     else if (*read_characters >= at_length &&
     strncmp(AT_COMMAND, input, at_length) == 0) {
         ProcessAt(index, read_characters, input, stack, length);
         return;
     }
+    else if (*read_characters >= save_bin_length &&
+    strncmp(SAVE_BIN_COMMAND, input, save_bin_length) == 0) {
+        FileCommand(index, read_characters, input, stack, length,
+                    SAVE_BIN_COMMAND, &SaveBinWrongFileError, &SaveBin);
+        return;
+    }
+    else if (*read_characters >= load_bin_length &&
+    strncmp(LOAD_BIN_COMMAND, input, load_bin_length) == 0) {
+        FileCommand(index, read_characters, input, stack, length,
+                    LOAD_BIN_COMMAND, &LoadBinWrongFileError, &LoadBin);
+        return;
+    }
+    else if (*read_characters >= checkpoint_length &&
+    strncmp(CHECKPOINT_COMMAND, input, checkpoint_length) == 0) {
+        FileCommand(index, read_characters, input, stack, length,
+                    CHECKPOINT_COMMAND, &CheckpointWrongFileError,
+                    &Checkpoint);
+        return;
+    }
+    else if (*read_characters >= restore_length &&
+    strncmp(RESTORE_COMMAND, input, restore_length) == 0) {
+        FileCommand(index, read_characters, input, stack, length,
+                    RESTORE_COMMAND, &RestoreWrongFileError, &Restore);
+        return;
+    }
 
     // występuje znak '\0'
     if (*length != *read_characters) {
@@ -346,179 +682,172 @@ static void ProcessCommand(const size_t *index, const size_t *read_characters,
     WrongCommandError(index);
 }
 
-static Poly CreatePoly(char *begin, char *end, bool *is_poly);
-
 /**
- * Z ciągu znaków próbuje utworzyć jednomian.
- * @param[in] begin : początek ciągu znaków
- * @param[in] end : pierwszy znak poza ciągiem znaków
- * @param[in,out] is_poly : czy przetwarzany ciąg znaków ma szansę być poprawnym
- * wielomianem
- * @return jednomian
+ * Wczytuje liczbę postaci `-?[0-9]+`.
+ * @param[in,out] pos : początek liczby; po wywołaniu pierwszy znak za nią
+ * @param[out] negative : czy liczba ma znak minus
+ * @param[out] magnitude : moduł liczby, o ile mieści się w typie `uint64_t`
+ * @param[out] overflow : czy moduł nie mieści się w typie `uint64_t`
+ * @return czy liczba ma co najmniej jedną cyfrę
  */
-static Mono CreateMono(char *begin, char *end, bool *is_poly) {
-    if (begin >= end) {
-        *is_poly = false;
-        return MonoZero();
-    }
-
-    Mono mono = MonoZero();
-    char *i = end - 1;
-
-    // jednomian ma postać (wielomian, wykładnik)
-    while (true) {
-        if (*i == ',') {
-            if (i + 1 == end || *(i + 1) == '+') {
-                *is_poly = false;
-                break;
-            }
-            mono.p = CreatePoly(begin, i, is_poly);
-            char *endptr = NULL;
-            mono.exp = StrToPolyExp(i + 1, &endptr);
-            if (!CheckErrno() || endptr != end)
-                *is_poly = false;
-            break;
-        }
-
-        if (i == begin) {
-            *is_poly = false;
-            break;
-        }
-        i--;
-    }
-
-    if (!*is_poly) {
-        PolyDestroy(&mono.p);
-        return MonoZero();
+static bool ParseDigits(char **pos, bool *negative, uint64_t *magnitude,
+                        bool *overflow) {
+    char *i = *pos;
+    *negative = *i == '-';
+    if (*negative)
+        i++;
+
+    char *digits = i;
+    uint64_t value = 0;
+    *overflow = false;
+    // wiersz kończy się znakiem '\0' lub '\n', który nie jest cyfrą
+    while (*i >= '0' && *i <= '9') {
+        uint64_t digit = (uint64_t) (*i - '0');
+        if (value > (UINT64_MAX - digit) / BASE)
+            *overflow = true;
+        else
+            value = value * BASE + digit;
+        i++;
     }
 
-    return mono;
+    *pos = i;
+    *magnitude = value;
+    return i != digits;
 }
 
 /**
- * Dla danego ciągu znaków tworzących wielomian znajduje liczbę jednomianów,
- * które on zawiera.
- * Jeśli liczba nawiasów otwierających różni się od liczby nawiasów zamykających
- * lub nie występują żadne nawiasy lub na pewnym prefiksie jest więcej nawiasów
- * zamykających niż otwierających, to wielomian na pewno nie jest poprawny.
- * @param[in] begin : początek ciągu znaków
- * @param[in] end : pierwszy znak poza ciągiem znaków
- * @param[in,out] correct : czy wielomian jest poprawny
- * @return liczba jednomianów
- */
-static size_t CountMonosAndCheck(char *begin, char *end, bool *correct) {
-    int brackets = 0;
-    size_t number_of_monos = 0;
-
-    for (char *i = begin; i != end; i++) {
-        if (*i == '(')
-            brackets++;
-        if (*i == ')') {
-            if (brackets == 0) {
-                *correct = false;
-                break;
-            }
-            brackets--;
-            if (brackets == 0)
-                number_of_monos++;
-        }
+ * Wczytuje współczynnik wielomianu stałego.
+ * @param[in,out] pos : początek współczynnika; po wywołaniu pierwszy znak za
+ * nim
+ * @param[out] coeff : wczytany współczynnik
+ * @return czy współczynnik jest poprawny
+ */
+static bool ParseCoeff(char **pos, Poly *coeff) {
+    char *begin = *pos;
+    bool negative, overflow;
+    uint64_t magnitude;
+    if (!ParseDigits(pos, &negative, &magnitude, &overflow))
+        return false;
+
+    uint64_t limit = (uint64_t) LONG_MAX + (negative ? 1 : 0);
+    if (!overflow && magnitude <= limit) {
+        poly_coeff_t value = negative ? (poly_coeff_t) (0 - magnitude) :
+                                        (poly_coeff_t) magnitude;
+        *coeff = PolyFromCoeff(CoeffReduce(value));
+        return true;
     }
 
-    if (number_of_monos == 0 || brackets != 0)
-        *correct = false;
-
-    return number_of_monos;
+    // w trybie dokładnym liczba spoza zakresu poly_coeff_t jest poprawnym
+    // współczynnikiem
+    return CoeffExactActive() && BigCoeffParse(begin, *pos, coeff);
 }
 
 /**
- * Czyści zawartość tablicy jednomianów.
- * @param[in,out] monos : tablica jednomianów
- * @param[in] size : rozmiar tablicy
+ * Wczytuje zakończenie jednomianu postaci `,wykładnik)`.
+ * @param[in,out] pos : początek zakończenia; po wywołaniu pierwszy znak za
+ * nim
+ * @param[out] exp : wczytany wykładnik
+ * @return czy zakończenie jest poprawne
  */
-static void ClearMonosArray(Mono *monos, size_t size) {
-    for (size_t i = 0; i < size; i++)
-        MonoDestroy(&monos[i]);
+static bool ParseMonoEnd(char **pos, poly_exp_t *exp) {
+    if (**pos != ',')
+        return false;
+    (*pos)++;
+
+    bool negative, overflow;
+    uint64_t magnitude;
+    if (!ParseDigits(pos, &negative, &magnitude, &overflow) || overflow ||
+        magnitude > (uint64_t) MAX_POLY_EXP_T || (negative && magnitude != 0) ||
+        **pos != ')')
+        return false;
+
+    (*pos)++;
+    *exp = (poly_exp_t) magnitude;
+    return true;
 }
 
 /**
  * Z ciągu znaków próbuje utworzyć wielomian.
+ * Wielomian jest sprawdzany i budowany w jednym przejściu od lewej do
+ * prawej. Jednomiany wszystkich poziomów zagnieżdżenia zbierane są w jednym
+ * rosnącym buforze; jednomiany budowanego wielomianu leżą na jego końcu od
+ * pozycji zapamiętanej na stosie poziomów i po wczytaniu całego wielomianu
+ * przekazywane są do @ref PolyAddMonos(size_t count, const Mono monos[]).
+ * Głębokość wielomianu nie jest ograniczona rozmiarem stosu wywołań.
  * @param[in] begin : początek ciągu znaków
- * @param[in] end : pierwszy znak poza ciągiem znaków
- * @param[in,out] is_poly : czy przetwarzany ciąg znaków ma szansę być poprawnym
- * wielomianem
- * @return wielomian
+ * @param[in] end : pierwszy znak poza ciągiem znaków, równy '\0' lub '\n'
+ * @param[out] is_poly : czy ciąg znaków jest poprawnym wielomianem
+ * @return wielomian lub wielomian zerowy, jeśli ciąg znaków nie jest
+ * poprawnym wielomianem
  */
 static Poly CreatePoly(char *begin, char *end, bool *is_poly) {
-    if (begin >= end) {
-        *is_poly = false;
-        return PolyZero();
-    }
-
-    // czy wielomian jest wielomianem stałym
-    if (*begin != '+') {
-        char *endptr;
-        poly_coeff_t coeff = strtoll(begin, &endptr, BASE);
-        if (CheckErrno() && endptr == end) {
-            return PolyFromCoeff(coeff);
+    size_t local_levels[WORK_STACK_LOCAL];
+    size_t *levels = local_levels;
+    size_t levels_capacity = WORK_STACK_LOCAL, depth = 0;
+    Mono local_monos[WORK_STACK_LOCAL];
+    Mono *monos = local_monos;
+    size_t monos_capacity = WORK_STACK_LOCAL, monos_size = 0;
+
+    char *i = begin;
+    Poly poly = PolyZero();
+    *is_poly = false;
+    while (i != end) {
+        // nawias otwiera pierwszy jednomian wielomianu o jeden poziom
+        // głębszego
+        if (*i == '(') {
+            if (depth == levels_capacity)
+                levels = WorkStackGrow(levels, local_levels, &levels_capacity,
+                                       sizeof(size_t));
+            levels[depth++] = monos_size;
+            i++;
+            continue;
         }
-    }
 
-    bool correct = true;
-    size_t number_of_monos = CountMonosAndCheck(begin, end, &correct);
-    if (!correct) {
-        *is_poly = false;
-        return PolyZero();
-    }
-
-    Mono *monos = SafeMalloc(sizeof(Mono) * number_of_monos);
-    int brackets = 0;
-    size_t processed_monos = 0;
-    char *begptr = NULL, *endptr = NULL;
-    bool processing_mono = false;
-    // wielomian jest postaci (jednomian)+(jednomian)+...+(jednomian)
-    for (char *i = begin; i != end; i++) {
-        if (!processing_mono) {
-            if (*i != '(') {
-                *is_poly = false;
+        if (!ParseCoeff(&i, &poly))
+            break;
+
+        // wczytany wielomian jest współczynnikiem jednomianu; zamykamy
+        // jednomiany i wielomiany, dopóki nie zacznie się kolejny jednomian
+        bool next_mono = false;
+        while (depth > 0) {
+            poly_exp_t exp;
+            if (!ParseMonoEnd(&i, &exp))
+                break;
+            if (monos_size == monos_capacity)
+                monos = WorkStackGrow(monos, local_monos, &monos_capacity,
+                                      sizeof(Mono));
+            monos[monos_size++] = (Mono) {.p = poly, .exp = exp};
+            poly = PolyZero();
+
+            if (*i == '+') {
+                next_mono = i[1] == '(';
+                if (next_mono)
+                    i += 2;
                 break;
             }
-            else {
-                begptr = i + 1;
-                processing_mono = true;
-            }
-        }
-        if (*i == '(')
-            brackets++;
-
-        if (*i == ')') {
-            brackets--;
-            if (brackets == 0) {
-                endptr = i;
-                monos[processed_monos++] = CreateMono(begptr, endptr, is_poly);
-                if (!*is_poly)
-                    break;
-                processing_mono = false;
-                if (i + 1 != end) {
-                    i++;
-                    if (*i != '+') {
-                        *is_poly = false;
-                        break;
-                    }
-                }
-            }
+
+            size_t first = levels[--depth];
+            poly = PolyAddMonos(monos_size - first, monos + first);
+            monos_size = first;
         }
 
-        if (i + 1 == end && *i != ')')
-            *is_poly = false;
+        if (!next_mono) {
+            *is_poly = depth == 0 && i == end;
+            break;
+        }
     }
 
     if (!*is_poly) {
-        ClearMonosArray(monos, processed_monos);
-        free(monos);
-        return PolyZero();
+        PolyDestroy(&poly);
+        poly = PolyZero();
+        for (size_t m = 0; m < monos_size; m++)
+            MonoDestroy(&monos[m]);
     }
 
-    Poly poly = PolyOwnMonos(processed_monos, monos);
+    if (levels != local_levels)
+        free(levels);
+    if (monos != local_monos)
+        free(monos);
     return poly;
 }
 
@@ -532,11 +861,6 @@ static Poly CreatePoly(char *begin, char *end, bool *is_poly) {
  */
 static void ProcessPoly(const size_t *index, const size_t *read_characters,
                         char *input, Stack *stack) {
-    if (!CheckPolyChars(read_characters, input)) {
-        WrongPolyError(index);
-        return;
-    }
-
     bool is_poly = true;
     Poly poly = CreatePoly(input, input + *read_characters, &is_poly);
     if (!is_poly) {
@@ -588,3 +912,67 @@ void ProcessInput(const size_t *index, size_t *read_characters,
     else
         ProcessPoly(index, read_characters, input, stack);
 }
+
+/**
+ * Sprawdza, czy wiersz może być komendą zmieniającą arytmetykę
+ * współczynników, a więc i sposób wczytywania kolejnych wielomianów.
+ * @param[in] line : początek wiersza
+ * @param[in] size : liczba znaków wiersza
+ * @return czy wiersz zaczyna się nazwą takiej komendy
+ */
+static bool ChangesArithmetic(const char *line, size_t size) {
+    for (size_t i = 0; i < ARITHMETIC_COMMANDS; i++) {
+        size_t name_length = strlen(ARITHMETIC_COMMAND_NAMES[i]);
+        if (size >= name_length &&
+            memcmp(ARITHMETIC_COMMAND_NAMES[i], line, name_length) == 0)
+            return true;
+    }
+    return false;
+}
+
+void ParseSlice(size_t index, char *line, size_t size, bool newline,
+                ParsedLine *parsed) {
+    parsed->index = index;
+    parsed->failed = false;
+    parsed->barrier = false;
+
+    // pusta linia lub komentarz
+    if (size == 0 || line[0] == '#') {
+        parsed->kind = LINE_SKIP;
+        return;
+    }
+
+    // znak nowej linii kończy wielomian tak samo jak znak '\0'
+    if (newline && !IsLetter(line[0]) && memchr(line, '\0', size) == NULL) {
+        bool is_poly;
+        parsed->poly = CreatePoly(line, line + size, &is_poly);
+        parsed->kind = is_poly ? LINE_POLY : LINE_WRONG_POLY;
+        return;
+    }
+
+    parsed->kind = LINE_TEXT;
+    parsed->barrier = ChangesArithmetic(line, size);
+    parsed->size = size + (newline ? 1 : 0);
+    parsed->text = parsed->size < PARSED_LINE_INLINE ? parsed->inline_text :
+                   SafeMalloc(parsed->size + 1);
+    memcpy(parsed->text, line, parsed->size);
+    parsed->text[parsed->size] = '\0';
+}
+
+void ExecuteLine(ParsedLine *parsed, Stack *stack) {
+    switch (parsed->kind) {
+        case LINE_POLY:
+            StackPush(stack, &parsed->poly);
+            break;
+        case LINE_WRONG_POLY:
+            WrongPolyError(&parsed->index);
+            break;
+        case LINE_TEXT:
+            ProcessInput(&parsed->index, &parsed->size, parsed->text, stack);
+            if (parsed->text != parsed->inline_text)
+                free(parsed->text);
+            break;
+        default:
+            break;
+    }
+}
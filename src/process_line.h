@@ -29,4 +29,61 @@ bool CheckErrno();
 void ProcessInput(const size_t *index, size_t *read_characters,
                   char *input, Stack *stack);
 
+/** Długość kopii wiersza mieszczącej się w @ref ParsedLine bez przydziału. */
+#define PARSED_LINE_INLINE 48
+
+/**
+ * Rodzaj wiersza przygotowanego do wykonania.
+ */
+typedef enum LineKind {
+    LINE_END, ///< koniec wejścia
+    LINE_SKIP, ///< pusty wiersz lub komentarz
+    LINE_POLY, ///< poprawny wielomian
+    LINE_WRONG_POLY, ///< niepoprawny wielomian
+    LINE_TEXT ///< inny wiersz, przetwarzany przy wykonaniu
+} LineKind;
+
+/**
+ * Wiersz wejścia przygotowany do wykonania na stosie. Wielomiany są już
+ * wczytane, a pozostałe wiersze (komendy, wiersze ze znakiem '\0' i ostatni
+ * wiersz bez znaku nowej linii) są skopiowane i przetwarzane dopiero przy
+ * wykonaniu.
+ */
+typedef struct ParsedLine {
+    LineKind kind; ///< rodzaj wiersza
+    size_t index; ///< numer wiersza
+    bool failed; ///< czy zmienna errno wskazała błąd przy wczytywaniu wiersza
+    /** czy wiersz może zmienić arytmetykę, w której wczytywane są kolejne */
+    bool barrier;
+    Poly poly; ///< wielomian dla @ref LINE_POLY
+    char *text; ///< kopia wiersza zakończona znakiem '\0' dla @ref LINE_TEXT
+    size_t size; ///< liczba znaków kopii, łącznie ze znakiem nowej linii
+    char inline_text[PARSED_LINE_INLINE]; ///< miejsce na krótką kopię
+} ParsedLine;
+
+/**
+ * Przygotowuje do wykonania jeden wiersz wskazany w większym bloku wejścia.
+ * Wielomiany wczytywane są wprost z bloku, bez kopiowania. Nie korzysta ze
+ * stosu, więc może działać w innym wątku niż @ref ExecuteLine, o ile w tym
+ * czasie nie zmienia się arytmetyka współczynników.
+ * @param[in] index : numer wiersza
+ * @param[in] line : początek wiersza; znaki wiersza nie są zmieniane
+ * @param[in] size : liczba znaków wiersza bez kończącego go znaku nowej
+ * linii
+ * @param[in] newline : czy wiersz kończy się znakiem nowej linii, który
+ * leży wtedy w @p line[size]
+ * @param[out] parsed : przygotowany wiersz
+ */
+void ParseSlice(size_t index, char *line, size_t size, bool newline,
+                ParsedLine *parsed);
+
+/**
+ * Wykonuje na stosie wiersz przygotowany funkcją @ref ParseSlice tak samo,
+ * jak zrobiłaby to funkcja @ref ProcessInput, i zwalnia pamięć zajmowaną
+ * przez kopię wiersza.
+ * @param[in,out] parsed : przygotowany wiersz
+ * @param[in,out] stack : stos
+ */
+void ExecuteLine(ParsedLine *parsed, Stack *stack);
+
 #endif //POLYNOMIALS_PROCESS_LINE_H
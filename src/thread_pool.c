@@ -0,0 +1,305 @@
+/** @file
+ * Implementacja modułu udostępniającego pulę wątków wykorzystywaną przez
+ * operacje na wielomianach.
+ * Wątek, który uruchomił pulę, ma numer 0 i korzysta z kolejki o tym
+ * numerze; z tej samej kolejki korzystają wątki spoza puli. Kolejki chronione
+ * są muteksami, a bezczynne wątki puli czekają na zmiennej warunkowej, aż
+ * pojawi się jakieś zadanie. Wątek czekający na zakończenie grupy zadań, gdy
+ * przez dłuższy czas nie znajdzie zadania do wykonania, zasypia na zmiennej
+ * warunkowej grupy.
+ *
+ * @author Jan Kwiatkowski
+ */
+
+#define _GNU_SOURCE
+
+#include "thread_pool.h"
+#include "utilities.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+/** Początkowy rozmiar tablicy zadań w kolejce. */
+#define INIT_QUEUE_SIZE 16
+
+/**
+ * Liczba kolejnych nieudanych prób pobrania zadania, po której wątek
+ * czekający na zakończenie grupy zadań zasypia.
+ */
+#define WAIT_SPINS 256
+
+/**
+ * Grupa zadań zleconych jednym wywołaniem funkcji
+ * @ref ThreadPoolRun(size_t n, void (*task)(void *arg, size_t i), void *arg).
+ */
+typedef struct TaskGroup {
+    atomic_size_t pending; ///< liczba niezakończonych zadań
+    pthread_mutex_t lock; ///< muteks zmiennej warunkowej @p done
+    pthread_cond_t done; ///< zmienna warunkowa zakończenia wszystkich zadań
+} TaskGroup;
+
+/**
+ * Zadanie czekające w kolejce.
+ */
+typedef struct Task {
+    void (*task)(void *arg, size_t i); ///< funkcja wykonująca zadanie
+    void *arg; ///< argument funkcji
+    size_t index; ///< numer zadania
+    TaskGroup *group; ///< grupa, do której należy zadanie
+} Task;
+
+/**
+ * Kolejka zadań jednego wątku. Zadania o indeksach
+ * @f$head, \ldots, tail - 1@f$ czekają na wykonanie.
+ */
+typedef struct WorkQueue {
+    pthread_mutex_t lock; ///< muteks chroniący kolejkę
+    Task *tasks; ///< tablica zadań
+    size_t head; ///< indeks pierwszego zadania
+    size_t tail; ///< indeks za ostatnim zadaniem
+    size_t capacity; ///< rozmiar tablicy @p tasks
+} WorkQueue;
+
+/** Liczba wątków w puli. */
+static size_t pool_size = 1;
+
+/** Kolejki zadań wątków puli. */
+static WorkQueue *queues = NULL;
+
+/** Wątki puli o numerach @f$1, \ldots, pool\_size - 1@f$. */
+static pthread_t *workers = NULL;
+
+/** Liczba zadań czekających we wszystkich kolejkach. */
+static atomic_size_t queued;
+
+/** Czy pula jest zatrzymywana. */
+static atomic_bool stopping;
+
+/** Muteks zmiennej warunkowej @ref wake_up. */
+static pthread_mutex_t sleep_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/** Zmienna warunkowa, na której czekają bezczynne wątki. */
+static pthread_cond_t wake_up = PTHREAD_COND_INITIALIZER;
+
+/** Numer bieżącego wątku w puli. */
+static _Thread_local size_t worker_id = 0;
+
+/**
+ * Dodaje zadanie na koniec kolejki. Licznik @ref queued zwiększany jest,
+ * zanim zadanie może zostać pobrane przez inny wątek.
+ * @param[in,out] queue : kolejka
+ * @param[in] task : zadanie
+ */
+static void QueuePush(WorkQueue *queue, Task task) {
+    pthread_mutex_lock(&queue->lock);
+    if (queue->head == queue->tail) {
+        queue->head = 0;
+        queue->tail = 0;
+    }
+    if (queue->tail == queue->capacity) {
+        queue->capacity *= 2;
+        queue->tasks = SafeRealloc(queue->tasks,
+                                   queue->capacity * sizeof(Task));
+    }
+    queue->tasks[queue->tail++] = task;
+    atomic_fetch_add(&queued, 1);
+    pthread_mutex_unlock(&queue->lock);
+}
+
+/**
+ * Pobiera zadanie z kolejki.
+ * @param[in,out] queue : kolejka
+ * @param[in] own : czy kolejka należy do bieżącego wątku; wtedy zadanie
+ * pobierane jest z końca, a w przeciwnym przypadku z początku kolejki
+ * @param[out] task : pobrane zadanie
+ * @return czy udało się pobrać zadanie
+ */
+static bool QueueTake(WorkQueue *queue, bool own, Task *task) {
+    pthread_mutex_lock(&queue->lock);
+    bool found = queue->head != queue->tail;
+    if (found)
+        *task = own ? queue->tasks[--queue->tail] : queue->tasks[queue->head++];
+    pthread_mutex_unlock(&queue->lock);
+    return found;
+}
+
+/**
+ * Oznacza zadanie grupy jako zakończone i budzi wątek czekający na grupę,
+ * jeśli było to ostatnie zadanie. Licznik zmniejszany jest pod muteksem
+ * grupy, więc czekający wątek może usunąć grupę zaraz po jego zdobyciu.
+ * @param[in,out] group : grupa zadań
+ */
+static void TaskDone(TaskGroup *group) {
+    pthread_mutex_lock(&group->lock);
+    if (atomic_fetch_sub(&group->pending, 1) == 1)
+        pthread_cond_signal(&group->done);
+    pthread_mutex_unlock(&group->lock);
+}
+
+/**
+ * Wykonuje jedno zadanie z kolejki bieżącego wątku lub podkradzione
+ * z kolejki innego wątku.
+ * @return czy wykonano zadanie
+ */
+static bool RunOneTask(void) {
+    if (atomic_load(&queued) == 0)
+        return false;
+
+    size_t self = worker_id < pool_size ? worker_id : 0;
+    Task task;
+    bool found = QueueTake(&queues[self], true, &task);
+    for (size_t i = 1; !found && i < pool_size; i++)
+        found = QueueTake(&queues[(self + i) % pool_size], false, &task);
+    if (!found)
+        return false;
+
+    atomic_fetch_sub(&queued, 1);
+    task.task(task.arg, task.index);
+    TaskDone(task.group);
+    return true;
+}
+
+/**
+ * Pętla wątku puli.
+ * @param[in] arg : numer wątku
+ * @return NULL
+ */
+static void* WorkerLoop(void *arg) {
+    worker_id = (size_t) arg;
+
+    while (!atomic_load(&stopping)) {
+        if (RunOneTask())
+            continue;
+
+        pthread_mutex_lock(&sleep_lock);
+        while (atomic_load(&queued) == 0 && !atomic_load(&stopping))
+            pthread_cond_wait(&wake_up, &sleep_lock);
+        pthread_mutex_unlock(&sleep_lock);
+    }
+
+    return NULL;
+}
+
+/**
+ * Wyznacza domyślną liczbę wątków.
+ * @return wartość zmiennej środowiskowej @ref THREAD_POOL_ENV, jeśli jest
+ * poprawną liczbą dodatnią, a w przeciwnym przypadku liczba dostępnych
+ * procesorów
+ */
+static size_t DefaultThreads(void) {
+    const char *env = getenv(THREAD_POOL_ENV);
+    if (env != NULL && *env >= '0' && *env <= '9') {
+        char *endptr;
+        unsigned long value = strtoul(env, &endptr, 10);
+        if (*endptr == '\0' && value > 0)
+            return value;
+    }
+
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    return cpus > 0 ? (size_t) cpus : 1;
+}
+
+void ThreadPoolInit(size_t threads) {
+    ThreadPoolShutdown();
+
+    if (threads == 0)
+        threads = DefaultThreads();
+    if (threads > THREAD_POOL_MAX_THREADS)
+        threads = THREAD_POOL_MAX_THREADS;
+    if (threads == 1)
+        return;
+
+    queues = SafeMalloc(threads * sizeof(WorkQueue));
+    for (size_t i = 0; i < threads; i++) {
+        pthread_mutex_init(&queues[i].lock, NULL);
+        queues[i].tasks = SafeMalloc(INIT_QUEUE_SIZE * sizeof(Task));
+        queues[i].head = 0;
+        queues[i].tail = 0;
+        queues[i].capacity = INIT_QUEUE_SIZE;
+    }
+    atomic_store(&queued, 0);
+    atomic_store(&stopping, false);
+    pool_size = threads;
+
+    workers = SafeMalloc((threads - 1) * sizeof(pthread_t));
+    for (size_t i = 1; i < threads; i++) {
+        if (pthread_create(&workers[i - 1], NULL, WorkerLoop, (void *) i) != 0)
+            exit(1);
+    }
+}
+
+void ThreadPoolShutdown(void) {
+    if (pool_size == 1)
+        return;
+
+    pthread_mutex_lock(&sleep_lock);
+    atomic_store(&stopping, true);
+    pthread_cond_broadcast(&wake_up);
+    pthread_mutex_unlock(&sleep_lock);
+
+    for (size_t i = 1; i < pool_size; i++)
+        pthread_join(workers[i - 1], NULL);
+
+    for (size_t i = 0; i < pool_size; i++) {
+        pthread_mutex_destroy(&queues[i].lock);
+        free(queues[i].tasks);
+    }
+    free(queues);
+    free(workers);
+    queues = NULL;
+    workers = NULL;
+    pool_size = 1;
+}
+
+size_t ThreadPoolSize(void) {
+    return pool_size;
+}
+
+void ThreadPoolRun(size_t n, void (*task)(void *arg, size_t i), void *arg) {
+    if (pool_size == 1 || n <= 1) {
+        for (size_t i = 0; i < n; i++)
+            task(arg, i);
+        return;
+    }
+
+    TaskGroup group;
+    atomic_init(&group.pending, n - 1);
+    pthread_mutex_init(&group.lock, NULL);
+    pthread_cond_init(&group.done, NULL);
+
+    // zadania dodajemy od końca, więc bieżący wątek pobiera je w kolejności
+    // rosnących numerów, a inne wątki podkradają zadania o dużych numerach
+    size_t self = worker_id < pool_size ? worker_id : 0;
+    for (size_t i = n - 1; i >= 1; i--) {
+        QueuePush(&queues[self], (Task) {.task = task, .arg = arg, .index = i,
+                                         .group = &group});
+    }
+
+    pthread_mutex_lock(&sleep_lock);
+    pthread_cond_broadcast(&wake_up);
+    pthread_mutex_unlock(&sleep_lock);
+
+    task(arg, 0);
+
+    // czekając na pozostałe zadania, wykonujemy zadania z kolejek, a gdy
+    // długo ich nie ma, zasypiamy do zakończenia ostatniego zadania grupy
+    size_t spins = 0;
+    while (atomic_load(&group.pending) > 0 && spins < WAIT_SPINS) {
+        if (RunOneTask()) {
+            spins = 0;
+        } else {
+            spins++;
+            sched_yield();
+        }
+    }
+
+    pthread_mutex_lock(&group.lock);
+    while (atomic_load(&group.pending) > 0)
+        pthread_cond_wait(&group.done, &group.lock);
+    pthread_mutex_unlock(&group.lock);
+    pthread_cond_destroy(&group.done);
+    pthread_mutex_destroy(&group.lock);
+}
@@ -0,0 +1,60 @@
+/** @file
+ * Interfejs modułu udostępniającego pulę wątków wykorzystywaną przez
+ * operacje na wielomianach.
+ * Każdy wątek ma własną kolejkę zadań. Wątek dodaje zadania na koniec swojej
+ * kolejki i sam pobiera je z końca, a bezczynne wątki podkradają zadania
+ * z początku kolejek innych wątków. Wątek czekający na zakończenie zadań
+ * sam wykonuje oczekujące zadania, więc zadania mogą bezpiecznie zlecać
+ * kolejne zadania.
+ *
+ * @author Jan Kwiatkowski
+ */
+
+#ifndef POLYNOMIALS_THREAD_POOL_H
+#define POLYNOMIALS_THREAD_POOL_H
+
+#include <stddef.h>
+
+/**
+ * Nazwa zmiennej środowiskowej, z której odczytywana jest domyślna liczba
+ * wątków.
+ */
+#define THREAD_POOL_ENV "POLY_THREADS"
+
+/** Maksymalna liczba wątków w puli. */
+#define THREAD_POOL_MAX_THREADS 256
+
+/**
+ * Uruchamia pulę wątków. Jeśli pula już działa, najpierw ją zatrzymuje.
+ * Jeśli @p threads jest równe 0, liczba wątków odczytywana jest ze zmiennej
+ * środowiskowej @ref THREAD_POOL_ENV, a gdy nie jest ona ustawiona, równa
+ * jest liczbie dostępnych procesorów.
+ * Wątek wywołujący funkcję jest jednym z wątków puli, więc dla @p threads
+ * równego 1 nie jest tworzony żaden nowy wątek.
+ * @param[in] threads : liczba wątków lub 0
+ */
+void ThreadPoolInit(size_t threads);
+
+/**
+ * Zatrzymuje pulę wątków. Po zatrzymaniu wszystkie zadania wykonywane są
+ * sekwencyjnie.
+ */
+void ThreadPoolShutdown(void);
+
+/**
+ * Zwraca liczbę wątków w puli.
+ * @return liczba wątków, co najmniej 1
+ */
+size_t ThreadPoolSize(void);
+
+/**
+ * Wykonuje równolegle @p n zadań i czeka na ich zakończenie.
+ * Zadanie o numerze @f$i@f$ polega na wywołaniu `task(arg, i)`.
+ * Może być wywoływana także z wnętrza zadania.
+ * @param[in] n : liczba zadań
+ * @param[in] task : funkcja wykonująca zadanie
+ * @param[in] arg : argument przekazywany do funkcji @p task
+ */
+void ThreadPoolRun(size_t n, void (*task)(void *arg, size_t i), void *arg);
+
+#endif //POLYNOMIALS_THREAD_POOL_H
@@ -7,46 +7,28 @@
 
 #include "utilities.h"
 #include "poly.h"
+#include "coeff_mod.h"
+#include "mono_pool.h"
+#include "output.h"
 #include <stdlib.h>
 #include <assert.h>
-#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
 
-/**
- * Komparator porównujący dwie struktury Mono, za większą uznaje tę o większym
- * wykładniku.
- * Zwracana wartość odpowiada konwencji przyjętej w komparatorach języka C.
- * Jeśli pierwszy jednomian ma mniejszy wykładnik zwraca -1, jeśli pierwszy
- * jednomian ma większy wykładnik zwraca 1, a jeśli wykładniki są równe
- * zwraca 0.
- * @param a : pierwszy jednomian
- * @param b : drugi jednomian
- * @return informacja, który z jednomianów ma większy wykładnik
- */
-static int MonoCompByExp(const void *a, const void *b) {
-    Mono *mono_a = (Mono*)a;
-    Mono *mono_b = (Mono*)b;
-
-    if (mono_a->exp < mono_b->exp) {
-        return -1;
-    } else if (mono_a->exp > mono_b->exp) {
-        return 1;
-    } else {
-        return 0;
-    }
-}
+/** Długość tablicy, od której @ref PolySort(Poly *p) sortuje pozycyjnie. */
+#define MONO_SORT_RADIX_THRESHOLD 256
 
-/**
- * Wywołuje funkcję calloc() dla typu Mono i sprawdza, czy alokacja
- * przebiegła poprawnie.
- * @param[in] n : ilość alokowanych elementów
- * @return wskaźnik na zaalokowany blok w pamięci
- */
-static Mono* SecureCallocMono(size_t n) {
-    Mono *ret = calloc(n, sizeof(Mono));
-    if (!ret)
-        exit(1);
-    return ret;
-}
+/** Długość fragmentu tablicy, który sortowany jest przez wstawianie. */
+#define MONO_SORT_INSERTION_THRESHOLD 16
+
+/** Liczba bitów jednej cyfry w sortowaniu pozycyjnym. */
+#define MONO_SORT_RADIX_BITS 8
+
+/** Liczba różnych cyfr w sortowaniu pozycyjnym. */
+#define MONO_SORT_RADIX (1 << MONO_SORT_RADIX_BITS)
+
+/** Liczba cyfr wykładnika w sortowaniu pozycyjnym. */
+#define MONO_SORT_DIGITS ((int) sizeof(poly_exp_t) * 8 / MONO_SORT_RADIX_BITS)
 
 void* SafeMalloc(size_t n) {
     void *ptr = malloc(n);
@@ -55,6 +37,13 @@ void* SafeMalloc(size_t n) {
     return ptr;
 }
 
+void* SafeCalloc(size_t count, size_t size) {
+    void *ptr = calloc(count, size);
+    if (!ptr)
+        exit(1);
+    return ptr;
+}
+
 void* SafeRealloc(void *ptr, size_t n) {
     ptr = realloc(ptr, n);
     if (!ptr)
@@ -62,6 +51,21 @@ void* SafeRealloc(void *ptr, size_t n) {
     return ptr;
 }
 
+void* WorkStackGrow(void *stack, const void *local, size_t *capacity,
+                    size_t elem_size) {
+    size_t size = *capacity * elem_size;
+    void *ret;
+    if (stack == local) {
+        ret = SafeMalloc(2 * size);
+        memcpy(ret, stack, size);
+    } else {
+        ret = SafeRealloc(stack, 2 * size);
+    }
+
+    *capacity *= 2;
+    return ret;
+}
+
 poly_exp_t PolyExpMax(poly_exp_t a, poly_exp_t b) {
     return a > b ? a : b;
 }
@@ -72,8 +76,8 @@ poly_coeff_t FastPow(poly_coeff_t coeff, poly_exp_t exp) {
 
     while (exp > 0) {
         if (exp % 2 == 1)
-            ret *= coeff;
-        coeff *= coeff;
+            ret = CoeffMul(ret, coeff);
+        coeff = CoeffMul(coeff, coeff);
         exp /= 2;
     }
 
@@ -82,15 +86,195 @@ poly_coeff_t FastPow(poly_coeff_t coeff, poly_exp_t exp) {
 
 Poly CreateNotCoeffPoly(size_t n) {
     assert(n != 0);
-    Poly ret_poly = {.size = n, .arr = SecureCallocMono(n)};
+    Poly ret_poly = {.size = n, .arr = MonoArrayAlloc(n)};
+    memset(ret_poly.arr, 0, n * sizeof(Mono));
     return ret_poly;
 }
 
+/**
+ * Zamienia miejscami dwa jednomiany.
+ * @param[in,out] a : jednomian
+ * @param[in,out] b : jednomian
+ */
+static inline void MonoSwap(Mono *a, Mono *b) {
+    Mono tmp = *a;
+    *a = *b;
+    *b = tmp;
+}
+
+/**
+ * Sortuje tablicę jednomianów przez wstawianie.
+ * @param[in,out] arr : tablica jednomianów
+ * @param[in] n : długość tablicy
+ */
+static void MonoInsertionSort(Mono *arr, size_t n) {
+    for (size_t i = 1; i < n; i++) {
+        Mono mono = arr[i];
+        size_t j = i;
+        while (j > 0 && arr[j - 1].exp > mono.exp) {
+            arr[j] = arr[j - 1];
+            j--;
+        }
+        arr[j] = mono;
+    }
+}
+
+/**
+ * Przesuwa jednomian w dół kopca maksymalnego (względem wykładników).
+ * @param[in,out] arr : kopiec
+ * @param[in] n : liczba elementów kopca
+ * @param[in] pos : pozycja przesuwanego jednomianu
+ */
+static void MonoSiftDown(Mono *arr, size_t n, size_t pos) {
+    Mono mono = arr[pos];
+    while (2 * pos + 1 < n) {
+        size_t child = 2 * pos + 1;
+        if (child + 1 < n && arr[child + 1].exp > arr[child].exp)
+            child++;
+        if (arr[child].exp <= mono.exp)
+            break;
+        arr[pos] = arr[child];
+        pos = child;
+    }
+    arr[pos] = mono;
+}
+
+/**
+ * Sortuje tablicę jednomianów przez kopcowanie.
+ * @param[in,out] arr : tablica jednomianów
+ * @param[in] n : długość tablicy
+ */
+static void MonoHeapSort(Mono *arr, size_t n) {
+    for (size_t i = n / 2; i > 0; i--)
+        MonoSiftDown(arr, n, i - 1);
+    for (size_t i = n - 1; i > 0; i--) {
+        MonoSwap(&arr[0], &arr[i]);
+        MonoSiftDown(arr, i, 0);
+    }
+}
+
+/**
+ * Sortuje tablicę jednomianów algorytmem introsort: sortowaniem szybkim
+ * z medianą trzech jako osią, które po przekroczeniu głębokości rekursji
+ * przechodzi w sortowanie przez kopcowanie, a krótkie fragmenty sortuje
+ * przez wstawianie. Porównania wykładników nie przechodzą przez wskaźnik
+ * na funkcję, więc kompilator może je rozwinąć w miejscu.
+ * @param[in,out] arr : tablica jednomianów
+ * @param[in] n : długość tablicy
+ * @param[in] depth : dopuszczalna głębokość rekursji
+ */
+static void MonoIntroSort(Mono *arr, size_t n, size_t depth) {
+    while (n > MONO_SORT_INSERTION_THRESHOLD) {
+        if (depth == 0) {
+            MonoHeapSort(arr, n);
+            return;
+        }
+        depth--;
+
+        // po ustawieniu mediany trzech skrajne jednomiany ograniczają
+        // przeglądanie tablicy w podziale Hoare'a
+        size_t mid = n / 2;
+        if (arr[mid].exp < arr[0].exp)
+            MonoSwap(&arr[mid], &arr[0]);
+        if (arr[n - 1].exp < arr[0].exp)
+            MonoSwap(&arr[n - 1], &arr[0]);
+        if (arr[n - 1].exp < arr[mid].exp)
+            MonoSwap(&arr[n - 1], &arr[mid]);
+        poly_exp_t pivot = arr[mid].exp;
+
+        size_t i = 0, j = n - 1;
+        while (true) {
+            while (arr[i].exp < pivot)
+                i++;
+            while (arr[j].exp > pivot)
+                j--;
+            if (i >= j)
+                break;
+            MonoSwap(&arr[i++], &arr[j--]);
+        }
+
+        // rekurencyjnie sortujemy krótszą część, a dłuższą w pętli
+        size_t left = j + 1;
+        if (left < n - left) {
+            MonoIntroSort(arr, left, depth);
+            arr += left;
+            n -= left;
+        } else {
+            MonoIntroSort(arr + left, n - left, depth);
+            n = left;
+        }
+    }
+    MonoInsertionSort(arr, n);
+}
+
+/**
+ * Sortuje tablicę jednomianów pozycyjnie (LSD) po kolejnych cyfrach
+ * wykładników, zaczynając od najmniej znaczącej. Wykładniki są nieujemne,
+ * więc ich porządek jest porządkiem liczb bez znaku. Liczniki wszystkich
+ * cyfr wyznaczane są w jednym przejściu, a przejścia po cyfrach równych dla
+ * wszystkich jednomianów są pomijane.
+ * @param[in,out] arr : tablica jednomianów
+ * @param[in] n : długość tablicy, dodatnia
+ */
+static void MonoRadixSort(Mono *arr, size_t n) {
+    size_t count[MONO_SORT_DIGITS][MONO_SORT_RADIX];
+    memset(count, 0, sizeof(count));
+    for (size_t i = 0; i < n; i++) {
+        uint32_t exp = (uint32_t) arr[i].exp;
+        for (int d = 0; d < MONO_SORT_DIGITS; d++)
+            count[d][(exp >> (d * MONO_SORT_RADIX_BITS)) %
+                     MONO_SORT_RADIX]++;
+    }
+
+    Mono *buffer = SafeMalloc(n * sizeof(Mono));
+    Mono *from = arr, *to = buffer;
+    for (int d = 0; d < MONO_SORT_DIGITS; d++) {
+        int shift = d * MONO_SORT_RADIX_BITS;
+        size_t first = ((uint32_t) from[0].exp >> shift) % MONO_SORT_RADIX;
+        if (count[d][first] == n)
+            continue;
+
+        size_t offset = 0;
+        for (size_t digit = 0; digit < MONO_SORT_RADIX; digit++) {
+            size_t digit_count = count[d][digit];
+            count[d][digit] = offset;
+            offset += digit_count;
+        }
+        for (size_t i = 0; i < n; i++) {
+            size_t digit = ((uint32_t) from[i].exp >> shift) % MONO_SORT_RADIX;
+            to[count[d][digit]++] = from[i];
+        }
+
+        Mono *tmp = from;
+        from = to;
+        to = tmp;
+    }
+
+    if (from != arr)
+        memcpy(arr, from, n * sizeof(Mono));
+    free(buffer);
+}
+
 void PolySort(Poly *p) {
     if (PolyIsCoeff(p))
         return;
 
-    qsort(p->arr, p->size, sizeof(Mono), MonoCompByExp);
+    // jednomiany często są już posortowane, np. we wczytanych wielomianach
+    size_t sorted = 1;
+    while (sorted < p->size && p->arr[sorted - 1].exp <= p->arr[sorted].exp)
+        sorted++;
+    if (sorted == p->size)
+        return;
+
+    if (p->size >= MONO_SORT_RADIX_THRESHOLD) {
+        MonoRadixSort(p->arr, p->size);
+        return;
+    }
+
+    size_t depth = 0;
+    for (size_t n = p->size; n > 1; n /= 2)
+        depth += 2;
+    MonoIntroSort(p->arr, p->size, depth);
 }
 
 bool PolyIsSorted(const Poly *p) {
@@ -106,10 +290,8 @@ bool PolyIsSorted(const Poly *p) {
 }
 
 void PrintlnBool(bool b) {
-    if (b)
-        printf("1\n");
-    else
-        printf("0\n");
+    OutputChar(b ? '1' : '0');
+    OutputEndLine();
 }
 
 size_t PowersOfTwo(size_t k) {
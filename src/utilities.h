@@ -18,6 +18,14 @@
  */
 void* SafeMalloc(size_t n);
 
+/**
+ * Wywołuje funkcję calloc() i sprawdza czy alokacja przebiegła poprawnie.
+ * @param[in] count : liczba alokowanych elementów
+ * @param[in] size : rozmiar jednego elementu
+ * @return wskaźnik na początek zaalokowanej, wyzerowanej pamięci
+ */
+void* SafeCalloc(size_t count, size_t size);
+
 /**
  * Wywołuje funkcję realloc() i sprawdza czy realokacja przebiegła poprawnie.
  * @param[in,out] ptr : wskaźnik na realokowane miejsce w pamięci
@@ -26,6 +34,26 @@ void* SafeMalloc(size_t n);
  */
 void* SafeRealloc(void *ptr, size_t n);
 
+/**
+ * Liczba elementów stosu roboczego algorytmu iteracyjnego, które mieszczą się
+ * w tablicy lokalnej, zanim stos zostanie przeniesiony na stertę.
+ */
+#define WORK_STACK_LOCAL 64
+
+/**
+ * Powiększa dwukrotnie stos roboczy algorytmu iteracyjnego, który przechodzi
+ * wielomian bez rekurencji. Stos początkowo zajmuje tablicę lokalną
+ * wywołującego, a po pierwszym powiększeniu leży na stercie i należy go
+ * zwolnić funkcją free(), jeśli jest różny od @p local.
+ * @param[in] stack : stos
+ * @param[in] local : tablica lokalna wywołującego
+ * @param[in,out] capacity : pojemność stosu
+ * @param[in] elem_size : rozmiar elementu stosu
+ * @return powiększony stos
+ */
+void* WorkStackGrow(void *stack, const void *local, size_t *capacity,
+                    size_t elem_size);
+
 /**
  * Zwraca większy z dwóch wykładników.
  * @param[in] a : wykładnik
@@ -38,6 +66,7 @@ poly_exp_t PolyExpMax(poly_exp_t a, poly_exp_t b);
  * Podnosi całkowity współczynnik @p coeff do nieujemnej, całkowitej
  * potęgi @p exp.
  * Wykorzystuje do tego algorytm znany jako szybkie potęgowanie.
+ * Mnożenia wykonywane są modulo bieżący moduł współczynników.
  * @param[in] coeff : podstawa potęgi
  * @param[in] exp : wykładnik potęgi
  * @return : @p coeff^@p exp
@@ -46,6 +75,8 @@ poly_coeff_t FastPow(poly_coeff_t coeff, poly_exp_t exp);
 
 /**
  * Tworzy nowy wielomian, który nie jest współczynnikiem.
+ * Tablica jednomianów przydzielana jest przez
+ * @ref MonoArrayAlloc(size_t n), a jej jednomiany są zerowe.
  * @param[in] n : liczba jednomianów w tworzonym wielomianie
  * @return utworzony wielomian
  */
@@ -55,6 +86,8 @@ Poly CreateNotCoeffPoly(size_t n);
  * Sortuje dany wielomian względem wykładników jednomianów, z których składa
  * się ten wielomian.
  * Jeśli wielomian jest wielomianem stałym nie zmienia jego stanu.
+ * Krótkie tablice jednomianów sortowane są algorytmem introsort, a długie
+ * pozycyjnie po cyfrach wykładników. Posortowana tablica nie jest zmieniana.
  * @param[in,out] p : wielomian, którego jednomiany zostaną posortowane
  */
 void PolySort(Poly *p);
@@ -70,7 +103,8 @@ bool PolyIsSorted(const Poly *p);
 
 /**
  * Jeśli @p b jest prawdą wypisuje $1, w przeciwnym wypadku wypisuje $0.
- * Po wypisaniu wartości wypisuje znak przejścia do nowej linii.
+ * Po wypisaniu wartości wypisuje znak przejścia do nowej linii (zob.
+ * @ref OutputEndLine(void)).
  * @param[in] b : wartość logiczna
  */
 void PrintlnBool(bool b);